@@ -0,0 +1,659 @@
+/**
+ * \file kernel_benchmark.cpp
+ * \brief Micro-benchmarks of the hot kernels and data movement functions.
+ *
+ * Every benchmark runs one kernel on one layer shape: it is run a few times
+ * to warm up, and then timed over a number of repetitions. The throughput is
+ * reported in GFLOP/s (for the kernels that compute) and GB/s, where the bytes
+ * are all the bytes of host memory the kernel reads and writes.
+ *
+ * Build and run with `make bench`, which writes the results to
+ * build/kernel_benchmark.json.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "fp16.h"
+
+#include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
+#include "smaug/core/network.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/tensor_utils.h"
+#include "smaug/core/workspace.h"
+#include "smaug/operators/batch_norm_op.h"
+#include "smaug/operators/common.h"
+#include "smaug/operators/convolution_op.h"
+#include "smaug/operators/eltwise_add_op.h"
+#include "smaug/operators/inner_product_op.h"
+#include "smaug/operators/pooling_op.h"
+#include "smaug/operators/relu_op.h"
+#include "smaug/operators/reorder_op_impl.h"
+#include "smaug/operators/smv/kernels/load_store_fp16_data.h"
+#include "smaug/operators/smv/smv_kernels.h"
+#include "smaug/utility/thread_pool.h"
+#include "smaug/utility/utils.h"
+
+namespace po = boost::program_options;
+
+using namespace smaug;
+
+namespace {
+
+/** One kernel on one shape. */
+struct Benchmark {
+    /** The kernel or function that is measured. */
+    std::string kernel;
+    /** The shapes of its operands. */
+    std::string shape;
+    /** Floating point operations per run, or 0 for data movement. */
+    double flops;
+    /** Bytes of host memory read and written per run. */
+    double bytes;
+    std::function<void()> run;
+};
+
+/** The measured time of a Benchmark, in seconds per run. */
+struct BenchmarkResult {
+    const Benchmark* benchmark;
+    int reps;
+    double minTime;
+    double medianTime;
+    double meanTime;
+};
+
+std::default_random_engine generator(1);
+
+/** Returns a name for a tensor or operator that is not used yet. */
+std::string getUniqueName(const std::string& prefix) {
+    static int count = 0;
+    return prefix + std::to_string(count++);
+}
+
+std::string shapeToString(const std::vector<int>& dims) {
+    std::stringstream ss;
+    for (int i = 0; i < dims.size(); i++)
+        ss << (i == 0 ? "" : "x") << dims[i];
+    return ss.str();
+}
+
+/** Returns an array of random half-precision data. */
+float16* newFp16Array(int size) {
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    float16* array =
+            (float16*)malloc_aligned(size * sizeof(float16), false);
+    for (int i = 0; i < size; i++)
+        array[i] = fp16_ieee_from_fp32_value(distribution(generator));
+    return array;
+}
+
+/** Creates a tensor in the workspace filled with random data. */
+template <typename DType>
+Tensor* newTensor(const std::string& name,
+                  const TensorShape& shape,
+                  Workspace* workspace) {
+    Tensor* tensor = new Tensor(name, shape);
+    tensor->allocateStorage<DType>();
+    workspace->addTensor(tensor);
+    std::uniform_real_distribution<float> distribution(-1, 1);
+    DType* data = tensor->data<DType>();
+    for (int i = 0; i < shape.storageSize(); i++) {
+        float value = distribution(generator);
+        data[i] = std::is_same<DType, float16>::value
+                          ? fp16_ieee_from_fp32_value(value)
+                          : value;
+    }
+    return tensor;
+}
+
+/** Fills all the tensors of the operator with random float data. */
+void fillOperator(Operator* op) {
+    std::uniform_real_distribution<float> distribution(0.1, 1);
+    for (auto tensors : { op->getInputs(), op->getOutputs() }) {
+        for (auto base : tensors) {
+            Tensor* tensor = dynamic_cast<Tensor*>(base);
+            tensor->allocateStorage<float>();
+            float* data = tensor->data<float>();
+            for (int i = 0; i < tensor->getShape().storageSize(); i++)
+                data[i] = distribution(generator);
+        }
+    }
+}
+
+/**
+ * The SMV kernels, on tiles that fit in the scratchpads. The shapes are tiles
+ * of common layers, as chosen by the SMV tiling optimizers.
+ */
+void addSmvBenchmarks(std::vector<Benchmark>& benchmarks) {
+    static SamplingInfo sampling = { NoSampling, 1 };
+    static activation_param_t actParams;
+
+    struct ConvShape {
+        std::vector<int> inputs;
+        std::vector<int> weights;
+    };
+    for (const ConvShape& conv : std::vector<ConvShape>{
+                 { { 1, 16, 16, 32 }, { 8, 3, 3, 32 } },
+                 { { 1, 28, 28, 16 }, { 8, 3, 3, 16 } },
+                 { { 1, 8, 8, 64 }, { 16, 3, 3, 64 } },
+                 { { 1, 7, 7, 128 }, { 8, 3, 3, 128 } },
+                 { { 1, 16, 16, 64 }, { 32, 1, 1, 64 } } }) {
+        // Same padding and unit strides.
+        std::vector<int> outputs = { 1, conv.inputs[1], conv.inputs[2],
+                                     conv.weights[0] };
+        int halo = (conv.weights[1] - 1) / 2;
+        int inputSize = product(conv.inputs);
+        int weightSize = product(conv.weights);
+        int outputSize = product(outputs);
+        float16* inputs = newFp16Array(inputSize);
+        float16* weights = newFp16Array(weightSize);
+        float16* results = newFp16Array(outputSize);
+        double flops = 2.0 * outputSize * conv.weights[1] * conv.weights[2] *
+                       conv.weights[3];
+        benchmarks.push_back(
+                { "smv_conv3d_nhwc_vec_fxp",
+                  shapeToString(conv.inputs) + " * " +
+                          shapeToString(conv.weights),
+                  flops, (inputSize + weightSize + outputSize) * 2.0,
+                  [=]() {
+                      int inputDims[4] = { conv.inputs[0], conv.inputs[1],
+                                           conv.inputs[2], conv.inputs[3] };
+                      int weightDims[4] = { conv.weights[0], conv.weights[1],
+                                            conv.weights[2], conv.weights[3] };
+                      int outputDims[4] = { outputs[0], outputs[1], outputs[2],
+                                            outputs[3] };
+                      int haloPad[4] = { halo, halo, halo, halo };
+                      smv_conv3d_nhwc_vec_fxp(
+                              inputs, weights, results, nullptr, smv::spad0,
+                              smv::spad1, smv::spad2, inputDims, weightDims,
+                              outputDims, 0, 0, 0, haloPad, 1, 1, 0, 0, false,
+                              true, true, true, nullptr, nullptr, nullptr,
+                              nullptr, 0, 0, NO_ACTIVATION, actParams,
+                              &sampling);
+                  } });
+    }
+
+    // Matrix multiplies of a batch of activations by weights of
+    // (neurons, activations).
+    struct FcShape {
+        std::vector<int> a;
+        std::vector<int> b;
+    };
+    for (const FcShape& fc : std::vector<FcShape>{
+                 { { 1, 2048 }, { 8, 2048 } },
+                 { { 16, 1024 }, { 16, 1024 } },
+                 { { 32, 256 }, { 64, 256 } } }) {
+        std::vector<int> outputs = { fc.a[0], fc.b[0] };
+        int aSize = product(fc.a);
+        int bSize = product(fc.b);
+        int outputSize = product(outputs);
+        float16* a = newFp16Array(aSize);
+        float16* b = newFp16Array(bSize);
+        float16* results = newFp16Array(outputSize);
+        benchmarks.push_back(
+                { "smv_matrix_multiply_transpose_nc_vec_fxp",
+                  shapeToString(fc.a) + " * " + shapeToString(fc.b) + "^T",
+                  2.0 * outputSize * fc.a[1],
+                  (aSize + bSize + outputSize) * 2.0, [=]() {
+                      int aDims[2] = { fc.a[0], fc.a[1] };
+                      int bDims[2] = { fc.b[0], fc.b[1] };
+                      int outputDims[2] = { outputs[0], outputs[1] };
+                      smv_matrix_multiply_transpose_nc_vec_fxp(
+                              a, b, results, nullptr, smv::spad0, smv::spad1,
+                              smv::spad2, aDims, bDims, outputDims, 0, 0, 0, 0,
+                              0, false, true, true, true, nullptr, nullptr,
+                              nullptr, nullptr, 0, 0, NO_ACTIVATION, actParams,
+                              &sampling);
+                  } });
+    }
+
+    // 2x2 pooling with a stride of 2.
+    for (const std::vector<int>& inputShape : std::vector<std::vector<int>>{
+                 { 1, 32, 32, 16 }, { 1, 28, 28, 16 }, { 1, 8, 8, 128 } }) {
+        std::vector<int> outputShape = { 1, inputShape[1] / 2,
+                                         inputShape[2] / 2, inputShape[3] };
+        int inputSize = product(inputShape);
+        int outputSize = product(outputShape);
+        float16* inputs = newFp16Array(inputSize);
+        float16* results = newFp16Array(outputSize);
+        typedef decltype(&smv_maxpooling_nhwc_vec_fxp) PoolKernel;
+        for (auto kernel : { std::make_pair("smv_maxpooling_nhwc_vec_fxp",
+                                            &smv_maxpooling_nhwc_vec_fxp),
+                             std::make_pair("smv_avgpooling_nhwc_vec_fxp",
+                                            &smv_avgpooling_nhwc_vec_fxp) }) {
+            PoolKernel func = kernel.second;
+            benchmarks.push_back(
+                    { kernel.first, shapeToString(inputShape) + " pool 2x2/2",
+                      4.0 * outputSize, (inputSize + outputSize) * 2.0,
+                      [=]() {
+                          int inputDims[4] = { inputShape[0], inputShape[1],
+                                               inputShape[2], inputShape[3] };
+                          int outputDims[4] = { outputShape[0], outputShape[1],
+                                                outputShape[2],
+                                                outputShape[3] };
+                          func(inputs, results, smv::spad0, smv::spad1,
+                               inputDims, outputDims, 0, 0, 2, 2, 2, 2, 0,
+                               &sampling);
+                      } });
+        }
+    }
+
+    // Batch norms, with the mean, variance, gamma and beta of every channel.
+    // Normalizing an element takes a subtraction, two multiplies and an add.
+    for (const std::vector<int>& inputShape : std::vector<std::vector<int>>{
+                 { 1, 16, 16, 64 }, { 1, 8, 8, 256 } }) {
+        int inputSize = product(inputShape);
+        int chans = inputShape[3];
+        float16* inputs = newFp16Array(inputSize);
+        float16* weights = newFp16Array(4 * chans);
+        float16* results = newFp16Array(inputSize);
+        benchmarks.push_back(
+                { "smv_batch_norm_post_conv_nhwc_vec_fxp",
+                  shapeToString(inputShape), 4.0 * inputSize,
+                  (2.0 * inputSize + 4 * chans) * 2, [=]() {
+                      int inputDims[4] = { inputShape[0], inputShape[1],
+                                           inputShape[2], inputShape[3] };
+                      smv_batch_norm_post_conv_nhwc_vec_fxp(
+                              inputs, weights, results, smv::spad0, smv::spad1,
+                              smv::spad2, inputDims, chans, 0, 0, 0,
+                              NO_ACTIVATION, actParams, &sampling);
+                  } });
+    }
+    for (const std::vector<int>& inputShape :
+         std::vector<std::vector<int>>{ { 1, 1024 }, { 1, 4096 } }) {
+        int inputSize = product(inputShape);
+        int acts = inputShape[1];
+        float16* inputs = newFp16Array(inputSize);
+        float16* weights = newFp16Array(4 * acts);
+        float16* results = newFp16Array(inputSize);
+        benchmarks.push_back(
+                { "smv_batch_norm_post_fc_nc_vec_fxp",
+                  shapeToString(inputShape), 4.0 * inputSize,
+                  (2.0 * inputSize + 4 * acts) * 2, [=]() {
+                      int inputDims[2] = { inputShape[0], inputShape[1] };
+                      smv_batch_norm_post_fc_nc_vec_fxp(
+                              inputs, weights, results, smv::spad0, smv::spad1,
+                              smv::spad2, inputDims, acts, 0, 0, true,
+                              NO_ACTIVATION, actParams);
+                  } });
+    }
+
+    for (int size : { 4096, 16384 }) {
+        float16* inputs0 = newFp16Array(size);
+        float16* inputs1 = newFp16Array(size);
+        float16* results = newFp16Array(size);
+        typedef decltype(&smv_eltwise_add_nc_vec_fxp) EltwiseKernel;
+        for (auto kernel : { std::make_pair("smv_eltwise_add_nc_vec_fxp",
+                                            &smv_eltwise_add_nc_vec_fxp),
+                             std::make_pair("smv_eltwise_mul_nc_vec_fxp",
+                                            &smv_eltwise_mul_nc_vec_fxp) }) {
+            EltwiseKernel func = kernel.second;
+            benchmarks.push_back({ kernel.first, std::to_string(size),
+                                   (double)size, size * 3 * 2.0, [=]() {
+                                       func(inputs0, inputs1, results,
+                                            smv::spad0, smv::spad1, smv::spad2,
+                                            size, true, nullptr, nullptr,
+                                            nullptr, nullptr, 0);
+                                   } });
+        }
+    }
+
+    // Transfers between the host and the scratchpads, which also convert
+    // between half and single precision.
+    for (int size : { 4096, 16384 }) {
+        float16* host = newFp16Array(size);
+        benchmarks.push_back({ "host_load_fp16", std::to_string(size), 0,
+                               size * 2.0, [=]() {
+                                   host_load_fp16(smv::spad0, host, size, 0, 0);
+                               } });
+        benchmarks.push_back({ "host_store_fp16", std::to_string(size), 0,
+                               size * 2.0, [=]() {
+                                   host_store_fp16(smv::spad0, host, size, 0,
+                                                   0);
+                               } });
+    }
+}
+
+/**
+ * The reference kernels, on whole layers. They are run through their
+ * operators, which call the kernel on the tensors directly.
+ */
+void addReferenceBenchmarks(std::vector<Benchmark>& benchmarks,
+                            Network* network,
+                            Workspace* workspace) {
+    struct ConvShape {
+        std::vector<int> inputs;
+        std::vector<int> weights;
+    };
+    for (const ConvShape& conv : std::vector<ConvShape>{
+                 { { 1, 32, 56, 56 }, { 32, 32, 3, 3 } },
+                 { { 1, 64, 28, 28 }, { 64, 64, 3, 3 } },
+                 { { 1, 128, 14, 14 }, { 128, 128, 3, 3 } } }) {
+        std::string name = getUniqueName("ref_conv");
+        auto convOp = new ConvolutionOp<ReferenceBackend>(name, workspace);
+        convOp->setInput(newTensor<float>(name + "/input",
+                                          TensorShape(conv.inputs, NCHW),
+                                          workspace),
+                         0);
+        convOp->setWeightDims(conv.weights[2], conv.weights[3],
+                              conv.weights[0]);
+        convOp->setStride(1, 1);
+        convOp->setPadding(SamePadding);
+        convOp->createAllTensors();
+        fillOperator(convOp);
+        network->addOperator(convOp);
+        int outputSize = convOp->getOutput(0)->getShape().size();
+        int inputSize = product(conv.inputs);
+        int weightSize = product(conv.weights);
+        benchmarks.push_back(
+                { "ref_conv3d_nchw_same_padding",
+                  shapeToString(conv.inputs) + " * " +
+                          shapeToString(conv.weights),
+                  2.0 * outputSize * weightSize / conv.weights[0],
+                  (inputSize + weightSize + outputSize) * 4.0,
+                  [=]() { convOp->run(); } });
+    }
+
+    for (const std::vector<int>& fc : std::vector<std::vector<int>>{
+                 { 1, 4096, 4096 }, { 16, 1024, 1024 } }) {
+        std::string name = getUniqueName("ref_fc");
+        auto fcOp = new InnerProductOp<ReferenceBackend>(name, workspace);
+        fcOp->setInput(
+                newTensor<float>(name + "/input",
+                                 TensorShape({ fc[0], fc[1] }, NC), workspace),
+                0);
+        fcOp->setNumOutputs(fc[2]);
+        fcOp->createAllTensors();
+        fillOperator(fcOp);
+        network->addOperator(fcOp);
+        benchmarks.push_back(
+                { "ref_inner_product",
+                  shapeToString({ fc[0], fc[1] }) + " * " +
+                          shapeToString({ fc[1], fc[2] }),
+                  2.0 * fc[0] * fc[1] * fc[2],
+                  (fc[0] * fc[1] + fc[1] * fc[2] + fc[0] * fc[2]) * 4.0,
+                  [=]() { fcOp->run(); } });
+    }
+
+    for (const std::vector<int>& inputShape : std::vector<std::vector<int>>{
+                 { 1, 64, 56, 56 }, { 1, 256, 14, 14 } }) {
+        int inputSize = product(inputShape);
+        std::string name = getUniqueName("ref_pool");
+        auto poolOp = new MaxPoolingOp<ReferenceBackend>(name, workspace);
+        poolOp->setInput(newTensor<float>(name + "/input",
+                                          TensorShape(inputShape, NCHW),
+                                          workspace),
+                         0);
+        poolOp->setPoolingSize(2, 2);
+        poolOp->setPoolingStride(2, 2);
+        poolOp->createAllTensors();
+        fillOperator(poolOp);
+        network->addOperator(poolOp);
+        benchmarks.push_back({ "ref_max_pooling_nchw",
+                               shapeToString(inputShape) + " pool 2x2/2",
+                               (double)inputSize, inputSize * 1.25 * 4,
+                               [=]() { poolOp->run(); } });
+
+        name = getUniqueName("ref_bn");
+        auto bnOp = new BatchNormOp<ReferenceBackend>(name, workspace);
+        bnOp->setInput(newTensor<float>(name + "/input",
+                                        TensorShape(inputShape, NCHW),
+                                        workspace),
+                       0);
+        bnOp->createAllTensors();
+        fillOperator(bnOp);
+        network->addOperator(bnOp);
+        benchmarks.push_back({ "ref_batch_norm_nchw_post_conv",
+                               shapeToString(inputShape), 4.0 * inputSize,
+                               inputSize * 2 * 4.0,
+                               [=]() { bnOp->run(); } });
+
+        name = getUniqueName("ref_add");
+        auto addOp = new EltwiseAddOp<ReferenceBackend>(name, workspace);
+        for (int i = 0; i < 2; i++) {
+            addOp->setInput(newTensor<float>(getUniqueName(name + "/input"),
+                                             TensorShape(inputShape, NCHW),
+                                             workspace),
+                            i);
+        }
+        addOp->createAllTensors();
+        fillOperator(addOp);
+        network->addOperator(addOp);
+        benchmarks.push_back({ "ref_eltwise_add", shapeToString(inputShape),
+                               (double)inputSize, inputSize * 3 * 4.0,
+                               [=]() { addOp->run(); } });
+    }
+}
+
+/**
+ * The host-side data movement around the kernels: tiling and untiling the
+ * tensors, and reordering their layouts.
+ */
+void addDataMovementBenchmarks(std::vector<Benchmark>& benchmarks,
+                               Network* network,
+                               Workspace* workspace) {
+    // The tiled tensors need an operator to belong to.
+    auto owner = new ReluOp<SmvBackend>("data_movement", workspace);
+    network->addOperator(owner);
+
+    struct TilingShape {
+        std::vector<int> tensor;
+        std::vector<int> tile;
+    };
+    for (const TilingShape& tiling : std::vector<TilingShape>{
+                 { { 1, 56, 56, 64 }, { 1, 8, 56, 64 } },
+                 { { 1, 56, 56, 64 }, { 1, 56, 56, 8 } },
+                 { { 1, 28, 28, 256 }, { 1, 4, 28, 64 } } }) {
+        std::string shape = shapeToString(tiling.tensor) + " tile " +
+                            shapeToString(tiling.tile);
+        double bytes = product(tiling.tensor) * 2 * 2.0;
+        Tensor* tensor = newTensor<float16>(getUniqueName("tensor"),
+                                            TensorShape(tiling.tensor, NHWC),
+                                            workspace);
+        Tensor* region = newTensor<float16>(getUniqueName("region"),
+                                            TensorShape(tiling.tile, NHWC),
+                                            workspace);
+        std::vector<int> origin(tiling.tensor.size(), 0);
+        benchmarks.push_back({ "copyTensorRegion", shape, 0,
+                               product(tiling.tile) * 2 * 2.0, [=]() {
+                                   copyTensorRegion(region, tensor, origin,
+                                                    origin, tiling.tile);
+                               } });
+
+        auto tiles = std::make_shared<TiledTensor>(generateTiledTensor(
+                tensor, TensorShape(tiling.tile, NHWC), owner));
+        benchmarks.push_back({ "TiledTensor::copyDataToAllTiles", shape, 0,
+                               bytes, [=]() {
+                                   // Invalidate the tiles so they are copied.
+                                   tensor->markDataChanged();
+                                   tiles->copyDataToAllTiles();
+                               } });
+        benchmarks.push_back({ "TiledTensor::untile", shape, 0, bytes,
+                               [=]() { tiles->untile(); } });
+    }
+
+    for (const std::vector<int>& dims : std::vector<std::vector<int>>{
+                 { 1, 64, 56, 56 }, { 1, 256, 14, 14 }, { 8, 3, 224, 224 } }) {
+        std::string name = getUniqueName("reorder");
+        Tensor* nchw = newTensor<float16>(
+                name + "/nchw", TensorShape(dims, NCHW), workspace);
+        Tensor* nhwc = newTensor<float16>(
+                name + "/nhwc",
+                TensorShape({ dims[0], dims[2], dims[3], dims[1] }, NHWC),
+                workspace);
+        double bytes = product(dims) * 2 * 2.0;
+        benchmarks.push_back({ "convertNchwToNhwc", shapeToString(dims), 0,
+                               bytes,
+                               [=]() { convertNchwToNhwc(nchw, nhwc); } });
+        benchmarks.push_back({ "convertNhwcToNchw", shapeToString(dims), 0,
+                               bytes,
+                               [=]() { convertNhwcToNchw(nhwc, nchw); } });
+    }
+    for (const std::vector<int>& dims :
+         std::vector<std::vector<int>>{ { 1024, 1024 }, { 64, 4096 } }) {
+        std::string name = getUniqueName("transpose");
+        Tensor* input = newTensor<float16>(
+                name + "/input", TensorShape(dims, NC), workspace);
+        Tensor* output = newTensor<float16>(
+                name + "/output", TensorShape({ dims[1], dims[0] }, CN),
+                workspace);
+        benchmarks.push_back({ "transpose2D", shapeToString(dims), 0,
+                               product(dims) * 2 * 2.0,
+                               [=]() { transpose2D(input, output); } });
+    }
+}
+
+BenchmarkResult runBenchmark(const Benchmark& benchmark,
+                             int warmup,
+                             int reps) {
+    typedef std::chrono::steady_clock Clock;
+    for (int i = 0; i < warmup; i++)
+        benchmark.run();
+    std::vector<double> times;
+    for (int i = 0; i < reps; i++) {
+        auto start = Clock::now();
+        benchmark.run();
+        times.push_back(
+                std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    double total = 0;
+    for (double time : times)
+        total += time;
+    return { &benchmark, reps, times.front(), times[times.size() / 2],
+             total / reps };
+}
+
+/** Returns the throughput in giga-units per second at the median time. */
+double getThroughput(double units, const BenchmarkResult& result) {
+    return units / result.medianTime / 1e9;
+}
+
+void writeJson(std::ostream& os,
+               const std::vector<BenchmarkResult>& results,
+               int warmup) {
+    os << "{\"warmup\": " << warmup << ", \"benchmarks\": [\n";
+    for (int i = 0; i < results.size(); i++) {
+        const BenchmarkResult& result = results[i];
+        const Benchmark* benchmark = result.benchmark;
+        os << (i == 0 ? "" : ",\n") << "{\"kernel\": \"" << benchmark->kernel
+           << "\", \"shape\": \"" << benchmark->shape
+           << "\", \"reps\": " << result.reps
+           << ", \"min_s\": " << result.minTime
+           << ", \"median_s\": " << result.medianTime
+           << ", \"mean_s\": " << result.meanTime
+           << ", \"flops\": " << benchmark->flops
+           << ", \"bytes\": " << benchmark->bytes
+           << ", \"gflops_per_s\": " << getThroughput(benchmark->flops, result)
+           << ", \"gbytes_per_s\": " << getThroughput(benchmark->bytes, result)
+           << "}";
+    }
+    os << "\n]}\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int warmup = 2;
+    int reps = 10;
+    int numThreads = -1;
+    std::string filter;
+    std::string jsonFile;
+    po::options_description options(
+            "SMAUG kernel benchmarks.  Usage: ./kernel_benchmark [options]");
+    // clang-format off
+    options.add_options()
+        ("help,h", "Display this help message")
+        ("warmup", po::value(&warmup),
+         "Number of untimed runs of every benchmark before it is timed.")
+        ("reps", po::value(&reps),
+         "Number of timed runs of every benchmark.")
+        ("filter", po::value(&filter),
+         "Only run the benchmarks whose kernel name contains this string.")
+        ("num-threads", po::value(&numThreads),
+         "Number of threads in the thread pool, which parallelizes the "
+         "tiling and untiling of tensors.")
+        ("json", po::value(&jsonFile),
+         "Write the results to this file in JSON.");
+    // clang-format on
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, options), vm);
+        po::notify(vm);
+    } catch (po::error& e) {
+        std::cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    if (vm.count("help")) {
+        std::cout << options << "\n";
+        return 1;
+    }
+    if (reps < 1) {
+        std::cout << "At least one repetition is required!\n";
+        return 1;
+    }
+
+    runningInSimulation = false;
+    fastForwardMode = false;
+    numAcceleratorsAvailable = 1;
+    if (numThreads > 0) {
+        threadPool = new ThreadPool(numThreads);
+        threadPool->initThreadPool();
+    }
+    ReferenceBackend::initGlobals();
+    SmvBackend::initGlobals();
+    Workspace* workspace = new Workspace();
+    Network* network = new Network("kernel_benchmark");
+
+    std::vector<Benchmark> benchmarks;
+    addSmvBenchmarks(benchmarks);
+    addReferenceBenchmarks(benchmarks, network, workspace);
+    addDataMovementBenchmarks(benchmarks, network, workspace);
+
+    std::vector<BenchmarkResult> results;
+    std::cout << std::left << std::setw(42) << "Kernel" << std::setw(28)
+              << "Shape" << std::right << std::setw(12) << "Median (us)"
+              << std::setw(10) << "GFLOP/s" << std::setw(10) << "GB/s"
+              << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (const Benchmark& benchmark : benchmarks) {
+        if (benchmark.kernel.find(filter) == std::string::npos)
+            continue;
+        results.push_back(runBenchmark(benchmark, warmup, reps));
+        const BenchmarkResult& result = results.back();
+        std::cout << std::left << std::setw(42) << benchmark.kernel
+                  << std::setw(28) << benchmark.shape << std::right
+                  << std::setw(12) << result.medianTime * 1e6 << std::setw(10)
+                  << getThroughput(benchmark.flops, result) << std::setw(10)
+                  << getThroughput(benchmark.bytes, result) << "\n";
+    }
+
+    int status = 0;
+    if (!jsonFile.empty()) {
+        std::ofstream file(jsonFile);
+        writeJson(file, results, warmup);
+        if (!file.good()) {
+            std::cerr << "Failed to write the results to " << jsonFile << "!\n";
+            status = 1;
+        }
+    }
+
+    delete network;
+    delete workspace;
+    if (threadPool)
+        delete threadPool;
+    ReferenceBackend::freeGlobals();
+    SmvBackend::freeGlobals();
+    return status;
+}
@@ -0,0 +1,331 @@
+#!/usr/bin/env python
+
+"""Model generators for the end-to-end SMAUG benchmarks.
+
+This builds a set of representative networks with the SMAUG Python API, in the
+same way as create_model_example.py, and exports each of them for the
+Reference and SMV backends:
+
+  - vgg16: VGG-16 on a 224x224 image.
+  - resnet50: ResNet-50 (v1.5) on a 224x224 image.
+  - mobilenet_v2: MobileNet-v2 on a 224x224 image, with depthwise convolutions.
+    This is only exported for the Reference backend, since the SMV backend
+    does not implement depthwise convolutions yet.
+  - lstm_lm: A two-layer LSTM language model.
+  - seq2seq: An LSTM encoder-decoder with Bahdanau attention.
+
+The weights are random, but drawn from a fixed seed, so the exported models are
+the same every time. Run this with the build directory on the PYTHONPATH:
+
+  python smaug/benchmarks/models.py --output-dir=build/models
+
+This writes <model>_<backend>_topo.pbtxt and <model>_<backend>_params.pb for
+every model, which can be run with `smaug` directly or with run_models.py.
+"""
+
+import argparse
+import os
+import numpy as np
+
+import smaug as sg
+from smaug.python import global_vars
+
+backend_suffix = {"Reference": "ref", "SMV": "smv"}
+
+class WeightFactory:
+  """Creates the weight tensors of a model in the data type of the backend."""
+  def __init__(self, backend, seed=0):
+    self.dtype = global_vars.backend_datatype[backend]
+    self.rng = np.random.RandomState(seed)
+
+  def _normal(self, shape, fan_in):
+    # He initialization keeps the activations in the range of float16 through
+    # the deep networks.
+    return (self.rng.standard_normal(shape) * np.sqrt(2.0 / fan_in)).astype(
+        self.dtype)
+
+  def conv(self, out_chans, in_chans, size):
+    return sg.Tensor(
+        data_layout=sg.NCHW,
+        tensor_data=self._normal((out_chans, in_chans, size, size),
+                                 in_chans * size * size))
+
+  def depthwise_conv(self, chans, size):
+    return sg.Tensor(
+        data_layout=sg.NCHW,
+        tensor_data=self._normal((1, chans, size, size), size * size))
+
+  def fc(self, neurons, acts):
+    return sg.Tensor(
+        data_layout=sg.NC, tensor_data=self._normal((neurons, acts), acts))
+
+  def batch_norm(self, chans):
+    """Returns the mean, variance, gamma and beta tensors of a batch norm."""
+    mean = self.rng.uniform(-0.1, 0.1, (1, chans))
+    # The variance is precomputed as 1/sqrt(variance + eps).
+    var = self.rng.uniform(0.9, 1.1, (1, chans))
+    gamma = self.rng.uniform(0.9, 1.1, (1, chans))
+    beta = self.rng.uniform(-0.1, 0.1, (1, chans))
+    return [
+        sg.Tensor(data_layout=sg.NC, tensor_data=t.astype(self.dtype))
+        for t in [mean, var, gamma, beta]
+    ]
+
+  def input(self, shape, layout):
+    return sg.Tensor(
+        data_layout=layout,
+        tensor_data=self.rng.uniform(-1, 1, shape).astype(self.dtype))
+
+  def zeros(self, shape, layout):
+    return sg.Tensor(
+        data_layout=layout, tensor_data=np.zeros(shape, dtype=self.dtype))
+
+def channels(tensor):
+  """Returns the number of channels of a 4D tensor."""
+  return tensor.shape.dims[1 if tensor.shape.layout == sg.NCHW else 3]
+
+def conv_bn(
+    x, weights, out_chans, size, stride=1, activation="relu",
+    activation_params=None, depthwise=False, name="conv"):
+  """A convolution followed by a batch norm and an activation."""
+  if depthwise:
+    x = sg.nn.depthwise_convolution(
+        x, weights.depthwise_conv(channels(x), size), stride=[stride, stride],
+        padding="same", name=name)
+  else:
+    x = sg.nn.convolution(
+        x, weights.conv(out_chans, channels(x), size), stride=[stride, stride],
+        padding="same", name=name)
+  return sg.nn.batch_norm(
+      x, *weights.batch_norm(channels(x)), activation=activation,
+      activation_params=activation_params, name=name + "_bn")
+
+def classifier(x, weights, num_classes=1000, name="fc"):
+  """Flattens the features and classifies them."""
+  x = sg.tensor.flatten(x)
+  x = sg.nn.mat_mul(
+      x, weights.fc(num_classes, x.shape.dims[1]), name=name)
+  return sg.nn.softmax(x, name=name + "_softmax")
+
+def create_vgg16(backend):
+  weights = WeightFactory(backend)
+  with sg.Graph(name="vgg16_" + backend_suffix[backend],
+                backend=backend) as graph:
+    x = sg.input_data(weights.input((1, 3, 224, 224), sg.NCHW))
+    for stage, (num_convs, chans) in enumerate([(2, 64), (2, 128), (3, 256),
+                                                 (3, 512), (3, 512)]):
+      for i in range(num_convs):
+        x = sg.nn.convolution(
+            x, weights.conv(chans, channels(x), 3), stride=[1, 1],
+            padding="same", activation="relu",
+            name="conv%d_%d" % (stage + 1, i + 1))
+      x = sg.nn.max_pool(
+          x, pool_size=[2, 2], stride=[2, 2], name="pool%d" % (stage + 1))
+    x = sg.tensor.flatten(x)
+    for i in range(2):
+      x = sg.nn.mat_mul(
+          x, weights.fc(4096, x.shape.dims[1]), activation="relu",
+          name="fc%d" % (i + 6))
+    x = sg.nn.mat_mul(x, weights.fc(1000, 4096), name="fc8")
+    sg.nn.softmax(x, name="prob")
+  return graph
+
+def create_resnet50(backend):
+  weights = WeightFactory(backend)
+
+  def bottleneck(x, chans, stride, name):
+    shortcut = x
+    if stride != 1 or channels(x) != chans * 4:
+      shortcut = conv_bn(
+          x, weights, chans * 4, 1, stride, activation=None,
+          name=name + "_shortcut")
+    x = conv_bn(x, weights, chans, 1, name=name + "_a")
+    x = conv_bn(x, weights, chans, 3, stride, name=name + "_b")
+    x = conv_bn(x, weights, chans * 4, 1, activation=None, name=name + "_c")
+    return sg.nn.relu(sg.math.add(x, shortcut, name=name + "_add"),
+                      name=name + "_relu")
+
+  with sg.Graph(name="resnet50_" + backend_suffix[backend],
+                backend=backend) as graph:
+    x = sg.input_data(weights.input((1, 3, 224, 224), sg.NCHW))
+    x = conv_bn(x, weights, 64, 7, 2, name="conv1")
+    x = sg.nn.max_pool(x, pool_size=[2, 2], stride=[2, 2], name="pool1")
+    for stage, (num_blocks, chans, stride) in enumerate([(3, 64, 1),
+                                                         (4, 128, 2),
+                                                         (6, 256, 2),
+                                                         (3, 512, 2)]):
+      for i in range(num_blocks):
+        x = bottleneck(
+            x, chans, stride if i == 0 else 1,
+            name="res%d%s" % (stage + 2, chr(ord("a") + i)))
+    x = sg.nn.avg_pool(x, pool_size=[7, 7], stride=[1, 1], name="pool5")
+    classifier(x, weights)
+  return graph
+
+def create_mobilenet_v2(backend):
+  weights = WeightFactory(backend)
+  # ReLU6 is a hard tanh clamped to [0, 6].
+  relu6 = {"activation": "hard_tanh",
+           "activation_params": {"min": 0, "max": 6}}
+
+  def inverted_residual(x, expansion, chans, stride, name):
+    in_chans = channels(x)
+    out = x
+    if expansion != 1:
+      out = conv_bn(
+          out, weights, in_chans * expansion, 1, name=name + "_expand",
+          **relu6)
+    out = conv_bn(
+        out, weights, None, 3, stride, depthwise=True, name=name + "_dw",
+        **relu6)
+    out = conv_bn(
+        out, weights, chans, 1, activation=None, name=name + "_project")
+    if stride == 1 and in_chans == chans:
+      out = sg.math.add(x, out, name=name + "_add")
+    return out
+
+  with sg.Graph(name="mobilenet_v2_" + backend_suffix[backend],
+                backend=backend) as graph:
+    x = sg.input_data(weights.input((1, 3, 224, 224), sg.NCHW))
+    x = conv_bn(x, weights, 32, 3, 2, name="conv1", **relu6)
+    block = 0
+    for expansion, chans, num_blocks, stride in [(1, 16, 1, 1), (6, 24, 2, 2),
+                                                 (6, 32, 3, 2), (6, 64, 4, 2),
+                                                 (6, 96, 3, 1), (6, 160, 3, 2),
+                                                 (6, 320, 1, 1)]:
+      for i in range(num_blocks):
+        x = inverted_residual(
+            x, expansion, chans, stride if i == 0 else 1,
+            name="block%d" % block)
+        block += 1
+    x = conv_bn(x, weights, 1280, 1, name="conv_last", **relu6)
+    x = sg.nn.avg_pool(x, pool_size=[7, 7], stride=[1, 1], name="pool")
+    classifier(x, weights)
+  return graph
+
+def create_lstm_lm(backend, timesteps=25, embedding=512, units=512,
+                   vocab=10000):
+  """A language model predicting the next word at every timestep.
+
+  The inputs are the word embeddings of the sequence, as SMAUG has no
+  embedding lookup operator.
+  """
+  weights = WeightFactory(backend)
+  with sg.Graph(name="lstm_lm_" + backend_suffix[backend],
+                backend=backend) as graph:
+    x = sg.input_data(weights.input((1, timesteps, embedding), sg.NTC))
+    depth = embedding
+    for layer in range(2):
+      lstm = sg.nn.LSTM([
+          weights.fc(4 * units, depth),
+          weights.fc(4 * units, units)
+      ], name="lstm%d" % layer)
+      x, _ = lstm(x)
+      depth = units
+    w_out = weights.fc(vocab, units)
+    for t in range(timesteps):
+      logits = sg.nn.mat_mul(x[t], w_out, name="logits%d" % t)
+      sg.nn.softmax(logits, name="prob%d" % t)
+  return graph
+
+def create_seq2seq(backend, source_steps=20, target_steps=20, embedding=256,
+                   units=256, vocab=8000):
+  """An LSTM encoder-decoder with Bahdanau attention.
+
+  The decoder is fed the target sequence (i.e. teacher forcing), along with the
+  attention of the previous step.
+  """
+  weights = WeightFactory(backend)
+  with sg.Graph(name="seq2seq_" + backend_suffix[backend],
+                backend=backend) as graph:
+    source = sg.input_data(
+        weights.input((1, source_steps, embedding), sg.NTC), name="source")
+    target = sg.input_data(
+        weights.input((1, target_steps, embedding), sg.NTC), name="target")
+    encoder = sg.nn.LSTM([
+        weights.fc(4 * units, embedding),
+        weights.fc(4 * units, units)
+    ], name="encoder")
+    memory, _ = encoder(source, concat_output=True)
+    attention = sg.nn.BahdanauAttention(
+        memory, weights.fc(units, units), weights.fc(units, units),
+        weights.fc(1, units), name="attention")
+    decoder = sg.nn.LSTM([
+        weights.fc(4 * units, embedding + units),
+        weights.fc(4 * units, units)
+    ], name="decoder")
+    w_out = weights.fc(vocab, 2 * units)
+    context = weights.zeros((1, units), sg.NC)
+    target_steps = sg.tensor.unstack(target, 1, name="target_unstack")
+    for t, x in enumerate(target_steps):
+      output, _ = decoder.step(
+          sg.tensor.concat([x, context], 1, name="decoder_input"), t)
+      context = attention(output)
+      logits = sg.nn.mat_mul(
+          sg.tensor.concat([output, context], 1, name="attention_output"),
+          w_out, name="logits%d" % t)
+      sg.nn.softmax(logits, name="prob%d" % t)
+  return graph
+
+models = {
+    "vgg16": create_vgg16,
+    "resnet50": create_resnet50,
+    "mobilenet_v2": create_mobilenet_v2,
+    "lstm_lm": create_lstm_lm,
+    "seq2seq": create_seq2seq,
+}
+
+backends = ["Reference", "SMV"]
+
+# Models that a backend cannot run correctly, and so are never exported for it.
+unsupported_backends = {
+    # SmvDepthwiseConvolutionOp::run() does nothing.
+    "mobilenet_v2": ["SMV"],
+}
+
+def get_model_name(model, backend):
+  return model + "_" + backend_suffix[backend]
+
+def is_supported(model, backend):
+  """Returns whether the model can be run on the backend."""
+  return backend not in unsupported_backends.get(model, [])
+
+def export_model(model, backend, output_dir, print_summary=False):
+  """Builds the model for the backend and writes it into output_dir.
+
+  Returns:
+    The path prefix of the written model files.
+  """
+  graph = models[model](backend)
+  if print_summary:
+    graph.print_summary()
+  path = os.path.join(output_dir, get_model_name(model, backend))
+  graph.write_graph(path)
+  return path
+
+def main():
+  parser = argparse.ArgumentParser(
+      description="Export the SMAUG benchmark models.")
+  parser.add_argument(
+      "--models", nargs="+", choices=sorted(models), default=sorted(models),
+      help="The models to export (default: all).")
+  parser.add_argument(
+      "--backends", nargs="+", choices=backends, default=backends,
+      help="The backends to export the models for (default: all).")
+  parser.add_argument(
+      "--output-dir", default=".", help="Where to write the models.")
+  parser.add_argument(
+      "--summary", action="store_true", help="Print a summary of each model.")
+  args = parser.parse_args()
+
+  os.makedirs(args.output_dir, exist_ok=True)
+  for model in args.models:
+    for backend in args.backends:
+      if not is_supported(model, backend):
+        print("Skipped %s: not supported on %s." % (model, backend))
+        continue
+      path = export_model(model, backend, args.output_dir, args.summary)
+      print("Wrote %s_topo.pbtxt and %s_params.pb." % (path, path))
+
+if __name__ == "__main__":
+  main()
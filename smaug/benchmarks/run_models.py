@@ -0,0 +1,147 @@
+#!/usr/bin/env python
+
+"""Runs the end-to-end SMAUG benchmarks natively.
+
+This runs `smaug` on every model exported by models.py, for both backends, and
+records the host-side performance of SMAUG itself:
+
+  - load: The time to build the network from the model files.
+  - tiling: The total time the operators spend tiling their tensors.
+  - run: The total time the operators spend running.
+  - wall: The wall time of the whole `smaug` process.
+  - peak_rss_mb: The peak resident set size of the `smaug` process.
+
+The times are measured with the per-operator profiler of `smaug` (--profile).
+Every configuration is run a number of times, and the median of each metric is
+reported. Models that have not been exported yet are exported first, and models
+that a backend does not support (MobileNet-v2 on SMV) are skipped. For example:
+
+  python smaug/benchmarks/run_models.py --model-dir=build/models \\
+      --json=model_benchmarks.json
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import models
+
+metrics = ["load", "tiling", "run", "wall", "peak_rss_mb"]
+
+def summarize_trace(trace_file):
+  """Returns the load, tiling and run times in a profile in seconds."""
+  with open(trace_file) as f:
+    events = json.load(f)["traceEvents"]
+  times = {"load": 0, "tiling": 0, "run": 0}
+  for event in events:
+    if event["ph"] != "X":
+      continue
+    # The durations are in microseconds.
+    duration = event["dur"] / 1e6
+    if event["cat"] == "tile":
+      times["tiling"] += duration
+    elif event["cat"] == "run":
+      times["run"] += duration
+    elif event["name"] == "Network loading":
+      times["load"] += duration
+  return times
+
+def run_smaug(smaug, model_path, extra_args):
+  """Runs smaug on the model once and returns the measured metrics."""
+  with tempfile.TemporaryDirectory() as tmp_dir:
+    trace_file = os.path.join(tmp_dir, "profile.json")
+    cmd = [
+        smaug, model_path + "_topo.pbtxt", model_path + "_params.pb",
+        "--profile=" + trace_file
+    ] + extra_args
+    with open(os.path.join(tmp_dir, "stderr"), "w+") as stderr:
+      start = time.time()
+      # Wait for this process specifically, to get its own resource usage.
+      process = subprocess.Popen(
+          cmd, stdout=subprocess.DEVNULL, stderr=stderr)
+      _, status, usage = os.wait4(process.pid, 0)
+      wall = time.time() - start
+      if status != 0:
+        stderr.seek(0)
+        sys.stderr.write(stderr.read())
+        raise RuntimeError("Failed to run: %s" % " ".join(cmd))
+    result = summarize_trace(trace_file)
+  result["wall"] = wall
+  # ru_maxrss is in kilobytes on Linux.
+  result["peak_rss_mb"] = usage.ru_maxrss / 1024.0
+  return result
+
+def median(values):
+  values = sorted(values)
+  mid = len(values) // 2
+  if len(values) % 2 == 1:
+    return values[mid]
+  return (values[mid - 1] + values[mid]) / 2
+
+def main():
+  default_smaug = os.path.join(
+      os.environ.get("SMAUG_HOME", "."), "build", "bin", "smaug")
+  parser = argparse.ArgumentParser(
+      description="Run the end-to-end SMAUG benchmarks.")
+  parser.add_argument(
+      "--smaug", default=default_smaug, help="The smaug binary to run.")
+  parser.add_argument(
+      "--model-dir", default=".", help="Where the exported models are.")
+  parser.add_argument(
+      "--models", nargs="+", choices=sorted(models.models),
+      default=sorted(models.models), help="The models to run (default: all).")
+  parser.add_argument(
+      "--backends", nargs="+", choices=models.backends,
+      default=models.backends, help="The backends to run (default: all).")
+  parser.add_argument(
+      "--reps", type=int, default=3, help="Number of runs of every model.")
+  parser.add_argument(
+      "--num-threads", type=int, default=None,
+      help="Number of threads in the thread pool of smaug.")
+  parser.add_argument(
+      "--smaug-args", default="",
+      help="Other arguments to pass to smaug, e.g. \"--memory-planner\".")
+  parser.add_argument("--json", help="Write the results to this file.")
+  args = parser.parse_args()
+
+  extra_args = args.smaug_args.split()
+  if args.num_threads is not None:
+    extra_args.append("--num-threads=%d" % args.num_threads)
+
+  os.makedirs(args.model_dir, exist_ok=True)
+  results = []
+  print("%-24s %10s %10s %10s %10s %12s" %
+        ("Model", "Load (s)", "Tiling (s)", "Run (s)", "Wall (s)",
+         "Peak RSS (MB)"))
+  for model in args.models:
+    for backend in args.backends:
+      name = models.get_model_name(model, backend)
+      if not models.is_supported(model, backend):
+        print("%-24s skipped: not supported on %s" % (name, backend))
+        continue
+      model_path = os.path.join(args.model_dir, name)
+      if not os.path.exists(model_path + "_topo.pbtxt"):
+        models.export_model(model, backend, args.model_dir)
+      runs = [
+          run_smaug(args.smaug, model_path, extra_args)
+          for _ in range(args.reps)
+      ]
+      result = {"model": model, "backend": backend, "reps": args.reps}
+      for metric in metrics:
+        result[metric] = median([run[metric] for run in runs])
+      results.append(result)
+      print("%-24s %10.3f %10.3f %10.3f %10.3f %12.1f" %
+            (name, result["load"], result["tiling"], result["run"],
+             result["wall"], result["peak_rss_mb"]))
+
+  if args.json:
+    with open(args.json, "w") as f:
+      json.dump({"smaug_args": extra_args, "benchmarks": results}, f, indent=2)
+
+if __name__ == "__main__":
+  main()
@@ -91,6 +91,8 @@ class ReferenceBackend {
     static const int Alignment = 0;
     static const bool PrecomputeBNVariance = true;
     static const bool TransposeFCWeights = false;
+    static const bool ConcurrentOps = true;
+    static const bool SupportsBias = true;
     static const std::string Name;
     static const DataLayout DefaultInputDataLayout = DataLayout::NCHW;
 
@@ -192,6 +194,10 @@ class SmvBackend {
     static const int Alignment = 8;
     static const bool PrecomputeBNVariance = true;
     static const bool TransposeFCWeights = true;
+    // All operators share the global scratchpads, so they cannot be run
+    // concurrently.
+    static const bool ConcurrentOps = false;
+    static const bool SupportsBias = true;
     static const std::string Name;
     static const DataLayout DefaultInputDataLayout = DataLayout::NHWC;
 
@@ -308,6 +314,11 @@ class PeaBackend {
     static const int Alignment = 8;
     static const bool PrecomputeBNVariance = true;
     static const bool TransposeFCWeights = true;
+    // All operators share the global scratchpads, so they cannot be run
+    // concurrently.
+    static const bool ConcurrentOps = false;
+    // The PEA convolution and inner product kernels do not support biases.
+    static const bool SupportsBias = false;
     static const std::string Name;
     static const DataLayout DefaultInputDataLayout = DataLayout::NCHW;
 
@@ -0,0 +1,69 @@
+#include <cstring>
+
+#include "smaug/core/batch_norm_folding.h"
+#include "smaug/utility/fp16_utils.h"
+#include "smaug/utility/utils.h"
+
+namespace smaug {
+
+static float readValue(Tensor* tensor, int index) {
+    if (tensor->getDataType() == Float16)
+        return fp16_ieee_to_fp32_value(tensor->data<float16>()[index]);
+    return tensor->data<float>()[index];
+}
+
+static void writeValue(Tensor* tensor, int index, float value) {
+    if (tensor->getDataType() == Float16)
+        tensor->data<float16>()[index] = fp16_ieee_from_fp32_value(value);
+    else
+        tensor->data<float>()[index] = value;
+}
+
+// Creates a zero bias with the same shape and data type as the batch norm
+// parameters. The SMV kernels load the bias from the host a cacheline at a
+// time, so the storage is padded with an extra cacheline.
+static Tensor* createBias(const std::string& name,
+                          Tensor* param,
+                          Workspace* workspace) {
+    Tensor* bias = new Tensor(name, param->getShape());
+    size_t size = param->getShape().storageSize() * param->getDataTypeSize();
+    bias->setStorage(std::shared_ptr<void>(
+            malloc_aligned(size + CACHELINE_SIZE, true), free));
+    bias->setDataType(param->getDataType());
+    workspace->addTensor(bias);
+    return bias;
+}
+
+Tensor* foldBatchNormParameters(Tensor* weights,
+                                int outputDim,
+                                Tensor* bias,
+                                Tensor* mean,
+                                Tensor* variance,
+                                Tensor* gamma,
+                                Tensor* beta,
+                                const std::string& biasName,
+                                Workspace* workspace) {
+    int numChannels = mean->getShape()[1];
+    std::vector<float> scale(numChannels);
+    std::vector<float> shift(numChannels);
+    auto paramIdx = mean->startIndex();
+    for (int c = 0; c < numChannels; c++) {
+        int i = paramIdx(0, c);
+        scale[c] = readValue(variance, i) * readValue(gamma, i);
+        shift[c] = readValue(beta, i) - readValue(mean, i) * scale[c];
+    }
+    for (auto idx = weights->startIndex(); !idx.end(); ++idx) {
+        float scaled = readValue(weights, idx) * scale[idx.currentIndex(outputDim)];
+        writeValue(weights, idx, scaled);
+    }
+    if (!bias)
+        bias = createBias(biasName, mean, workspace);
+    auto biasIdx = bias->startIndex();
+    for (int c = 0; c < numChannels; c++) {
+        int i = biasIdx(0, c);
+        writeValue(bias, i, readValue(bias, i) * scale[c] + shift[c]);
+    }
+    return bias;
+}
+
+}  // namespace smaug
@@ -0,0 +1,178 @@
+#ifndef _CORE_BATCH_NORM_FOLDING_H_
+#define _CORE_BATCH_NORM_FOLDING_H_
+
+#include <string>
+#include <vector>
+
+#include "smaug/core/globals.h"
+#include "smaug/core/network.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/workspace.h"
+#include "smaug/operators/batch_norm_op.h"
+#include "smaug/operators/convolution_op.h"
+#include "smaug/operators/inner_product_op.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+
+/**
+ * Folds the batch norm parameters into the weights and bias of the operator
+ * that produces the batch norm input, so that for every output channel c:
+ *
+ *   scale[c] = gamma[c] * variance[c]
+ *   weights[c] = weights[c] * scale[c]
+ *   bias[c] = (bias[c] - mean[c]) * scale[c] + beta[c]
+ *
+ * where variance has been precomputed as 1/sqrt(var + eps).
+ *
+ * @param weights The weights, which are scaled in place.
+ * @param outputDim The dimension of the weights that indexes output channels.
+ * @param bias The existing bias, or nullptr if the operator has none.
+ * @param biasName The name of the bias tensor to create if there is none.
+ * @return The updated or newly created bias.
+ */
+Tensor* foldBatchNormParameters(Tensor* weights,
+                                int outputDim,
+                                Tensor* bias,
+                                Tensor* mean,
+                                Tensor* variance,
+                                Tensor* gamma,
+                                Tensor* beta,
+                                const std::string& biasName,
+                                Workspace* workspace);
+
+/**
+ * Folds an inference-mode batch norm into the convolution or inner product
+ * operator that precedes it, and removes the batch norm from the network.
+ *
+ * The batch norm is only folded if its input comes from the first output of a
+ * Convolution3d or InnerProduct operator that has no fused activation and no
+ * other consumers, and if all the parameters involved are constant data that
+ * is not shared with other operators. The folded operator takes over the
+ * activation function and the output tensor of the batch norm.
+ *
+ * @return True if the batch norm was folded.
+ */
+template <typename Backend>
+bool foldBatchNorm(Network* network,
+                   Workspace* workspace,
+                   BatchNormOp<Backend>* bnOp) {
+    typedef BatchNormOp<Backend> BN;
+    const Graph& graph = network->getGraph();
+    Operator* producer = getInputOperator(network, bnOp, BN::Inputs);
+    if (!producer || out_degree(producer->getVertex(), graph) != 1 ||
+        bnOp->getInput(BN::Inputs) != producer->getOutput(0))
+        return false;
+
+    auto convOp = dynamic_cast<ConvolutionOp<Backend>*>(producer);
+    auto fcOp = dynamic_cast<InnerProductOp<Backend>*>(producer);
+    FusedActivationOp* fusedOp = nullptr;
+    Tensor* weights;
+    Tensor* bias;
+    Operator* weightsOp;
+    int outputDim;
+    if (convOp && convOp->getOpType() == OpType::Convolution3d) {
+        fusedOp = convOp;
+        weights = convOp->getInput(ConvolutionOp<Backend>::Kernels);
+        weightsOp = getInputOperator(
+                network, convOp, ConvolutionOp<Backend>::Kernels);
+        bias = convOp->getBias();
+        outputDim = 0;
+    } else if (fcOp) {
+        fusedOp = fcOp;
+        weights = fcOp->getInput(InnerProductOp<Backend>::Weights);
+        weightsOp = getInputOperator(
+                network, fcOp, InnerProductOp<Backend>::Weights);
+        bias = fcOp->getBias();
+        outputDim = weights->getShape().getLayout() == DataLayout::NC ? 0 : 1;
+    } else {
+        return false;
+    }
+    if (fusedOp->getActivation().function != activation_type::NO_ACTIVATION)
+        return false;
+    // The weights are modified in place, so they must not be shared.
+    if (!weightsOp || weightsOp->getOpType() != OpType::Data ||
+        out_degree(weightsOp->getVertex(), graph) != 1 ||
+        !weights->containsData())
+        return false;
+    DataType dataType = weights->getDataType();
+    if (dataType != Float32 && dataType != Float16)
+        return false;
+    std::vector<Operator*> paramOps;
+    for (int i = BN::Mean; i <= BN::Beta; i++) {
+        Tensor* param = bnOp->getInput(i);
+        Operator* paramOp = getInputOperator(network, bnOp, i);
+        if (!paramOp || paramOp->getOpType() != OpType::Data ||
+            !param->containsData() || param->getDataType() != dataType ||
+            param->getShape()[1] != weights->getShape()[outputDim])
+            return false;
+        if (out_degree(paramOp->getVertex(), graph) == 1)
+            paramOps.push_back(paramOp);
+    }
+
+    bias = foldBatchNormParameters(
+            weights, outputDim, bias, bnOp->getInput(BN::Mean),
+            bnOp->getInput(BN::Variance), bnOp->getInput(BN::Gamma),
+            bnOp->getInput(BN::Beta), producer->getName() + "/bias",
+            workspace);
+    if (convOp)
+        convOp->setBias(bias);
+    else
+        fcOp->setBias(bias);
+    fusedOp->setActivation(bnOp->getActivation());
+
+    // The producer now writes the output of the batch norm directly, which the
+    // children of the batch norm already read.
+    producer->setOutput(bnOp->getOutput(BN::Outputs), 0);
+    EdgeNameMap edges = get(boost::edge_name, graph);
+    std::vector<std::pair<Operator*, TensorIndices>> children;
+    out_edge_iter outEdgeIt, outEdgeEnd;
+    for (boost::tie(outEdgeIt, outEdgeEnd) =
+                 out_edges(bnOp->getVertex(), graph);
+         outEdgeIt != outEdgeEnd;
+         ++outEdgeIt) {
+        Operator* child = get(boost::vertex_op, graph, target(*outEdgeIt, graph));
+        children.push_back(std::make_pair(child, edges[*outEdgeIt]));
+    }
+    for (auto& child : children)
+        network->addEdge(producer, child.first, child.second);
+
+    dout(1) << "Folded " << bnOp->getName() << " into " << producer->getName()
+            << ".\n";
+    network->removeOperator(bnOp);
+    for (Operator* paramOp : paramOps)
+        network->removeOperator(paramOp);
+    return true;
+}
+
+/**
+ * Folds every eligible batch norm in the network into the operator before it.
+ * This is a no-op on backends whose convolution and inner product operators
+ * do not support biases.
+ *
+ * @return The number of folded batch norm operators.
+ */
+template <typename Backend>
+int foldBatchNorms(Network* network, Workspace* workspace) {
+    if (!Backend::SupportsBias || useSystolicArrayWhenAvailable)
+        return 0;
+    // Removing operators invalidates the operator map iterators, so find all
+    // the batch norms first.
+    std::vector<BatchNormOp<Backend>*> bnOps;
+    for (auto& entry : network->getOperators()) {
+        if (entry.second->getOpType() == OpType::BatchNorm) {
+            bnOps.push_back(
+                    dynamic_cast<BatchNormOp<Backend>*>(entry.second));
+        }
+    }
+    int numFolded = 0;
+    for (auto bnOp : bnOps) {
+        if (foldBatchNorm<Backend>(network, workspace, bnOp))
+            numFolded++;
+    }
+    return numFolded;
+}
+
+}  // namespace smaug
+
+#endif
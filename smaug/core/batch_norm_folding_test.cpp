@@ -0,0 +1,111 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/batch_norm_folding.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/relu_op.h"
+
+using namespace smaug;
+
+typedef BatchNormOp<ReferenceBackend> BN;
+
+// Adds a batch norm after the producer, with its parameters coming from data
+// operators, followed by a ReLU.
+static ReluOp<ReferenceBackend>* addBatchNormAndRelu(Operator* producer,
+                                                     SmaugTest* test) {
+    Network* network = test->network();
+    Workspace* workspace = test->workspace();
+    auto bnOp = new BN("bn", workspace);
+    bnOp->setInput(producer->getOutput(0), BN::Inputs);
+    bnOp->createAllTensors();
+    bnOp->getOutput(BN::Outputs)->allocateStorage<float>();
+    network->addOperator(bnOp);
+    network->addEdge(producer, bnOp, { 0, BN::Inputs });
+    std::vector<std::vector<float>> params = {
+        { 1, -2, 3, 0.5 }, { 0.5, 0.25, 2, 1 }, { 2, -1, 1, 3 }, { 1, 2, -3, 4 }
+    };
+    for (int i = BN::Mean; i <= BN::Beta; i++) {
+        Tensor* param = bnOp->getInput(i);
+        param->allocateStorage<float>();
+        param->fillData(params[i - BN::Mean].data(), 4);
+        network->addEdge(test->addDataOp(param), bnOp, { 0, i });
+    }
+
+    auto reluOp = new ReluOp<ReferenceBackend>("relu", workspace);
+    reluOp->setInput(bnOp->getOutput(BN::Outputs), 0);
+    reluOp->createAllTensors();
+    reluOp->getOutput(0)->allocateStorage<float>();
+    network->addOperator(reluOp);
+    network->addEdge(bnOp, reluOp, { BN::Outputs, 0 });
+    return reluOp;
+}
+
+// Runs the producer and the batch norm, folds the batch norm, and checks that
+// the producer alone now computes the same output.
+static void verifyFolding(SmaugTest* test, Operator* producer) {
+    Network* network = test->network();
+    auto reluOp = addBatchNormAndRelu(producer, test);
+    Operator* bnOp = network->getOperator("bn");
+    producer->run();
+    bnOp->run();
+    std::vector<float> expected = test->getValues(bnOp->getOutput(0));
+    REQUIRE(network->getOperators().size() == 9);
+
+    REQUIRE(foldBatchNorms<ReferenceBackend>(network, test->workspace()) == 1);
+    REQUIRE(network->getOperators().size() == 4);
+    REQUIRE(network->getOperators().count("bn") == 0);
+    REQUIRE(getInputOperator(network, reluOp, 0) == producer);
+    REQUIRE(producer->getOutput(0) == reluOp->getInput(0));
+    producer->run();
+    test->verifyOutputs<float>(producer->getOutput(0), expected);
+}
+
+TEST_CASE_METHOD(SmaugTest, "Batch norm folding", "[bnfolding]") {
+    SECTION("Convolution") {
+        auto convOp = new ConvolutionOp<ReferenceBackend>("conv", workspace());
+        Tensor* input = new Tensor(
+                "input", TensorShape({ 1, 2, 3, 3 }, DataLayout::NCHW));
+        input->allocateStorage<float>();
+        input->fillData<float>({ 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                 -1, 0, 1, -2, 0, 2, -3, 0, 3 });
+        workspace()->addTensor(input);
+        convOp->setInput(input, 0);
+        convOp->setPadding(SamePadding);
+        convOp->setWeightDims(3, 3, 4);
+        convOp->setStride(1, 1);
+        convOp->createAllTensors();
+        allocateAllTensors<float>(convOp);
+        Tensor* weights = convOp->getInput(1);
+        std::vector<float> weightsData;
+        for (int i = 0; i < weights->getShape().size(); i++)
+            weightsData.push_back((i % 7) - 3);
+        weights->fillData(weightsData.data(), weightsData.size());
+        network()->addOperator(convOp);
+        network()->addEdge(addDataOp(input), convOp, { 0, 0 });
+        network()->addEdge(addDataOp(weights), convOp, { 0, 1 });
+        verifyFolding(this, convOp);
+        REQUIRE(convOp->getBias() != nullptr);
+    }
+
+    SECTION("Inner product") {
+        auto fcOp = new InnerProductOp<ReferenceBackend>("fc", workspace());
+        Tensor* input =
+                new Tensor("input", TensorShape({ 1, 8 }, DataLayout::NC));
+        input->allocateStorage<float>();
+        input->fillData<float>({ 1, -2, 3, -4, 5, -6, 7, -8 });
+        workspace()->addTensor(input);
+        fcOp->setInput(input, 0);
+        fcOp->setNumOutputs(4);
+        fcOp->createAllTensors();
+        allocateAllTensors<float>(fcOp);
+        Tensor* weights = fcOp->getInput(1);
+        std::vector<float> weightsData;
+        for (int i = 0; i < weights->getShape().size(); i++)
+            weightsData.push_back((i % 5) - 2);
+        weights->fillData(weightsData.data(), weightsData.size());
+        network()->addOperator(fcOp);
+        network()->addEdge(addDataOp(input), fcOp, { 0, 0 });
+        network()->addEdge(addDataOp(weights), fcOp, { 0, 1 });
+        verifyFolding(this, fcOp);
+    }
+}
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <set>
+
+#include "smaug/core/batched_inference.h"
+#include "smaug/core/tensor_utils.h"
+
+namespace smaug {
+
+BatchedInference::BatchedInference(Network* _network,
+                                   Workspace* _workspace,
+                                   bool concurrent)
+        : network(_network), workspace(_workspace),
+          scheduler(_network, _workspace, concurrent) {
+    std::set<TensorBase*> params;
+    for (auto& entry : network->getOperators()) {
+        for (TensorBase* param : entry.second->getParameterizableInputs())
+            params.insert(param);
+    }
+    for (auto& entry : network->getOperators()) {
+        Operator* op = entry.second;
+        if (op->getOpType() == OpType::Data && !params.count(op->getOutput(0)))
+            inputs.push_back(op->getOutput(0));
+    }
+}
+
+Tensor* BatchedInference::findInput(const std::string& name) const {
+    for (Tensor* input : inputs) {
+        if (input->getName() == name)
+            return input;
+    }
+    return inputs.size() == 1 ? inputs[0] : nullptr;
+}
+
+bool BatchedInference::setInput(Tensor* input, const TensorProto& request) {
+    Tensor data(request, request.data());
+    if (data.getDataType() != input->getDataType() ||
+        data.getShape().dims() != input->getShape().dims()) {
+        std::cerr << "[ERROR]: Request " << request.name()
+                  << " does not match the shape or data type of input "
+                  << input->getName() << "!\n";
+        return false;
+    }
+    std::vector<int> origin(input->ndims(), 0);
+    copyTensorRegion(input, &data, origin, origin, input->getShape().dims());
+    input->markDataChanged();
+    return true;
+}
+
+Tensor* BatchedInference::run() {
+    auto start = std::chrono::steady_clock::now();
+    Tensor* output = scheduler.runNetwork();
+    std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+    latencies.push_back(elapsed.count());
+    return output;
+}
+
+void BatchedInference::printStats(std::ostream& os) const {
+    if (latencies.empty()) {
+        os << "No requests were run.\n";
+        return;
+    }
+    // The first request also tiles the network, so it is reported apart.
+    std::vector<double> sorted(latencies.begin(), latencies.end());
+    std::sort(sorted.begin(), sorted.end());
+    double total = std::accumulate(latencies.begin(), latencies.end(), 0.0);
+    auto percentile = [&](double p) {
+        int rank = std::ceil(p * sorted.size()) - 1;
+        return sorted[std::max(rank, 0)];
+    };
+    os << "Requests: " << latencies.size() << "\n";
+    os << "First request latency: " << latencies[0] * 1e3 << " ms\n";
+    os << "Mean latency: " << total / latencies.size() * 1e3 << " ms\n";
+    os << "Median latency: " << percentile(0.5) * 1e3 << " ms\n";
+    os << "99th percentile latency: " << percentile(0.99) * 1e3 << " ms\n";
+    os << "Throughput: " << latencies.size() / total << " requests/s\n";
+}
+
+}  // namespace smaug
@@ -0,0 +1,77 @@
+#ifndef _CORE_BATCHED_INFERENCE_H_
+#define _CORE_BATCHED_INFERENCE_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "smaug/core/network.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/workspace.h"
+
+namespace smaug {
+
+/**
+ * BatchedInference runs a Network over a sequence of requests, e.g. the
+ * samples of a dataset.
+ *
+ * The Network is tiled once, before the first request, and the tiles of the
+ * weights stay filled for all the requests. Every request only replaces the
+ * data of the input tensors, which are the outputs of the Data operators
+ * that are not parameters of any operator. The latency of every request is
+ * recorded.
+ */
+class BatchedInference {
+   public:
+    BatchedInference(Network* _network,
+                     Workspace* _workspace,
+                     bool concurrent = false);
+
+    /** Returns the input tensors of the Network. */
+    const std::vector<Tensor*>& getInputs() const { return inputs; }
+
+    /**
+     * Returns the input tensor that the given request data is meant for: the
+     * input with the same name, or the only input of the Network.
+     *
+     * @return The input tensor, or nullptr if there is no such input.
+     */
+    Tensor* findInput(const std::string& name) const;
+
+    /**
+     * Replaces the data of an input tensor with the data of a request. The
+     * request must have the same shape and data type as the input.
+     *
+     * @return False if the request does not match the input.
+     */
+    bool setInput(Tensor* input, const TensorProto& request);
+
+    /**
+     * Runs the Network on the current inputs and returns the final output.
+     * The output tensor is overwritten by the next request.
+     */
+    Tensor* run();
+
+    /** Returns the latencies of all the requests so far, in seconds. */
+    const std::vector<double>& getLatencies() const { return latencies; }
+
+    /**
+     * Prints the number of requests, their mean and percentile latencies, and
+     * the aggregate throughput.
+     */
+    void printStats(std::ostream& os) const;
+
+   protected:
+    Network* network;
+    Workspace* workspace;
+    Scheduler scheduler;
+    /** The outputs of the Data operators that are not parameters. */
+    std::vector<Tensor*> inputs;
+    /** The latency of every request, in seconds. */
+    std::vector<double> latencies;
+};
+
+}  // namespace smaug
+
+#endif
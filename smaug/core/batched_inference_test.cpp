@@ -0,0 +1,115 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/batched_inference.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/data_op.h"
+#include "smaug/operators/inner_product_op.h"
+#include "smaug/operators/relu_op.h"
+#include "smaug/operators/smv/smv_relu_op.h"
+
+using namespace smaug;
+
+// Fills the tensor with values that depend on the seed.
+static void fillTensor(Tensor* tensor, int seed) {
+    for (int i = 0; i < tensor->getShape().storageSize(); i++) {
+        float value = ((i * 7 + seed) % 13 - 6) * 0.25f;
+        if (tensor->getDataType() == Float16)
+            tensor->data<float16>()[i] = fp16(value);
+        else
+            tensor->data<float>()[i] = value;
+    }
+}
+
+// Returns a request for the given input.
+static TensorProto* createRequest(Tensor* input, int seed) {
+    Tensor request(input->getName(), input->getShape());
+    request.allocateStorage(input->getDataType());
+    fillTensor(&request, seed);
+    return request.asTensorProto();
+}
+
+TEST_CASE_METHOD(SmaugTest, "Batched inference", "[batchedinference]") {
+    SECTION("Weights are not inputs, and outputs follow the requests") {
+        Tensor* input = new Tensor(
+                "input", TensorShape({ 1, 16 }, DataLayout::NC));
+        input->allocateStorage<float>();
+        workspace()->addTensor(input);
+        auto inputOp = new DataOp<ReferenceBackend>("input", workspace());
+        inputOp->setData(input);
+        auto fcOp = new InnerProductOp<ReferenceBackend>("fc", workspace());
+        fcOp->setInput(input, 0);
+        fcOp->setNumOutputs(8);
+        fcOp->createAllTensors();
+        Tensor* weights = fcOp->getInput(1);
+        weights->allocateStorage<float>();
+        fillTensor(weights, 3);
+        fcOp->getOutput(0)->allocateStorage<float>();
+        auto weightsOp = new DataOp<ReferenceBackend>("weights", workspace());
+        weightsOp->setData(weights);
+        network()->addOperator(inputOp);
+        network()->addOperator(weightsOp);
+        network()->addOperator(fcOp);
+        network()->addEdge(inputOp, fcOp, { 0, 0 });
+        network()->addEdge(weightsOp, fcOp, { 0, 1 });
+
+        BatchedInference inference(network(), workspace());
+        REQUIRE(inference.getInputs() == std::vector<Tensor*>{ input });
+        REQUIRE(inference.findInput("other") == input);
+
+        // Running the first request again must give the same output as the
+        // first time, and the second request a different one.
+        TensorProto* first = createRequest(input, 1);
+        TensorProto* second = createRequest(input, 2);
+        std::vector<std::vector<float>> outputs;
+        for (TensorProto* request : { first, second, first }) {
+            REQUIRE(inference.setInput(input, *request));
+            outputs.push_back(getValues(inference.run()));
+        }
+        REQUIRE(outputs[0] != outputs[1]);
+        verifyOutputs(fcOp->getOutput(0), outputs[0]);
+        REQUIRE(inference.getLatencies().size() == 3);
+        delete first;
+        delete second;
+    }
+
+    SECTION("Tiles of the inputs are refilled for every request") {
+        // The input is too large for the scratchpads, so the relu copies it
+        // into tiles.
+        TensorShape shape({ 2, 16, 32, 32 }, DataLayout::NHWC,
+                          SmvBackend::Alignment);
+        Tensor* input = new Tensor("input", shape);
+        input->allocateStorage<float16>();
+        workspace()->addTensor(input);
+        auto inputOp = new DataOp<SmvBackend>("input", workspace());
+        inputOp->setData(input);
+        auto reluOp = new SmvReluOp("relu", workspace());
+        reluOp->setInput(input, 0);
+        reluOp->createAllTensors();
+        reluOp->getOutput(0)->allocateStorage<float16>();
+        network()->addOperator(inputOp);
+        network()->addOperator(reluOp);
+        network()->addEdge(inputOp, reluOp, { 0, 0 });
+
+        BatchedInference inference(network(), workspace());
+        for (int i = 0; i < 3; i++) {
+            TensorProto* request = createRequest(input, i);
+            REQUIRE(inference.setInput(input, *request));
+            Tensor* output = inference.run();
+
+            auto refReluOp = new ReluOp<ReferenceBackend>(
+                    "ref_relu" + std::to_string(i), workspace());
+            refReluOp->setInput(
+                    convertFp16ToFp32Tensor(input, workspace()), 0);
+            refReluOp->createAllTensors();
+            refReluOp->getOutput(0)->allocateStorage<float>();
+            refReluOp->run();
+            verifyOutputs<float16>(
+                    output,
+                    convertFp32ToFp16Tensor(
+                            refReluOp->getOutput(0), workspace()));
+            delete refReluOp;
+            delete request;
+        }
+    }
+}
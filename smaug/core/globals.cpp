@@ -6,4 +6,9 @@ bool fastForwardMode = true;
 int numAcceleratorsAvailable;
 ThreadPool* threadPool = nullptr;
 bool useSystolicArrayWhenAvailable;
+bool useMemoryPlanner = false;
+bool useBatchNormFolding = false;
+bool useLayoutPropagation = false;
+bool minimizeTilingDataMovement = false;
+bool useDoubleBufferedSpads = false;
 }  // namespace smaug
@@ -40,6 +40,42 @@ extern ThreadPool* threadPool;
  */
 extern bool useSystolicArrayWhenAvailable;
 
+/**
+ * If true, the output tensors of all operators are placed into a single shared
+ * arena by the MemoryPlanner, which reuses the memory of tensors whose
+ * consumers have all finished.
+ */
+extern bool useMemoryPlanner;
+
+/**
+ * If true, inference-mode batch normalization operators are folded into the
+ * weights and bias of the convolution or inner product operator they follow
+ * when the network is built.
+ */
+extern bool useBatchNormFolding;
+
+/**
+ * If true, data layouts are propagated through layout-agnostic operators when
+ * the network is built, removing the reorders that convert data back and
+ * forth around them.
+ */
+extern bool useLayoutPropagation;
+
+/**
+ * If true, the SMV convolution tiling optimizer chooses the tile shapes that
+ * move the fewest bytes between the host and the scratchpads, rather than
+ * those that fill up the scratchpads the most.
+ */
+extern bool minimizeTilingDataMovement;
+
+/**
+ * If true, the scratchpads that hold the inputs and weights of the SMV
+ * convolution, inner product and elementwise accelerators are split into two
+ * buffers, so that every kernel invocation can prefetch the tiles of the next
+ * one while it computes (see SmvSpadBuffers).
+ */
+extern bool useDoubleBufferedSpads;
+
 }  // namespace smaug
 
 #endif
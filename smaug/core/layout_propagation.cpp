@@ -0,0 +1,135 @@
+#include "smaug/core/layout_propagation.h"
+
+namespace smaug {
+
+int convertAxis(int axis, DataLayout from, DataLayout to) {
+    const std::string& fromName = DataLayout_Name(from);
+    const std::string& toName = DataLayout_Name(to);
+    size_t pos = toName.find(fromName.at(axis));
+    assert(pos != std::string::npos && "The layouts have different dimensions!");
+    return pos;
+}
+
+int getOutputIndex(const Operator* op, const TensorBase* tensor) {
+    const std::vector<TensorBase*>& outputs = op->getOutputs();
+    for (int i = 0; i < outputs.size(); i++) {
+        if (outputs[i] == tensor)
+            return i;
+    }
+    return -1;
+}
+
+bool isTranspose(const Operator* op) {
+    if (op->getOpType() != OpType::Reorder)
+        return false;
+    const TensorShape& inputShape = op->getInput(0)->getShape();
+    const TensorShape& outputShape = op->getOutput(0)->getShape();
+    return inputShape.ndims() == outputShape.ndims() &&
+           inputShape.getLayout() != outputShape.getLayout();
+}
+
+bool isLayoutAgnostic(const Operator* op) {
+    switch (op->getOpType()) {
+        case OpType::ReLU:
+        case OpType::LReLU:
+        case OpType::ELU:
+        case OpType::SELU:
+        case OpType::Sigmoid:
+        case OpType::Tanh:
+        case OpType::HardTanh:
+        case OpType::EltwiseAdd:
+        case OpType::EltwiseMul:
+        case OpType::Less:
+        case OpType::LessEqual:
+        case OpType::Greater:
+        case OpType::GreaterEqual:
+        case OpType::Concat:
+            return op->getOutputs().size() == 1;
+        default:
+            return false;
+    }
+}
+
+int cancelInverseReorders(Network* network, Operator* reorderOp) {
+    const Graph& graph = network->getGraph();
+    Operator* producer = getInputOperator(network, reorderOp, 0);
+    if (!producer)
+        return 0;
+    Tensor* input = reorderOp->getInput(0);
+    int srcIdx = getOutputIndex(producer, input);
+
+    // Find the children that convert the output back to the input layout.
+    // Those that nothing reads from are left alone, since their output is an
+    // output of the network.
+    std::vector<Operator*> inverseOps;
+    out_edge_iter outEdgeIt, outEdgeEnd;
+    for (boost::tie(outEdgeIt, outEdgeEnd) =
+                 out_edges(reorderOp->getVertex(), graph);
+         outEdgeIt != outEdgeEnd;
+         ++outEdgeIt) {
+        Operator* child = get(boost::vertex_op, graph, target(*outEdgeIt, graph));
+        if (!isTranspose(child) ||
+            out_degree(child->getVertex(), graph) == 0)
+            continue;
+        const TensorShape& shape = child->getOutput(0)->getShape();
+        if (shape == input->getShape() &&
+            shape.getAlignment() == input->getShape().getAlignment())
+            inverseOps.push_back(child);
+    }
+    if (inverseOps.empty())
+        return 0;
+
+    EdgeNameMap edges = get(boost::edge_name, graph);
+    for (Operator* inverseOp : inverseOps) {
+        std::vector<std::pair<Operator*, TensorIndices>> children;
+        for (boost::tie(outEdgeIt, outEdgeEnd) =
+                     out_edges(inverseOp->getVertex(), graph);
+             outEdgeIt != outEdgeEnd;
+             ++outEdgeIt) {
+            Operator* child =
+                    get(boost::vertex_op, graph, target(*outEdgeIt, graph));
+            children.push_back(std::make_pair(child, edges[*outEdgeIt]));
+        }
+        for (auto& child : children) {
+            child.first->setInput(input, child.second.destIdx);
+            network->addEdge(
+                    producer, child.first, { srcIdx, child.second.destIdx });
+        }
+        dout(1) << "Cancelled " << reorderOp->getName() << " and "
+                << inverseOp->getName() << ".\n";
+        network->removeOperator(inverseOp);
+    }
+    int numRemoved = inverseOps.size();
+    if (out_degree(reorderOp->getVertex(), graph) == 0) {
+        network->removeOperator(reorderOp);
+        numRemoved++;
+    }
+    return numRemoved;
+}
+
+std::vector<Operator*> getSinkableReorders(const Network* network,
+                                           Operator* op) {
+    const Graph& graph = network->getGraph();
+    if (!isLayoutAgnostic(op))
+        return {};
+    std::vector<Operator*> reorders;
+    for (int i = 0; i < op->getInputs().size(); i++) {
+        Operator* reorderOp = getInputOperator(network, op, i);
+        if (!reorderOp || !isTranspose(reorderOp) ||
+            out_degree(reorderOp->getVertex(), graph) != 1 ||
+            !getInputOperator(network, reorderOp, 0))
+            return {};
+        if (!reorders.empty()) {
+            const TensorShape& first = reorders[0]->getInput(0)->getShape();
+            const TensorShape& shape = reorderOp->getInput(0)->getShape();
+            if (shape.getLayout() != first.getLayout() ||
+                reorderOp->getOutput(0)->getShape().getLayout() !=
+                        reorders[0]->getOutput(0)->getShape().getLayout())
+                return {};
+        }
+        reorders.push_back(reorderOp);
+    }
+    return reorders;
+}
+
+}  // namespace smaug
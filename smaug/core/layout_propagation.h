@@ -0,0 +1,181 @@
+#ifndef _CORE_LAYOUT_PROPAGATION_H_
+#define _CORE_LAYOUT_PROPAGATION_H_
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "smaug/core/network.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/workspace.h"
+#include "smaug/operators/concat_op.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+
+/**
+ * Returns the axis that holds, in layout to, the dimension held by the given
+ * axis in layout from. Both layouts must name the same dimensions, e.g. NCHW
+ * and NHWC.
+ */
+int convertAxis(int axis, DataLayout from, DataLayout to);
+
+/** Returns the index of the tensor among the outputs of op, or -1. */
+int getOutputIndex(const Operator* op, const TensorBase* tensor);
+
+/**
+ * Returns true if op is a Reorder that permutes the dimensions of its input,
+ * as opposed to a flatten.
+ */
+bool isTranspose(const Operator* op);
+
+/**
+ * Returns true if every output element of op is computed from the input
+ * elements at the same position, so that op gives the same results in any
+ * data layout. Concat is included, since its axis can be converted.
+ */
+bool isLayoutAgnostic(const Operator* op);
+
+/**
+ * Removes the children of the reorder that convert its output back to the
+ * layout of its input. The operators that read the output of those children
+ * read the input of the reorder instead. The reorder itself is removed if
+ * nothing else reads its output.
+ *
+ * @return The number of removed reorder operators.
+ */
+int cancelInverseReorders(Network* network, Operator* reorderOp);
+
+/**
+ * Returns the reorders feeding every input of op if they all perform the same
+ * conversion and feed nothing else, or an empty vector otherwise.
+ */
+std::vector<Operator*> getSinkableReorders(const Network* network,
+                                           Operator* op);
+
+/**
+ * Moves the reorders that feed a layout-agnostic operator after it, so that
+ * the operator runs in the layout of the reorder inputs. If the operator has
+ * several inputs, their reorders are replaced by a single one on the output.
+ * The operator gets a new output tensor in the source layout, and the reorder
+ * takes over its old output tensor, so the children of the operator are
+ * unaffected.
+ *
+ * @return True if the reorders were moved.
+ */
+template <typename Backend>
+bool sinkReorders(Network* network, Workspace* workspace, Operator* op) {
+    std::vector<Operator*> reorders = getSinkableReorders(network, op);
+    if (reorders.empty())
+        return false;
+    DataLayout srcLayout = reorders[0]->getInput(0)->getShape().getLayout();
+    DataLayout dstLayout = reorders[0]->getOutput(0)->getShape().getLayout();
+
+    // The new output of the operator is the old one in the source layout.
+    Tensor* output = op->getOutput(0);
+    const TensorShape& shape = output->getShape();
+    std::vector<int> dims(shape.ndims());
+    for (int i = 0; i < shape.ndims(); i++)
+        dims[convertAxis(i, dstLayout, srcLayout)] = shape[i];
+    Tensor* newOutput = new Tensor(
+            output->getName() + "/" + DataLayout_Name(srcLayout),
+            TensorShape(dims, srcLayout, shape.getAlignment()));
+    newOutput->setDataType(output->getDataType());
+    workspace->addTensor(newOutput);
+    if (op->getOpType() == OpType::Concat) {
+        auto concatOp = dynamic_cast<ConcatOp<Backend>*>(op);
+        concatOp->setConcatAxis(convertAxis(
+                concatOp->getConcatAxis(), dstLayout, srcLayout));
+    }
+
+    // The operator now reads the inputs of the reorders directly.
+    for (int i = 0; i < reorders.size(); i++) {
+        Operator* producer = getInputOperator(network, reorders[i], 0);
+        Tensor* input = reorders[i]->getInput(0);
+        network->removeEdge(producer, reorders[i]);
+        network->removeEdge(reorders[i], op);
+        op->setInput(input, i);
+        network->addEdge(producer, op, { getOutputIndex(producer, input), i });
+    }
+
+    // Keep the first reorder to convert the output, and remove the others.
+    Operator* reorderOp = reorders[0];
+    const Graph& graph = network->getGraph();
+    EdgeNameMap edges = get(boost::edge_name, graph);
+    std::vector<std::pair<Operator*, TensorIndices>> children;
+    out_edge_iter outEdgeIt, outEdgeEnd;
+    for (boost::tie(outEdgeIt, outEdgeEnd) = out_edges(op->getVertex(), graph);
+         outEdgeIt != outEdgeEnd;
+         ++outEdgeIt) {
+        Operator* child = get(boost::vertex_op, graph, target(*outEdgeIt, graph));
+        children.push_back(std::make_pair(child, edges[*outEdgeIt]));
+    }
+    for (auto& child : children) {
+        network->removeEdge(op, child.first);
+        network->addEdge(reorderOp, child.first, child.second);
+    }
+    op->setOutput(newOutput, 0);
+    reorderOp->setInput(newOutput, 0);
+    reorderOp->setOutput(output, 0);
+    network->addEdge(op, reorderOp, { 0, 0 });
+    dout(1) << "Moved " << reorders.size() << " reorders after "
+            << op->getName() << ".\n";
+    for (int i = 1; i < reorders.size(); i++)
+        network->removeOperator(reorders[i]);
+    return true;
+}
+
+/**
+ * Propagates data layouts through the layout-agnostic operators of the
+ * network. Reorders are moved after those operators until they meet an
+ * operator that needs their layout, or a reorder that converts the data back,
+ * in which case both are removed.
+ *
+ * @return The number of removed reorder operators.
+ */
+template <typename Backend>
+int propagateLayouts(Network* network, Workspace* workspace) {
+    int numRemoved = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        // Removing operators invalidates the graph iterators, so find the
+        // candidates first. Every change restarts the search. The reorders
+        // are moved in topological order, so that a reorder reaches the one
+        // that converts its data back before that one moves further down.
+        const Graph& graph = network->getGraph();
+        std::list<Vertex> vertices;
+        boost::topological_sort(graph, std::front_inserter(vertices));
+        std::vector<Operator*> reorders, agnosticOps;
+        for (auto v : vertices) {
+            Operator* op = get(boost::vertex_op, graph, v);
+            if (isTranspose(op))
+                reorders.push_back(op);
+            else if (isLayoutAgnostic(op))
+                agnosticOps.push_back(op);
+        }
+        for (auto reorderOp : reorders) {
+            int numCancelled = cancelInverseReorders(network, reorderOp);
+            if (numCancelled > 0) {
+                numRemoved += numCancelled;
+                changed = true;
+                break;
+            }
+        }
+        if (changed)
+            continue;
+        for (auto op : agnosticOps) {
+            int numInputs = op->getInputs().size();
+            if (sinkReorders<Backend>(network, workspace, op)) {
+                numRemoved += numInputs - 1;
+                changed = true;
+                break;
+            }
+        }
+    }
+    return numRemoved;
+}
+
+}  // namespace smaug
+
+#endif
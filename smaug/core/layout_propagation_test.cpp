@@ -0,0 +1,158 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/layout_propagation.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/concat_op.h"
+#include "smaug/operators/eltwise_add_op.h"
+#include "smaug/operators/reorder_op.h"
+
+using namespace smaug;
+
+static Tensor* createInput(const std::string& name,
+                           const std::vector<int>& dims,
+                           Workspace* workspace) {
+    Tensor* tensor = new Tensor(name, TensorShape(dims, DataLayout::NCHW));
+    tensor->allocateStorage<float>();
+    std::vector<float> data(tensor->getShape().size());
+    for (int i = 0; i < data.size(); i++)
+        data[i] = (i % 11) - 5 + 0.5f * (i % 3);
+    tensor->fillData(data.data(), data.size());
+    workspace->addTensor(tensor);
+    return tensor;
+}
+
+static Operator* addReorder(const std::string& name,
+                            Operator* producer,
+                            DataLayout layout,
+                            Network* network,
+                            Workspace* workspace) {
+    auto reorderOp = new ReorderOp<ReferenceBackend>(name, layout, workspace);
+    reorderOp->setInput(producer->getOutput(0), 0);
+    reorderOp->createAllTensors();
+    network->addOperator(reorderOp);
+    network->addEdge(producer, reorderOp, { 0, 0 });
+    return reorderOp;
+}
+
+// Runs all the operators in topological order, allocating the outputs that
+// have no storage yet.
+static void runNetwork(Network* network) {
+    const Graph& graph = network->getGraph();
+    std::list<Vertex> vertices;
+    boost::topological_sort(graph, std::front_inserter(vertices));
+    for (auto v : vertices) {
+        Operator* op = get(boost::vertex_op, graph, v);
+        for (int i = 0; i < op->getOutputs().size(); i++) {
+            if (!op->getOutput(i)->containsData())
+                op->getOutput(i)->allocateStorage<float>();
+        }
+        op->run();
+    }
+}
+
+static int countReorders(Network* network) {
+    int count = 0;
+    for (auto& entry : network->getOperators()) {
+        if (entry.second->getOpType() == OpType::Reorder)
+            count++;
+    }
+    return count;
+}
+
+// Runs the network, propagates the layouts, and checks that the expected
+// number of reorders was removed and that the output is unchanged.
+static void verifyPropagation(SmaugTest* test,
+                              Tensor* output,
+                              int expectedRemoved) {
+    Network* network = test->network();
+    runNetwork(network);
+    std::vector<float> expected = test->getValues(output);
+    int numReorders = countReorders(network);
+    REQUIRE(propagateLayouts<ReferenceBackend>(
+                    network, test->workspace()) == expectedRemoved);
+    REQUIRE(countReorders(network) == numReorders - expectedRemoved);
+    REQUIRE(network->validate());
+    runNetwork(network);
+    test->verifyOutputs<float>(output, expected);
+}
+
+TEST_CASE_METHOD(SmaugTest, "Layout propagation", "[layoutprop]") {
+    SECTION("Inverse reorders are cancelled") {
+        auto dataOp =
+                addDataOp(createInput("input", { 1, 2, 3, 4 }, workspace()));
+        auto toNhwc = addReorder(
+                "to_nhwc", dataOp, DataLayout::NHWC, network(), workspace());
+        auto toNchw = addReorder(
+                "to_nchw", toNhwc, DataLayout::NCHW, network(), workspace());
+        auto reluOp = addRelu("relu", toNchw);
+        verifyPropagation(this, reluOp->getOutput(0), 2);
+        REQUIRE(network()->getOperators().size() == 2);
+        REQUIRE(getInputOperator(network(), reluOp, 0) == dataOp);
+        REQUIRE(reluOp->getInput(0) == dataOp->getOutput(0));
+    }
+
+    SECTION("Reorders are moved after elementwise operators") {
+        auto a = addDataOp(createInput("a", { 1, 4, 3, 5 }, workspace()));
+        auto b = addDataOp(createInput("b", { 1, 4, 3, 5 }, workspace()));
+        auto aToNhwc =
+                addReorder("a_nhwc", a, DataLayout::NHWC, network(), workspace());
+        auto bToNhwc =
+                addReorder("b_nhwc", b, DataLayout::NHWC, network(), workspace());
+        auto addOp = new EltwiseAddOp<ReferenceBackend>("add", workspace());
+        addOp->setInput(aToNhwc->getOutput(0), 0);
+        addOp->setInput(bToNhwc->getOutput(0), 1);
+        addOp->createAllTensors();
+        network()->addOperator(addOp);
+        network()->addEdge(aToNhwc, addOp, { 0, 0 });
+        network()->addEdge(bToNhwc, addOp, { 0, 1 });
+        auto reluOp = addRelu("relu", addOp);
+        auto toNchw = addReorder(
+                "to_nchw", reluOp, DataLayout::NCHW, network(), workspace());
+        auto outputOp = addRelu("output", toNchw);
+        verifyPropagation(this, outputOp->getOutput(0), 3);
+        REQUIRE(network()->getOperators().size() == 5);
+        REQUIRE(addOp->getInput(0) == a->getOutput(0));
+        REQUIRE(addOp->getInput(1) == b->getOutput(0));
+        REQUIRE(addOp->getOutput(0)->getShape().getLayout() == DataLayout::NCHW);
+        REQUIRE(outputOp->getInput(0) == reluOp->getOutput(0));
+    }
+
+    SECTION("Concat axis is converted") {
+        auto a = addDataOp(createInput("a", { 1, 2, 3, 4 }, workspace()));
+        auto b = addDataOp(createInput("b", { 1, 3, 3, 4 }, workspace()));
+        auto aToNhwc =
+                addReorder("a_nhwc", a, DataLayout::NHWC, network(), workspace());
+        auto bToNhwc =
+                addReorder("b_nhwc", b, DataLayout::NHWC, network(), workspace());
+        auto concatOp =
+                new ConcatOp<ReferenceBackend>("concat", workspace(), 2, 3);
+        concatOp->setInput(aToNhwc->getOutput(0), 0);
+        concatOp->setInput(bToNhwc->getOutput(0), 1);
+        concatOp->createAllTensors();
+        network()->addOperator(concatOp);
+        network()->addEdge(aToNhwc, concatOp, { 0, 0 });
+        network()->addEdge(bToNhwc, concatOp, { 0, 1 });
+        auto toNchw = addReorder(
+                "to_nchw", concatOp, DataLayout::NCHW, network(), workspace());
+        auto reluOp = addRelu("relu", toNchw);
+        verifyPropagation(this, reluOp->getOutput(0), 3);
+        REQUIRE(concatOp->getConcatAxis() == 1);
+        REQUIRE(reluOp->getInput(0) == concatOp->getOutput(0));
+    }
+
+    SECTION("Reorders are kept where their layout is needed") {
+        auto dataOp =
+                addDataOp(createInput("input", { 1, 2, 3, 4 }, workspace()));
+        auto toNhwc = addReorder(
+                "to_nhwc", dataOp, DataLayout::NHWC, network(), workspace());
+        auto reluOp = addRelu("relu", toNhwc);
+        Tensor* output = reluOp->getOutput(0);
+        verifyPropagation(this, output, 0);
+        // The ReLU now runs before the reorder, which still produces the
+        // NHWC output.
+        REQUIRE(reluOp->getInput(0) == dataOp->getOutput(0));
+        REQUIRE(getInputOperator(network(), toNhwc, 0) == reluOp);
+        REQUIRE(toNhwc->getOutput(0) == output);
+    }
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <list>
+#include <map>
+
+#include "smaug/core/memory_planner.h"
+#include "smaug/operators/common.h"
+#include "smaug/utility/debug_stream.h"
+#include "smaug/utility/utils.h"
+
+namespace smaug {
+
+void MemoryPlanner::run() {
+    const Graph& graph = network->getGraph();
+    EdgeNameMap edges = get(boost::edge_name, graph);
+    std::list<Vertex> vertices;
+    boost::topological_sort(graph, std::front_inserter(vertices));
+    int numOps = vertices.size();
+    std::map<Vertex, int> topoIndex;
+    int index = 0;
+    for (auto v : vertices)
+        topoIndex[v] = index++;
+
+    // Compute the transitive predecessors of every operator. Parents always
+    // come before their children in topological order, so their ancestor
+    // sets are complete by the time we visit the child.
+    ancestors.assign(numOps, boost::dynamic_bitset<>(numOps));
+    for (auto v : vertices) {
+        int opIdx = topoIndex[v];
+        in_edge_iter inEdgeIt, inEdgeEnd;
+        for (boost::tie(inEdgeIt, inEdgeEnd) = in_edges(v, graph);
+             inEdgeIt != inEdgeEnd;
+             ++inEdgeIt) {
+            int parentIdx = topoIndex[source(*inEdgeIt, graph)];
+            ancestors[opIdx] |= ancestors[parentIdx];
+            ancestors[opIdx].set(parentIdx);
+        }
+    }
+
+    // Find the tensors that need storage, together with all the operators
+    // that write and read them. A view has no storage of its own, so its
+    // writers and readers are those of the tensor that owns its storage. The
+    // tensors are found in the topological order of their first writer.
+    std::vector<Tensor*> tensors;
+    std::map<Tensor*, TensorUsers> users;
+    for (auto v : vertices) {
+        Operator* op = get(boost::vertex_op, graph, v);
+        if (op->getOpType() == OpType::Data)
+            continue;
+        int opIdx = topoIndex[v];
+        for (int i = 0; i < op->getOutputs().size(); i++) {
+            Tensor* tensor = op->getOutput(i);
+            if (!tensor)
+                continue;
+            while (tensor->isView())
+                tensor = tensor->getViewBase();
+            if (tensor->containsData() ||
+                tensor->getDataType() == UnknownDataType)
+                continue;
+            auto it = users.find(tensor);
+            if (it == users.end()) {
+                tensors.push_back(tensor);
+                it = users.emplace(tensor, TensorUsers()).first;
+            }
+            TensorUsers& tensorUsers = it->second;
+            tensorUsers.writers.push_back(opIdx);
+            int numReaders = tensorUsers.readers.size();
+            out_edge_iter outEdgeIt, outEdgeEnd;
+            for (boost::tie(outEdgeIt, outEdgeEnd) = out_edges(v, graph);
+                 outEdgeIt != outEdgeEnd;
+                 ++outEdgeIt) {
+                if (edges[*outEdgeIt].srcIdx == i) {
+                    tensorUsers.readers.push_back(
+                            topoIndex[target(*outEdgeIt, graph)]);
+                }
+            }
+            if (tensorUsers.readers.size() == numReaders)
+                tensorUsers.pinned = true;
+        }
+    }
+
+    // Place every tensor into a buffer.
+    std::vector<std::pair<Tensor*, int>> placements;
+    for (Tensor* tensor : tensors) {
+        const TensorUsers& tensorUsers = users[tensor];
+        size_t size = next_multiple(
+                tensor->getShape().storageSize() * tensor->getDataTypeSize(),
+                CACHELINE_SIZE);
+        int bufferIdx = findBuffer(size, tensorUsers.writers);
+        Buffer& buffer = buffers[bufferIdx];
+        buffer.size = std::max(buffer.size, size);
+        buffer.readers = tensorUsers.readers;
+        buffer.pinned = tensorUsers.pinned;
+        placements.push_back(std::make_pair(tensor, bufferIdx));
+        totalTensorSize += size;
+    }
+    if (placements.empty())
+        return;
+
+    // Lay out the buffers back to back and point the tensors into the arena.
+    for (auto& buffer : buffers) {
+        buffer.offset = arenaSize;
+        arenaSize += buffer.size;
+    }
+    std::shared_ptr<void> arena(malloc_aligned(arenaSize), free);
+    for (auto& placement : placements) {
+        char* storage =
+                reinterpret_cast<char*>(arena.get()) +
+                buffers[placement.second].offset;
+        placement.first->setStorage(std::shared_ptr<void>(arena, storage));
+    }
+    dout(1) << "Placed " << placements.size() << " tensors in "
+            << buffers.size() << " buffers.\n";
+}
+
+bool MemoryPlanner::isBufferFree(const Buffer& buffer,
+                                 const std::vector<int>& writers) const {
+    if (buffer.pinned)
+        return false;
+    for (int writer : writers) {
+        for (int reader : buffer.readers) {
+            if (!ancestors[writer].test(reader))
+                return false;
+        }
+    }
+    return true;
+}
+
+int MemoryPlanner::findBuffer(size_t size, const std::vector<int>& writers) {
+    // Prefer the smallest free buffer that fits the tensor. Otherwise grow the
+    // largest free buffer, so that the arena grows as little as possible.
+    int bestFit = -1;
+    int largest = -1;
+    for (int i = 0; i < buffers.size(); i++) {
+        const Buffer& buffer = buffers[i];
+        if (!isBufferFree(buffer, writers))
+            continue;
+        if (buffer.size >= size &&
+            (bestFit == -1 || buffer.size < buffers[bestFit].size))
+            bestFit = i;
+        if (largest == -1 || buffer.size > buffers[largest].size)
+            largest = i;
+    }
+    if (bestFit != -1)
+        return bestFit;
+    if (largest != -1)
+        return largest;
+    buffers.push_back({ 0, 0, {}, false });
+    return buffers.size() - 1;
+}
+
+}  // namespace smaug
@@ -0,0 +1,106 @@
+#ifndef _CORE_MEMORY_PLANNER_H_
+#define _CORE_MEMORY_PLANNER_H_
+
+#include <vector>
+#include <boost/dynamic_bitset.hpp>
+
+#include "smaug/core/network.h"
+#include "smaug/core/tensor.h"
+#include "smaug/core/workspace.h"
+
+namespace smaug {
+
+/**
+ * MemoryPlanner assigns the output tensors of all operators in a Network to
+ * offsets within a single shared arena.
+ *
+ * The planner walks the operators in topological order. Each output tensor
+ * lives from the operator that produces it until all the operators that
+ * consume it have run. A tensor may reuse the buffer of an earlier tensor if
+ * every consumer of that earlier tensor is an ancestor of the producing
+ * operator in the graph, since those consumers are then guaranteed to have
+ * finished by the time the producer runs. This holds for any valid schedule,
+ * including concurrent scheduling.
+ *
+ * Tensors that already have storage (e.g. model parameters), tensors without
+ * a known data type, and tensors that are never consumed (the outputs of the
+ * network) never share their buffers.
+ *
+ * Views are not placed themselves. Instead, the operators that write or read a
+ * view count as writers or readers of the tensor that owns its storage, which
+ * lives from its first writer until all of these readers have run.
+ */
+class MemoryPlanner {
+   public:
+    MemoryPlanner(Network* _network, Workspace* _workspace)
+            : network(_network), workspace(_workspace), arenaSize(0),
+              totalTensorSize(0) {}
+
+    /**
+     * Plans the memory of all operator outputs, allocates the arena, and
+     * points every planned Tensor into it.
+     */
+    void run();
+
+    /** Returns the size of the shared arena in bytes. */
+    size_t getArenaSize() const { return arenaSize; }
+
+    /**
+     * Returns the total size in bytes of all planned tensors, i.e. the memory
+     * they would have used without buffer reuse.
+     */
+    size_t getTotalTensorSize() const { return totalTensorSize; }
+
+   protected:
+    /** A region of the arena that is reused by tensors with disjoint lives. */
+    struct Buffer {
+        /** Size in bytes. */
+        size_t size;
+        /** Offset in bytes from the start of the arena. */
+        size_t offset;
+        /**
+         * The topological indices of the operators that consume the tensor
+         * currently placed in this buffer.
+         */
+        std::vector<int> readers;
+        /** True if the tensor in this buffer is never consumed. */
+        bool pinned;
+    };
+
+    /**
+     * The topological indices of the operators that write and read a tensor,
+     * directly or through views of it.
+     */
+    struct TensorUsers {
+        TensorUsers() : pinned(false) {}
+        std::vector<int> writers;
+        std::vector<int> readers;
+        /** True if the tensor or one of its views is never consumed. */
+        bool pinned;
+    };
+
+    /**
+     * Returns the index of the buffer to place a tensor of the given size
+     * into, when written by the operators at the given topological indices. A
+     * new buffer is created if none can be reused.
+     */
+    int findBuffer(size_t size, const std::vector<int>& writers);
+
+    /** Returns true if the buffer can be reused by all the given writers. */
+    bool isBufferFree(const Buffer& buffer,
+                      const std::vector<int>& writers) const;
+
+    Network* network;
+    Workspace* workspace;
+
+    /** For every operator, the set of its transitive predecessors. */
+    std::vector<boost::dynamic_bitset<>> ancestors;
+    std::vector<Buffer> buffers;
+
+    size_t arenaSize;
+    size_t totalTensorSize;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,101 @@
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/memory_planner.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/eltwise_add_op.h"
+#include "smaug/operators/reshape_op.h"
+
+using namespace smaug;
+
+TEST_CASE_METHOD(SmaugTest, "Memory planner", "[memplanner]") {
+    TensorShape inputShape({ 1, 8 }, DataLayout::NC);
+    Tensor* input = new Tensor("input", inputShape);
+    input->allocateStorage<float>();
+    input->fillData<float>({ -4, -3, -2, -1, 1, 2, 3, 4 });
+    workspace()->addTensor(input);
+    size_t tensorSize = 8 * sizeof(float);
+
+    SECTION("A chain of operators uses two buffers") {
+        auto relu0 = addRelu("relu0", input);
+        auto relu1 = addRelu("relu1", relu0->getOutput(0));
+        auto relu2 = addRelu("relu2", relu1->getOutput(0));
+        auto relu3 = addRelu("relu3", relu2->getOutput(0));
+        network()->addEdge(relu0, relu1, { 0, 0 });
+        network()->addEdge(relu1, relu2, { 0, 0 });
+        network()->addEdge(relu2, relu3, { 0, 0 });
+
+        MemoryPlanner planner(network(), workspace());
+        planner.run();
+        REQUIRE(planner.getTotalTensorSize() == 4 * tensorSize);
+        REQUIRE(planner.getArenaSize() == 2 * tensorSize);
+        REQUIRE(relu0->getOutput(0)->data<float>() ==
+                relu2->getOutput(0)->data<float>());
+        REQUIRE(relu1->getOutput(0)->data<float>() ==
+                relu3->getOutput(0)->data<float>());
+
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        verifyOutputs<float>(output, { 0, 0, 0, 0, 1, 2, 3, 4 });
+    }
+
+    SECTION("Buffers are not reused until all the consumers have run") {
+        auto relu0 = addRelu("relu0", input);
+        auto relu1 = addRelu("relu1", relu0->getOutput(0));
+        auto relu2 = addRelu("relu2", relu0->getOutput(0));
+        auto addOp = new EltwiseAddOp<ReferenceBackend>("add", workspace());
+        addOp->setInput(relu1->getOutput(0), 0);
+        addOp->setInput(relu2->getOutput(0), 1);
+        addOp->createAllTensors();
+        addOp->getOutput(0)->setDataType(Float32);
+        network()->addOperator(addOp);
+        network()->addEdge(relu0, relu1, { 0, 0 });
+        network()->addEdge(relu0, relu2, { 0, 0 });
+        network()->addEdge(relu1, addOp, { 0, 0 });
+        network()->addEdge(relu2, addOp, { 0, 1 });
+
+        MemoryPlanner planner(network(), workspace());
+        planner.run();
+        REQUIRE(planner.getTotalTensorSize() == 4 * tensorSize);
+        REQUIRE(planner.getArenaSize() == 3 * tensorSize);
+        REQUIRE(relu0->getOutput(0)->data<float>() ==
+                addOp->getOutput(0)->data<float>());
+
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        verifyOutputs<float>(output, { 0, 0, 0, 0, 2, 4, 6, 8 });
+    }
+
+    SECTION("Views extend the lives of the tensors they alias") {
+        auto relu0 = addRelu("relu0", input);
+        auto reshapeOp =
+                new ReshapeOp<ReferenceBackend>("reshape", workspace());
+        reshapeOp->setInput(relu0->getOutput(0), 0);
+        reshapeOp->setShape({ 2, 4 }, DataLayout::NC);
+        reshapeOp->createAllTensors();
+        reshapeOp->getOutput(0)->setDataType(Float32);
+        network()->addOperator(reshapeOp);
+        auto relu1 = addRelu("relu1", reshapeOp->getOutput(0));
+        auto relu2 = addRelu("relu2", relu1->getOutput(0));
+        network()->addEdge(relu0, reshapeOp, { 0, 0 });
+        network()->addEdge(reshapeOp, relu1, { 0, 0 });
+        network()->addEdge(relu1, relu2, { 0, 0 });
+        REQUIRE(reshapeOp->getOutput(0)->getViewBase() == relu0->getOutput(0));
+
+        // relu1 reads the output of relu0 through the view, so it must not
+        // write into the same buffer. relu2 can.
+        MemoryPlanner planner(network(), workspace());
+        planner.run();
+        REQUIRE(planner.getTotalTensorSize() == 3 * tensorSize);
+        REQUIRE(planner.getArenaSize() == 2 * tensorSize);
+        REQUIRE(relu0->getOutput(0)->data<float>() !=
+                relu1->getOutput(0)->data<float>());
+        REQUIRE(relu0->getOutput(0)->data<float>() ==
+                relu2->getOutput(0)->data<float>());
+
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        verifyOutputs<float>(output, { 0, 0, 0, 0, 1, 2, 3, 4 });
+    }
+}
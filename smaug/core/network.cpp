@@ -21,6 +21,23 @@ void Network::addEdge(Operator* src, Operator* dest, TensorIndices indices) {
     add_edge(src->getVertex(), dest->getVertex(), EdgeProperty(indices), graph);
 }
 
+void Network::removeEdge(Operator* src, Operator* dest) {
+    remove_edge(src->getVertex(), dest->getVertex(), graph);
+}
+
+void Network::removeOperator(Operator* op) {
+    Vertex v = op->getVertex();
+    clear_vertex(v, graph);
+    remove_vertex(v, graph);
+    operators.erase(op->getName());
+    delete op;
+    // Vertices are stored contiguously, so removing one renumbers all the
+    // vertices after it.
+    vertex_iter vi, vEnd;
+    for (boost::tie(vi, vEnd) = vertices(graph); vi != vEnd; ++vi)
+        get(boost::vertex_op, graph, *vi)->setVertex(*vi);
+}
+
 void Network::dumpDataflowGraph() const {
     std::ofstream out(name + "_dataflow_graph.dot", std::ofstream::out);
     write_graphviz(out, graph, DataflowGraphWriter(graph));
@@ -57,3 +74,18 @@ void Network::printSummary() const {
         std::cout << hline << "\n";
     }
 }
+
+Operator* smaug::getInputOperator(const Network* network,
+                                 Operator* op,
+                                 int destIdx) {
+    const Graph& graph = network->getGraph();
+    EdgeNameMap edges = get(boost::edge_name, graph);
+    in_edge_iter inEdgeIt, inEdgeEnd;
+    for (boost::tie(inEdgeIt, inEdgeEnd) = in_edges(op->getVertex(), graph);
+         inEdgeIt != inEdgeEnd;
+         ++inEdgeIt) {
+        if (edges[*inEdgeIt].destIdx == destIdx)
+            return get(boost::vertex_op, graph, source(*inEdgeIt, graph));
+    }
+    return nullptr;
+}
@@ -41,7 +41,7 @@ class Network {
     typedef std::map<std::string, Operator*> OperatorMap;
 
    public:
-    Network(std::string _name) : name(_name) {}
+    Network(std::string _name) : name(_name), concurrentOps(false) {}
     ~Network() {
         for (auto& op : operators)
             delete op.second;
@@ -49,6 +49,13 @@ class Network {
 
     void addOperator(Operator* op);
     void addEdge(Operator* src, Operator* dest, TensorIndices indices);
+    /** Removes all the edges from src to dest. */
+    void removeEdge(Operator* src, Operator* dest);
+    /**
+     * Removes the operator and all of its edges from the network, and deletes
+     * it. Its tensors stay in the workspace.
+     */
+    void removeOperator(Operator* op);
     const OperatorMap& getOperators() const { return operators; }
     Operator* getOperator(const std::string& name) {
         return operators.at(name);
@@ -66,6 +73,15 @@ class Network {
     }
     SamplingInfo& getSamplingInfo() { return sampling; }
 
+    /**
+     * Set whether the operators of this network may be run concurrently on
+     * the host. This is a property of the backend that builds the operators.
+     */
+    void setConcurrentOps(bool _concurrentOps) {
+        concurrentOps = _concurrentOps;
+    }
+    bool supportsConcurrentOps() const { return concurrentOps; }
+
    protected:
     struct OperatorInsertion {
         Operator* newOp;
@@ -84,8 +100,17 @@ class Network {
 
     /** Name of the model. */
     std::string name;
+
+    /** True if independent operators can be run concurrently. */
+    bool concurrentOps;
 };
 
+/**
+ * Returns the operator feeding the input at destIdx of op, or nullptr if the
+ * input is not connected in the graph.
+ */
+Operator* getInputOperator(const Network* network, Operator* op, int destIdx);
+
 }  // namespace smaug
 
 #endif
@@ -1,14 +1,20 @@
 #include <iostream>
 #include <fstream>
 #include <fcntl.h>
+#include <unordered_map>
 
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 
 #include "smaug/core/backend.h"
+#include "smaug/core/batch_norm_folding.h"
+#include "smaug/core/globals.h"
+#include "smaug/core/layout_propagation.h"
+#include "smaug/core/memory_planner.h"
 #include "smaug/core/tensor.h"
 #include "smaug/core/network.h"
 #include "smaug/core/network_builder.h"
+#include "smaug/core/param_container.h"
 #include "smaug/core/workspace.h"
 #include "smaug/core/graph.pb.h"
 #include "smaug/core/node.pb.h"
@@ -64,6 +70,7 @@
 #include "smaug/operators/pea/p_greater_op.h"
 #include "smaug/utility/utils.h"
 #include "smaug/utility/debug_stream.h"
+#include "smaug/utility/thread_pool.h"
 
 using namespace smaug;
 using namespace std;
@@ -107,11 +114,31 @@ ActivationInfo getActivationInfo(const ActivationParams& params) {
     return actInfo;
 }
 
+// Maps tensor names to their data in the parameters protobuf.
+typedef std::unordered_map<std::string, const TensorData*> TensorDataIndex;
+
+// Create the tensor of a data node from the network parameters. A parameter
+// container maps the tensor data in place. Otherwise, the data is copied from
+// the tensor data array.
+static Tensor* createDataTensor(const TensorProto& tensorProto,
+                                const TensorDataIndex& tensorDataIndex,
+                                const ParamContainer* paramContainer) {
+    if (paramContainer) {
+        Tensor* tensor = paramContainer->createTensor(tensorProto);
+        if (tensor)
+            return tensor;
+    }
+    auto it = tensorDataIndex.find(tensorProto.name());
+    if (it == tensorDataIndex.end())
+        return new Tensor(tensorProto, TensorData::default_instance());
+    return new Tensor(tensorProto, *it->second);
+}
+
 // Create an operator by deserializing a node in the graph, and add it to the
-// network.
+// network. For data nodes, dataTensor is the tensor holding the data.
 template <typename Backend>
 static void createAndAddOperator(const NodeProto& node,
-                                 const TensorDataArray& tensorDataArray,
+                                 Tensor* dataTensor,
                                  HostMemoryAccessPolicy memPolicy,
                                  Network* network,
                                  Workspace* workspace) {
@@ -121,17 +148,7 @@ static void createAndAddOperator(const NodeProto& node,
     dout(0) << "Adding " << name << " (" << OpType_Name(type) << ").\n";
 
     if (type == OpType::Data) {
-        // Find the tensor data from the tensor data array.
-        TensorData tensorData;
-        for (int i = 0; i < tensorDataArray.data_array_size(); i++) {
-            if (tensorDataArray.data_array(i).name() ==
-                node.input_tensors(0).name()) {
-                tensorData = tensorDataArray.data_array(i);
-                break;
-            }
-        }
-        auto inputTensor = workspace->addTensor(
-                new Tensor(node.input_tensors(0), tensorData));
+        auto inputTensor = workspace->addTensor(dataTensor);
         auto inputTensorOp = Backend::createDataOp(name, workspace);
         inputTensorOp->setData(inputTensor);
         network->addOperator(inputTensorOp);
@@ -308,17 +325,17 @@ static void createAndAddOperator(const NodeProto& node,
         assert(false && "Invalid host memory access policy!");
     }
 
-    // Create the output tensors and allocate storage for them.
-    // TODO: The tensor storage allocation can be deferred until scheduling
-    // time, which can benefit future control flow operators because the untaken
-    // branch of the control flow will not have that memory allocated and
-    // filled.
+    // Create the output tensors. Their storage is not allocated here: either
+    // the memory planner assigns it once the whole network has been built, or
+    // it is allocated when the operator first writes the output at scheduling
+    // time. This way, the untaken branch of the control flow never has that
+    // memory allocated and filled.
     for (int i = 0; i < op->getOutputs().size(); i++) {
         if (!op->getOutput(i)) {
             const TensorProto& tensorProto = node.output_tensors(i);
             Tensor* output = workspace->addTensor(
                     new Tensor(tensorProto.name(), tensorProto.shape()));
-            output->allocateStorage(tensorProto.data_type());
+            output->setDataType(tensorProto.data_type());
             op->setOutput(output, i);
         }
     }
@@ -329,14 +346,46 @@ static void createAndAddOperator(const NodeProto& node,
 template <typename Backend>
 static Network* createNetworkFromProto(const GraphProto& graphProto,
                                        const TensorDataArray& tensorDataArray,
+                                       const ParamContainer* paramContainer,
                                        SamplingInfo& sampling,
                                        Workspace* workspace) {
     Network* network = new Network(graphProto.name());
     network->setSamplingInfo(sampling);
+    network->setConcurrentOps(Backend::ConcurrentOps);
+
+    // Index the tensor data by name, so that every data node finds its data
+    // in constant time.
+    TensorDataIndex tensorDataIndex;
+    tensorDataIndex.reserve(tensorDataArray.data_array_size());
+    for (const TensorData& tensorData : tensorDataArray.data_array())
+        tensorDataIndex.emplace(tensorData.name(), &tensorData);
+
+    // Creating the data tensors copies all the network parameters, so do it
+    // on the thread pool if it has been started. In simulation, the pool only
+    // starts after fast-forwarding. Everything else touches the network and
+    // the workspace, which are not thread safe, so it stays sequential.
+    std::vector<int> dataNodes;
+    for (int i = 0; i < graphProto.nodes_size(); i++) {
+        if (graphProto.nodes(i).op() == OpType::Data)
+            dataNodes.push_back(i);
+    }
+    std::vector<Tensor*> dataTensors(graphProto.nodes_size(), nullptr);
+    auto createDataTensorForNode = [&](int i) {
+        const NodeProto& node = graphProto.nodes(dataNodes[i]);
+        dataTensors[dataNodes[i]] = createDataTensor(
+                node.input_tensors(0), tensorDataIndex, paramContainer);
+    };
+    if (threadPool && threadPool->isInitialized()) {
+        threadPool->parallelFor(0, dataNodes.size(), createDataTensorForNode);
+    } else {
+        for (int i = 0; i < dataNodes.size(); i++)
+            createDataTensorForNode(i);
+    }
+
     for (int i = 0; i < graphProto.nodes_size(); i++) {
         const NodeProto& node = graphProto.nodes(i);
         createAndAddOperator<Backend>(node,
-                                      tensorDataArray,
+                                      dataTensors[i],
                                       graphProto.mem_policy(),
                                       network,
                                       workspace);
@@ -376,6 +425,26 @@ static Network* createNetworkFromProto(const GraphProto& graphProto,
         }
     }
 
+    if (useBatchNormFolding) {
+        int numFolded = foldBatchNorms<Backend>(network, workspace);
+        std::cout << "Folded " << numFolded << " batch norm operators.\n";
+    }
+
+    if (useLayoutPropagation) {
+        int numRemoved = propagateLayouts<Backend>(network, workspace);
+        std::cout << "Removed " << numRemoved << " reorder operators.\n";
+    }
+
+    // The output tensors above are created directly from the model rather
+    // than by createAllTensors(), so let the operators that only move data
+    // around (split, concat, reshape) alias their tensors now. Producers come
+    // first, so that chains of views resolve the same way they do when the
+    // tensors are created operator by operator.
+    vertices.clear();
+    boost::topological_sort(graph, std::front_inserter(vertices));
+    for (auto v : vertices)
+        get(boost::vertex_op, graph, v)->createTensorViews();
+
     return network;
 }
 
@@ -395,15 +464,22 @@ Network* smaug::buildNetwork(const std::string& modelTopo,
         cout << "Failed to parse the network topology file!" << endl;
         exit(1);
     }
-    // Parse the network parameters from the protobuf binary file.
+    // The network parameters are either memory mapped from a parameter
+    // container, or parsed from the protobuf binary file.
     TensorDataArray tensorDataArray;
-    fstream modelParamsFile(modelParams, ios::in | ios::binary);
-    if (!modelParamsFile) {
-        cout << modelParams << ": network parameters file not found." << endl;
-        exit(1);
-    } else if (!tensorDataArray.ParseFromIstream(&modelParamsFile)) {
-        cout << "Failed to parse the network parameters file.\n";
-        exit(1);
+    std::unique_ptr<ParamContainer> paramContainer;
+    if (ParamContainer::isParamContainer(modelParams)) {
+        paramContainer.reset(new ParamContainer(modelParams));
+    } else {
+        fstream modelParamsFile(modelParams, ios::in | ios::binary);
+        if (!modelParamsFile) {
+            cout << modelParams << ": network parameters file not found."
+                 << endl;
+            exit(1);
+        } else if (!tensorDataArray.ParseFromIstream(&modelParamsFile)) {
+            cout << "Failed to parse the network parameters file.\n";
+            exit(1);
+        }
     }
 
     cout << "======================================================\n";
@@ -412,17 +488,28 @@ Network* smaug::buildNetwork(const std::string& modelTopo,
     Network* network = nullptr;
     if (graph.backend() == ReferenceBackend::Name) {
         network = createNetworkFromProto<ReferenceBackend>(
-                graph, tensorDataArray, sampling, workspace);
+                graph, tensorDataArray, paramContainer.get(), sampling,
+                workspace);
     } else if (graph.backend() == SmvBackend::Name) {
         network = createNetworkFromProto<SmvBackend>(
-                graph, tensorDataArray, sampling, workspace);
+                graph, tensorDataArray, paramContainer.get(), sampling,
+                workspace);
     } else if (graph.backend() == PeaBackend::Name) {
         network = createNetworkFromProto<PeaBackend>(
-                graph, tensorDataArray, sampling, workspace);
+                graph, tensorDataArray, paramContainer.get(), sampling,
+                workspace);
     } else {
         assert(false && "Unknown backend!");
     }
 
+    if (useMemoryPlanner) {
+        MemoryPlanner planner(network, workspace);
+        planner.run();
+        cout << "Memory planner: " << planner.getArenaSize()
+             << " bytes of activations (" << planner.getTotalTensorSize()
+             << " bytes without reuse).\n";
+    }
+
     cout << "======================================================\n";
     cout << "      Summary of the network.\n";
     cout << "======================================================\n";
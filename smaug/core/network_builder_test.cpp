@@ -0,0 +1,120 @@
+#include <fstream>
+
+#include <google/protobuf/text_format.h>
+
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/graph.pb.h"
+#include "smaug/core/network_builder.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.pb.h"
+
+using namespace smaug;
+
+static TensorProto createTensorProto(const std::string& name,
+                                     const std::vector<int>& dims) {
+    TensorProto tensorProto;
+    tensorProto.set_name(name);
+    tensorProto.set_data_type(Float32);
+    for (int dim : dims)
+        tensorProto.mutable_shape()->add_dims(dim);
+    tensorProto.mutable_shape()->set_layout(NC);
+    tensorProto.mutable_shape()->set_alignment(ReferenceBackend::Alignment);
+    return tensorProto;
+}
+
+static NodeProto* addNode(GraphProto& graph,
+                          const std::string& name,
+                          OpType op,
+                          const std::vector<TensorProto>& inputs,
+                          const std::vector<TensorProto>& outputs) {
+    NodeProto* node = graph.add_nodes();
+    node->set_name(name);
+    node->set_op(op);
+    for (const auto& input : inputs)
+        *node->add_input_tensors() = input;
+    for (const auto& output : outputs)
+        *node->add_output_tensors() = output;
+    return node;
+}
+
+static void addParent(NodeProto* node, const std::string& parent, int index) {
+    node->add_parents(parent);
+    node->add_src_tensors_indices(index);
+}
+
+TEST_CASE_METHOD(SmaugTest, "Network builder", "[networkbuilder]") {
+    // input -> split -> relu0/relu1 -> concat -> reshape, where the split and
+    // the concat are along the outermost axis.
+    GraphProto graph;
+    graph.set_name("views");
+    graph.set_backend(ReferenceBackend::Name);
+    graph.set_mem_policy(AllDma);
+    TensorProto input = createTensorProto("input", { 4, 8 });
+    TensorProto half0 = createTensorProto("split0", { 2, 8 });
+    TensorProto half1 = createTensorProto("split1", { 2, 8 });
+    TensorProto relu0 = createTensorProto("relu0", { 2, 8 });
+    TensorProto relu1 = createTensorProto("relu1", { 2, 8 });
+    TensorProto concat = createTensorProto("concat", { 4, 8 });
+    TensorProto reshape = createTensorProto("reshape", { 2, 16 });
+    addNode(graph, "input", OpType::Data, { input }, { input });
+    NodeProto* node =
+            addNode(graph, "split", OpType::Split, { input }, { half0, half1 });
+    node->mutable_params()->mutable_split_params()->set_split_axis(0);
+    addParent(node, "input", 0);
+    node = addNode(graph, "relu0", OpType::ReLU, { half0 }, { relu0 });
+    addParent(node, "split", 0);
+    node = addNode(graph, "relu1", OpType::ReLU, { half1 }, { relu1 });
+    addParent(node, "split", 1);
+    node = addNode(
+            graph, "concat", OpType::Concat, { relu0, relu1 }, { concat });
+    node->mutable_params()->mutable_concat_params()->set_concat_axis(0);
+    addParent(node, "relu0", 0);
+    addParent(node, "relu1", 0);
+    node = addNode(graph, "reshape", OpType::Reshape, { concat }, { reshape });
+    addParent(node, "concat", 0);
+
+    std::vector<float> inputData;
+    for (int i = 0; i < 32; i++)
+        inputData.push_back(i % 2 == 0 ? i : -i);
+    TensorDataArray tensorDataArray;
+    TensorData* tensorData = tensorDataArray.add_data_array();
+    tensorData->set_name("input");
+    for (float value : inputData)
+        tensorData->add_float_data(value);
+
+    std::string topoPath = "network_builder_test_topo.pbtxt";
+    std::string paramsPath = "network_builder_test_params.pb";
+    {
+        std::string topo;
+        google::protobuf::TextFormat::PrintToString(graph, &topo);
+        std::ofstream topoFile(topoPath);
+        topoFile << topo;
+        std::ofstream paramsFile(paramsPath, std::ios::out | std::ios::binary);
+        tensorDataArray.SerializeToOstream(&paramsFile);
+    }
+    SamplingInfo sampling = { NoSampling, 1 };
+    Network* network =
+            smaug::buildNetwork(topoPath, paramsPath, sampling, workspace());
+    std::remove(topoPath.c_str());
+    std::remove(paramsPath.c_str());
+
+    // The data movement operators alias their tensors instead of copying.
+    Tensor* inputTensor = workspace()->getTensor("input");
+    Tensor* concatTensor = workspace()->getTensor("concat");
+    REQUIRE(workspace()->getTensor("split0")->isViewOf(inputTensor, 0));
+    REQUIRE(workspace()->getTensor("split1")->isViewOf(inputTensor, 16));
+    REQUIRE(workspace()->getTensor("relu0")->isViewOf(concatTensor, 0));
+    REQUIRE(workspace()->getTensor("relu1")->isViewOf(concatTensor, 16));
+    REQUIRE(workspace()->getTensor("reshape")->isView());
+
+    Scheduler scheduler(network, workspace());
+    Tensor* output = scheduler.runNetwork();
+    REQUIRE(output == workspace()->getTensor("reshape"));
+    std::vector<float> expected;
+    for (float value : inputData)
+        expected.push_back(std::max(value, 0.0f));
+    verifyOutputs(output, expected);
+    delete network;
+}
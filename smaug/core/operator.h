@@ -1,6 +1,7 @@
 #ifndef _CORE_OPERATOR_H_
 #define _CORE_OPERATOR_H_
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
@@ -34,6 +35,30 @@ class Operator {
 
     virtual void tile() {};
 
+    /**
+     * Returns the tiles of the output at the given index, or nullptr if the
+     * output is not tiled. Only valid after tile() has been called.
+     */
+    virtual TiledTensor* getTiledOutput(int index) { return nullptr; }
+
+    /**
+     * Offers the output tiles of the producer of the input at the given index,
+     * so that the input can be read directly from them instead of being tiled
+     * again. Only valid after tile() has been called.
+     *
+     * @return True if the Operator will read the input from the given tiles,
+     * which requires that they are tiled the same way as the Operator's own
+     * input tiles.
+     */
+    virtual bool useTiledInput(int index, TiledTensor* tiles) { return false; }
+
+    /**
+     * Called when every consumer of the output at the given index reads it
+     * from its tiles, so the tiles need not be gathered into the output
+     * Tensor.
+     */
+    virtual void skipOutputUntile(int index) {}
+
     /**
      * Executes the Operator.
      *
@@ -69,6 +94,16 @@ class Operator {
      */
     virtual void createAllTensors() {}
 
+    /**
+     * Makes tensors of this Operator views of other tensors where that saves
+     * copying data, e.g. the outputs of a split become regions of its input.
+     *
+     * This is called from createAllTensors(), and by the network builder once
+     * every operator of a deserialized network has been connected. It must be
+     * safe to call more than once.
+     */
+    virtual void createTensorViews() {}
+
     /**
      * Returns true if the Operator is dead.
      *
@@ -100,7 +135,12 @@ class Operator {
      * */
     void setNumPendingInputs(int num) { numPendingInputs = num; }
     int getNumPendingInputs() const { return numPendingInputs; }
-    void decrNumPendingInputs() { numPendingInputs--; }
+    /**
+     * Atomically decrements the number of pending inputs and returns the new
+     * value. Exactly one caller observes zero, even if several parents
+     * finish at the same time on different threads.
+     */
+    int decrNumPendingInputs() { return --numPendingInputs; }
     const std::string& getName() const { return name; }
     Vertex getVertex() const { return vertex; }
     void setVertex(Vertex v) { vertex = v; }
@@ -147,7 +187,7 @@ class Operator {
     Workspace* workspace;
     /** The number of tensors that this operator is waiting on before it can be
      * scheduled. */
-    int numPendingInputs;
+    std::atomic<int> numPendingInputs;
     /** The memory interface over which input activations are expected to arrive. */
     MemoryType inputsMemType;
     /** The memory interface over which weights are expected to arrive. */
@@ -0,0 +1,118 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "smaug/core/param_container.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+
+constexpr char ParamContainer::kMagic[];
+constexpr uint32_t ParamContainer::kVersion;
+constexpr size_t ParamContainer::kPayloadAlignment;
+
+bool ParamContainer::isParamContainer(const std::string& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    char magic[sizeof(kMagic) - 1];
+    if (!file.read(magic, sizeof(magic)))
+        return false;
+    return memcmp(magic, kMagic, sizeof(magic)) == 0;
+}
+
+ParamContainer::ParamContainer(const std::string& _path)
+        : path(_path), mappingSize(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << path << ": network parameters file not found.\n";
+        exit(1);
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        std::cout << path << ": failed to stat the parameters file.\n";
+        exit(1);
+    }
+    mappingSize = fileStat.st_size;
+    // The mapping is private, so writes to the parameters (e.g. by
+    // optimization passes) are copy-on-write and never reach the file.
+    void* addr = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        std::cout << path << ": failed to map the parameters file.\n";
+        exit(1);
+    }
+    size_t size = mappingSize;
+    mapping = std::shared_ptr<void>(
+            addr, [size](void* ptr) { munmap(ptr, size); });
+    readIndex();
+    dout(1) << "Mapped " << index.size() << " tensors (" << mappingSize
+            << " bytes) from " << path << ".\n";
+}
+
+void ParamContainer::readIndex() {
+    const char* base = reinterpret_cast<const char*>(mapping.get());
+    size_t pos = 0;
+    auto read = [&](void* dest, size_t bytes) {
+        if (pos + bytes > mappingSize) {
+            std::cout << path << ": truncated parameters file.\n";
+            exit(1);
+        }
+        memcpy(dest, base + pos, bytes);
+        pos += bytes;
+    };
+
+    char magic[sizeof(kMagic) - 1];
+    uint32_t version, numTensors;
+    read(magic, sizeof(magic));
+    read(&version, sizeof(version));
+    read(&numTensors, sizeof(numTensors));
+    if (memcmp(magic, kMagic, sizeof(magic)) != 0 || version != kVersion) {
+        std::cout << path << ": unsupported parameters file format.\n";
+        exit(1);
+    }
+    for (uint32_t i = 0; i < numTensors; i++) {
+        uint32_t nameLength, dataType;
+        Entry entry;
+        read(&nameLength, sizeof(nameLength));
+        std::string name(nameLength, '\0');
+        read(&name[0], nameLength);
+        read(&dataType, sizeof(dataType));
+        read(&entry.offset, sizeof(entry.offset));
+        read(&entry.size, sizeof(entry.size));
+        entry.dataType = static_cast<DataType>(dataType);
+        if (entry.offset % kPayloadAlignment != 0 ||
+            entry.offset + entry.size > mappingSize) {
+            std::cout << path << ": invalid payload for tensor " << name
+                      << ".\n";
+            exit(1);
+        }
+        index[name] = entry;
+    }
+}
+
+Tensor* ParamContainer::createTensor(const TensorProto& tensorProto) const {
+    auto it = index.find(tensorProto.name());
+    if (it == index.end())
+        return nullptr;
+    const Entry& entry = it->second;
+    // The tensor shares ownership of the whole mapping rather than owning its
+    // payload, so no memory is freed when the tensor is destroyed.
+    char* payload = reinterpret_cast<char*>(mapping.get()) + entry.offset;
+    Tensor* tensor =
+            new Tensor(tensorProto, std::shared_ptr<void>(mapping, payload));
+    size_t expectedSize =
+            tensor->getShape().storageSize() * tensor->getDataTypeSize();
+    if (entry.dataType != tensorProto.data_type() ||
+        entry.size < expectedSize) {
+        std::cout << path << ": the payload of tensor " << tensorProto.name()
+                  << " does not match its shape or data type.\n";
+        exit(1);
+    }
+    return tensor;
+}
+
+}  // namespace smaug
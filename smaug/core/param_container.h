@@ -0,0 +1,76 @@
+#ifndef _CORE_PARAM_CONTAINER_H_
+#define _CORE_PARAM_CONTAINER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "smaug/core/tensor.h"
+#include "smaug/core/types.pb.h"
+
+namespace smaug {
+
+/**
+ * ParamContainer is a binary file of raw tensor payloads that is memory
+ * mapped, so that the parameters of a model can be used in place without
+ * being parsed or copied.
+ *
+ * The file is laid out as follows (all integers are little endian):
+ *
+ * - The header: the 8-byte magic "SMAUGPRM", a uint32 version and a uint32
+ *   number of tensors.
+ * - One index entry per tensor: a uint32 name length, followed by the name,
+ *   a uint32 DataType, a uint64 payload offset from the start of the file and
+ *   a uint64 payload size in bytes.
+ * - The payloads, each aligned to kPayloadAlignment bytes. A payload holds the
+ *   tensor data exactly as it is laid out in a Tensor, including any padding
+ *   for alignment.
+ *
+ * The file is mapped copy-on-write, so operators that rewrite their
+ * parameters in place never modify the file. All the tensors created from a
+ * container share ownership of the mapping, which is unmapped when the last
+ * of them is destroyed.
+ */
+class ParamContainer {
+   public:
+    static constexpr char kMagic[] = "SMAUGPRM";
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kPayloadAlignment = 64;
+
+    /** Maps the container at the given path and reads its index. */
+    ParamContainer(const std::string& path);
+
+    /** Returns true if the file at the given path is a ParamContainer. */
+    static bool isParamContainer(const std::string& path);
+
+    /**
+     * Creates a Tensor described by tensorProto, whose data points into the
+     * mapped payload of the same name. Returns nullptr if the container has
+     * no such payload.
+     */
+    Tensor* createTensor(const TensorProto& tensorProto) const;
+
+    /** Returns the number of tensors in the container. */
+    int getNumTensors() const { return index.size(); }
+
+   protected:
+    /** The location of a tensor payload in the mapped file. */
+    struct Entry {
+        DataType dataType;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    void readIndex();
+
+    std::string path;
+    /** The mapped file, which is unmapped when the last owner goes away. */
+    std::shared_ptr<void> mapping;
+    size_t mappingSize;
+    std::unordered_map<std::string, Entry> index;
+};
+
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,88 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "catch.hpp"
+#include "smaug/core/param_container.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+
+using namespace smaug;
+
+template <typename T>
+static void writeValue(std::ofstream& file, T value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Writes a parameter container holding a single tensor.
+template <typename T>
+static void writeContainer(const std::string& path,
+                           const std::string& name,
+                           DataType dataType,
+                           const std::vector<T>& data) {
+    std::ofstream file(path, std::ios::out | std::ios::binary);
+    file.write(ParamContainer::kMagic, strlen(ParamContainer::kMagic));
+    writeValue<uint32_t>(file, ParamContainer::kVersion);
+    writeValue<uint32_t>(file, 1);
+    writeValue<uint32_t>(file, name.size());
+    file.write(name.c_str(), name.size());
+    writeValue<uint32_t>(file, dataType);
+    writeValue<uint64_t>(file, ParamContainer::kPayloadAlignment);
+    writeValue<uint64_t>(file, data.size() * sizeof(T));
+    while (file.tellp() < ParamContainer::kPayloadAlignment)
+        file.put(0);
+    file.write(reinterpret_cast<const char*>(data.data()),
+               data.size() * sizeof(T));
+}
+
+TEST_CASE_METHOD(SmaugTest, "Parameter container", "[paramcontainer]") {
+    std::string path = "param_container_test.bin";
+    TensorProto tensorProto;
+    tensorProto.set_name("weights");
+    tensorProto.set_data_type(Float32);
+    tensorProto.set_data_format(Uncompressed);
+    tensorProto.mutable_shape()->add_dims(2);
+    tensorProto.mutable_shape()->add_dims(4);
+    tensorProto.mutable_shape()->set_layout(NC);
+    tensorProto.mutable_shape()->set_alignment(0);
+    std::vector<float> data{ 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    SECTION("Tensors are read in place") {
+        writeContainer(path, "weights", Float32, data);
+        REQUIRE(ParamContainer::isParamContainer(path));
+        Tensor* tensor = nullptr;
+        {
+            ParamContainer container(path);
+            REQUIRE(container.getNumTensors() == 1);
+            TensorProto missingProto = tensorProto;
+            missingProto.set_name("bias");
+            REQUIRE(container.createTensor(missingProto) == nullptr);
+            tensor = container.createTensor(tensorProto);
+        }
+        // The tensor keeps the mapping alive after the container is gone.
+        REQUIRE(tensor->containsData());
+        REQUIRE(reinterpret_cast<uintptr_t>(tensor->data<float>()) %
+                        ParamContainer::kPayloadAlignment ==
+                0);
+        verifyOutputs<float>(tensor, data);
+
+        // Writes go to a private copy of the mapping and not to the file.
+        tensor->data<float>()[0] = 100;
+        delete tensor;
+        ParamContainer container(path);
+        tensor = container.createTensor(tensorProto);
+        verifyOutputs<float>(tensor, data);
+        delete tensor;
+    }
+
+    SECTION("Protobuf parameters are not containers") {
+        std::ofstream file(path, std::ios::out | std::ios::binary);
+        TensorDataArray tensorDataArray;
+        tensorDataArray.add_data_array()->set_name("weights");
+        tensorDataArray.SerializeToOstream(&file);
+        file.close();
+        REQUIRE(!ParamContainer::isParamContainer(path));
+    }
+
+    std::remove(path.c_str());
+}
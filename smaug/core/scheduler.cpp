@@ -1,16 +1,21 @@
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
 #include "smaug/utility/debug_stream.h"
+#include "smaug/utility/profiler.h"
 #include "smaug/utility/thread_pool.h"
+#include "smaug/core/globals.h"
 #include "smaug/core/tensor.h"
 #include "smaug/core/types.pb.h"
 #include "smaug/core/scheduler.h"
 
 namespace smaug {
 
-Tensor* Scheduler::runNetwork() {
+void Scheduler::tileNetwork() {
+    if (tiled)
+        return;
     std::cout << "======================================================\n";
     std::cout << "      Tiling operators of the network...\n";
     std::cout << "======================================================\n";
@@ -18,8 +23,11 @@ Tensor* Scheduler::runNetwork() {
         Operator* op = nameOp.second;
         dout(0) << "Tiling " << op->getName() << " ("
                 << OpType_Name(op->getOpType()) << ").\n";
+        ScopedProfile profile(
+                op->getName(), profile::kTile, OpType_Name(op->getOpType()));
         op->tile();
     }
+    shareTiles();
 
     // We have finished loading the model and building the network, as well as
     // the tiling of all the operators. Now we can stop fast forwarding.
@@ -30,9 +38,30 @@ Tensor* Scheduler::runNetwork() {
     // The fast-forwarding mode uses simpler CPUs, which will be switched to
     // OoO CPUs after it's done. Therefore, the initialization of the thread
     // pool must be after the fast-forwarding, otherwise the CPU IDs will be
-    // incorrect.
-    if (threadPool)
+    // incorrect. Native runs start the pool before loading the network.
+    if (threadPool && !threadPool->isInitialized())
         threadPool->initThreadPool();
+    tiled = true;
+}
+
+void Scheduler::resetForRun() {
+    readyQueue.clear();
+    for (auto nameOp : network->getOperators()) {
+        Operator* op = nameOp.second;
+        if (op->getOpType() == OpType::Data)
+            continue;
+        for (auto output : op->getOutputs()) {
+            output->setDead(false);
+            output->markDataChanged();
+        }
+    }
+}
+
+Tensor* Scheduler::runNetwork() {
+    if (tiled)
+        resetForRun();
+    else
+        tileNetwork();
 
     std::cout << "======================================================\n";
     std::cout << "      Scheduling operators of the network...\n";
@@ -47,30 +76,138 @@ Tensor* Scheduler::runNetwork() {
         if (numPendingInputs == 0)
             readyQueue.push_back(op);
     }
-    Tensor* output;
     {
         auto stats =
                 gem5::ScopedStats(stats::kNetworkStart, stats::kNetworkEnd);
-        output = scheduleReady();
+        if (useConcurrentScheduling())
+            scheduleReadyConcurrently();
+        else
+            scheduleReady();
     }
+    Tensor* output = getSinkOperator()->getOutput(0);
+    dout(2) << *output << "\n";
     return output;
 }
 
-Tensor* Scheduler::scheduleReady() {
-    Tensor* output;
+Operator* Scheduler::getSinkOperator() const {
+    const Graph& graph = network->getGraph();
+    std::list<Vertex> vertices;
+    boost::topological_sort(graph, std::front_inserter(vertices));
+    return get(boost::vertex_op, graph, vertices.back());
+}
+
+bool Scheduler::useConcurrentScheduling() const {
+    if (!concurrent)
+        return false;
+    if (runningInSimulation || !threadPool) {
+        dout(0) << "Concurrent scheduling requires a native run with a "
+                   "thread pool; falling back to sequential scheduling.\n";
+        return false;
+    }
+    if (!network->supportsConcurrentOps()) {
+        dout(0) << "The backend does not support concurrent operators; "
+                   "falling back to sequential scheduling.\n";
+        return false;
+    }
+    return true;
+}
+
+void Scheduler::shareTiles() {
+    const Graph& graph = network->getGraph();
+    EdgeNameMap edges = get(boost::edge_name, graph);
+    int numShared = 0;
+    for (auto nameOp : network->getOperators()) {
+        Operator* op = nameOp.second;
+        // Tracks for every tiled output whether all its consumers read the
+        // tiles directly.
+        std::map<int, bool> allConsumersShare;
+        out_edge_iter outEdgeIt, outEdgeEnd;
+        for (boost::tie(outEdgeIt, outEdgeEnd) =
+                     out_edges(op->getVertex(), graph);
+             outEdgeIt != outEdgeEnd;
+             ++outEdgeIt) {
+            const TensorIndices& indices = edges[*outEdgeIt];
+            TiledTensor* tiles = op->getTiledOutput(indices.srcIdx);
+            if (!tiles)
+                continue;
+            Operator* child =
+                    get(boost::vertex_op, graph, target(*outEdgeIt, graph));
+            bool shared = child->useTiledInput(indices.destIdx, tiles);
+            if (shared) {
+                dout(1) << child->getName() << " reads the output tiles of "
+                        << op->getName() << ".\n";
+                numShared++;
+            }
+            auto it = allConsumersShare.find(indices.srcIdx);
+            allConsumersShare[indices.srcIdx] =
+                    (it == allConsumersShare.end() || it->second) && shared;
+        }
+        for (auto& entry : allConsumersShare) {
+            if (entry.second)
+                op->skipOutputUntile(entry.first);
+        }
+    }
+    dout(0) << numShared << " operator inputs are read from the output tiles "
+               "of their producers.\n";
+}
+
+void Scheduler::scheduleReady() {
     for (auto op : readyQueue) {
         dout(0) << "Scheduling " << op->getName() << " ("
                 << OpType_Name(op->getOpType()) << ").\n";
         maybeRunOperator(op);
         updateChildren(op);
-        output = op->getOutput(0);
-        dout(2) << *output << "\n";
     }
-    return output;
+}
+
+void Scheduler::allocateViewBases() {
+    for (auto nameOp : network->getOperators()) {
+        Operator* op = nameOp.second;
+        for (int i = 0; i < op->getOutputs().size(); i++) {
+            Tensor* output = op->getOutput(i);
+            if (!output || !output->isView())
+                continue;
+            Tensor* base = output->getViewBase();
+            while (base->isView())
+                base = base->getViewBase();
+            if (!base->containsData())
+                base->allocateStorage(output->getDataType());
+        }
+    }
+}
+
+void Scheduler::scheduleReadyConcurrently() {
+    allocateViewBases();
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (!readyQueue.empty() || numRunningOps > 0) {
+        if (readyQueue.empty()) {
+            opFinishedCond.wait(lock);
+            continue;
+        }
+        Operator* op = readyQueue.front();
+        readyQueue.pop_front();
+        numRunningOps++;
+        lock.unlock();
+
+        dout(0) << "Scheduling " << op->getName() << " ("
+                << OpType_Name(op->getOpType()) << ").\n";
+        threadPool->submit([this, op]() { runAndUpdateChildren(op); });
+        lock.lock();
+    }
+}
+
+void Scheduler::runAndUpdateChildren(Operator* op) {
+    maybeRunOperator(op);
+    updateChildren(op);
+    std::lock_guard<std::mutex> lock(queueMutex);
+    numRunningOps--;
+    opFinishedCond.notify_one();
 }
 
 void Scheduler::maybeRunOperator(Operator* op) {
     if (!op->isDead()) {
+        ScopedProfile profile(
+                op->getName(), profile::kRun, OpType_Name(op->getOpType()));
         op->run();
     } else {
         for (auto output : op->getOutputs())
@@ -87,10 +224,10 @@ void Scheduler::updateChildren(Operator* op) {
          ++outEdgeIt) {
         Vertex childVertex = target(*outEdgeIt, graph);
         Operator* child = get(boost::vertex_op, graph, childVertex);
-        if (child->getNumPendingInputs() > 0) {
-            child->decrNumPendingInputs();
-            if (child->getNumPendingInputs() == 0)
-                readyQueue.push_back(child);
+        if (child->getNumPendingInputs() > 0 &&
+            child->decrNumPendingInputs() == 0) {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            readyQueue.push_back(child);
         }
     }
 }
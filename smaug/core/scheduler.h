@@ -1,4 +1,9 @@
+#ifndef _CORE_SCHEDULER_H_
+#define _CORE_SCHEDULER_H_
+
+#include <condition_variable>
 #include <list>
+#include <mutex>
 
 #include "smaug/core/network.h"
 #include "smaug/core/workspace.h"
@@ -11,10 +16,37 @@ namespace smaug {
  */
 class Scheduler {
    public:
-    Scheduler(Network* _network, Workspace* _workspace)
-            : network(_network), workspace(_workspace) {}
+    /**
+     * Create a Scheduler for the Network.
+     *
+     * If concurrent is true, the Scheduler dispatches every ready Operator to
+     * the global thread pool, so that independent branches of the graph run
+     * in parallel. This only takes effect in native runs, when a thread pool
+     * exists and the backend supports concurrent operators; otherwise
+     * Operators are run one at a time in topological order.
+     */
+    Scheduler(Network* _network,
+              Workspace* _workspace,
+              bool _concurrent = false)
+            : network(_network), workspace(_workspace),
+              concurrent(_concurrent), tiled(false), numRunningOps(0) {}
     virtual ~Scheduler(){};
-    /** Runs the Network to completion. The final output tensor is returned. */
+    /**
+     * Tiles all the Operators of the Network, if they have not been tiled
+     * yet, and ends the fast-forwarding phase of the simulation.
+     */
+    void tileNetwork();
+
+    /**
+     * Runs the Network to completion. The final output tensor, which is the
+     * output of the last Operator in topological order, is returned.
+     *
+     * The Network is only tiled on the first run, so it can be run again
+     * after the data of its input tensors is replaced. The caller must call
+     * markDataChanged() on those tensors, so that their stale tiles are
+     * filled again, while the tiles of unchanged tensors, such as the
+     * weights, are kept.
+     */
     Tensor* runNetwork();
 
    protected:
@@ -22,13 +54,57 @@ class Scheduler {
      * Runs the operators in the ready queue. This may add new operators to
      * the ready queue by calling updateChildren().
      */
-    Tensor* scheduleReady();
+    void scheduleReady();
+
+    /**
+     * Concurrent version of scheduleReady(). The main thread pops Operators
+     * off the ready queue and submits them to the thread pool; worker
+     * threads push the children they release back onto the queue.
+     */
+    void scheduleReadyConcurrently();
+
+    /**
+     * Prepares the Network to be run again: the outputs of all the non-Data
+     * Operators are revived and marked as changed, so that the tiles copied
+     * from them during the last run are filled again.
+     */
+    void resetForRun();
+
+    /**
+     * Allocates the storage of every Tensor that is aliased by views and has
+     * no storage yet. Storage is otherwise allocated lazily on the first
+     * write, which must not race: concurrent producers writing through
+     * different views of one Tensor (e.g. the inputs of a concat) would each
+     * allocate it.
+     */
+    void allocateViewBases();
+
+    /** Returns the last Operator of the Network in topological order. */
+    Operator* getSinkOperator() const;
+
+    /** Returns true if the ready queue should be drained concurrently. */
+    bool useConcurrentScheduling() const;
+
+    /**
+     * After all the Operators are tiled, lets every Operator read its inputs
+     * directly from the output tiles of their producers when they are tiled
+     * the same way, which saves gathering the tiles into the output Tensor
+     * and scattering it again into the input tiles.
+     */
+    void shareTiles();
+
+    /** Runs one Operator and releases its children. Thread-safe. */
+    void runAndUpdateChildren(Operator* op);
 
     /**
      * If none of the inputs to the current Operator are dead, then this will
      * run the Operator; otherwise, otherwise, all of the Operator's outputs
      * will be marked as dead tensors. The only exception is MergeOp, which can
      * run with dead inputs.
+     *
+     * Output tensors without storage are allocated when the Operator first
+     * writes them while running, so the outputs of dead Operators (and the
+     * untaken output of a SwitchOp) are never materialized.
      */
     void maybeRunOperator(Operator* op);
 
@@ -42,8 +118,23 @@ class Scheduler {
     Network* network;
     Workspace* workspace;
 
+    /** True if the user requested concurrent scheduling. */
+    bool concurrent;
+
+    /** True once the Operators have been tiled. */
+    bool tiled;
+
     /** The queue of all Operators ready to be executed. */
     std::list<Operator*> readyQueue;
+
+    /** Protects readyQueue and numRunningOps. */
+    std::mutex queueMutex;
+    /** Signalled whenever an Operator finishes. */
+    std::condition_variable opFinishedCond;
+    /** Number of Operators dispatched but not yet finished. */
+    int numRunningOps;
 };
 
 }  // namespace smaug
+
+#endif
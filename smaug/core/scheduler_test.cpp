@@ -0,0 +1,215 @@
+#include <sstream>
+
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
+#include "smaug/core/scheduler.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/concat_op.h"
+#include "smaug/operators/control_flow_ops.h"
+#include "smaug/operators/eltwise_add_op.h"
+#include "smaug/operators/relu_op.h"
+#include "smaug/operators/sigmoid_op.h"
+#include "smaug/utility/profiler.h"
+#include "smaug/utility/thread_pool.h"
+
+using namespace smaug;
+
+// Builds a diamond-shaped network: the input feeds two independent branches
+// (relu and sigmoid), which are joined by an elementwise add.
+static void buildDiamondNetwork(Network* network, Workspace* workspace) {
+    TensorShape inputShape({ 1, 8 }, DataLayout::NC);
+    Tensor* input = new Tensor("input", inputShape);
+    input->allocateStorage<float>();
+    input->fillData<float>({ -4, -3, -2, -1, 1, 2, 3, 4 });
+    workspace->addTensor(input);
+
+    auto reluOp = new ReluOp<ReferenceBackend>("relu", workspace);
+    reluOp->setInput(input, 0);
+    reluOp->createAllTensors();
+    reluOp->getOutput(0)->allocateStorage<float>();
+    auto sigmoidOp = new SigmoidOp<ReferenceBackend>("sigmoid", workspace);
+    sigmoidOp->setInput(input, 0);
+    sigmoidOp->createAllTensors();
+    sigmoidOp->getOutput(0)->allocateStorage<float>();
+    auto addOp = new EltwiseAddOp<ReferenceBackend>("add", workspace);
+    addOp->setInput(reluOp->getOutput(0), 0);
+    addOp->setInput(sigmoidOp->getOutput(0), 1);
+    addOp->createAllTensors();
+    addOp->getOutput(0)->allocateStorage<float>();
+
+    network->addOperator(reluOp);
+    network->addOperator(sigmoidOp);
+    network->addOperator(addOp);
+    network->addEdge(reluOp, addOp, { 0, 0 });
+    network->addEdge(sigmoidOp, addOp, { 0, 1 });
+    network->setConcurrentOps(ReferenceBackend::ConcurrentOps);
+}
+
+TEST_CASE_METHOD(SmaugTest, "Scheduler", "[scheduler]") {
+    buildDiamondNetwork(network(), workspace());
+    std::vector<float> expectedValues{ 0.01798621, 0.04742587, 0.11920292,
+                                       0.26894142, 1.73105858, 2.88079708,
+                                       3.95257413, 4.98201379 };
+
+    SECTION("Sequential scheduling") {
+        Scheduler scheduler(network(), workspace());
+        Tensor* output = scheduler.runNetwork();
+        REQUIRE(output->getName() == "add");
+        verifyOutputs(output, expectedValues);
+    }
+
+    SECTION("Concurrent scheduling") {
+        threadPool = new ThreadPool(2);
+        Scheduler scheduler(network(), workspace(), true);
+        Tensor* output = scheduler.runNetwork();
+        delete threadPool;
+        threadPool = nullptr;
+        REQUIRE(output->getName() == "add");
+        verifyOutputs(output, expectedValues);
+    }
+
+    SECTION("Profiled scheduling") {
+        Profiler& profiler = Profiler::get();
+        profiler.clear();
+        profiler.enable();
+        Scheduler scheduler(network(), workspace());
+        scheduler.runNetwork();
+        profiler.disable();
+        std::stringstream trace;
+        profiler.write(trace);
+        profiler.clear();
+        // Every operator is tiled and run once.
+        for (std::string opName : { "relu", "sigmoid", "add" }) {
+            for (std::string category : { "tile", "run" }) {
+                REQUIRE(trace.str().find("\"name\": \"" + opName +
+                                         "\", \"cat\": \"" + category +
+                                         "\"") != std::string::npos);
+            }
+        }
+        REQUIRE(trace.str().find("\"name\": \"Network\", \"cat\": "
+                                 "\"phase\"") != std::string::npos);
+    }
+}
+
+TEST_CASE_METHOD(SmaugTest,
+                 "Concurrent scheduling returns the sink output",
+                 "[scheduler]") {
+    buildDiamondNetwork(network(), workspace());
+    // A side branch that nothing consumes, and which is slow enough to
+    // usually finish after the add.
+    TensorShape sideShape({ 1, 16384 }, DataLayout::NC);
+    Tensor* sideInput = new Tensor("side_input", sideShape);
+    sideInput->allocateStorage<float>();
+    workspace()->addTensor(sideInput);
+    auto sideOp = new SigmoidOp<ReferenceBackend>("side", workspace());
+    sideOp->setInput(sideInput, 0);
+    sideOp->createAllTensors();
+    sideOp->getOutput(0)->allocateStorage<float>();
+    network()->addOperator(sideOp);
+
+    threadPool = new ThreadPool(2);
+    Scheduler scheduler(network(), workspace(), true);
+    for (int run = 0; run < 10; run++)
+        REQUIRE(scheduler.runNetwork()->getName() == "add");
+    delete threadPool;
+    threadPool = nullptr;
+}
+
+TEST_CASE_METHOD(SmaugTest,
+                 "Concurrent branches feeding a concat",
+                 "[scheduler]") {
+    // The relu and the sigmoid write directly into the output of the concat,
+    // and run at the same time.
+    TensorShape inputShape({ 1, 8 }, DataLayout::NC);
+    Tensor* input = new Tensor("input", inputShape);
+    input->allocateStorage<float>();
+    input->fillData<float>({ -4, -3, -2, -1, 1, 2, 3, 4 });
+    workspace()->addTensor(input);
+
+    auto reluOp = new ReluOp<ReferenceBackend>("relu", workspace());
+    reluOp->setInput(input, 0);
+    reluOp->createAllTensors();
+    reluOp->getOutput(0)->setDataType(Float32);
+    auto sigmoidOp = new SigmoidOp<ReferenceBackend>("sigmoid", workspace());
+    sigmoidOp->setInput(input, 0);
+    sigmoidOp->createAllTensors();
+    sigmoidOp->getOutput(0)->setDataType(Float32);
+    auto concatOp =
+            new ConcatOp<ReferenceBackend>("concat", workspace(), 2, 0);
+    concatOp->setInput(reluOp->getOutput(0), 0);
+    concatOp->setInput(sigmoidOp->getOutput(0), 1);
+    concatOp->createAllTensors();
+    concatOp->getOutput(0)->setDataType(Float32);
+    Tensor* output = concatOp->getOutput(0);
+    REQUIRE(reluOp->getOutput(0)->isViewOf(output, 0));
+    REQUIRE(sigmoidOp->getOutput(0)->isViewOf(output, 8));
+
+    network()->addOperator(reluOp);
+    network()->addOperator(sigmoidOp);
+    network()->addOperator(concatOp);
+    network()->addEdge(reluOp, concatOp, { 0, 0 });
+    network()->addEdge(sigmoidOp, concatOp, { 0, 1 });
+    network()->setConcurrentOps(ReferenceBackend::ConcurrentOps);
+
+    threadPool = new ThreadPool(2);
+    Scheduler scheduler(network(), workspace(), true);
+    REQUIRE(scheduler.runNetwork() == output);
+    delete threadPool;
+    threadPool = nullptr;
+    verifyOutputs<float>(output,
+                         { 0, 0, 0, 0, 1, 2, 3, 4, 0.01798621, 0.04742587,
+                           0.11920292, 0.26894142, 0.73105858, 0.88079708,
+                           0.95257413, 0.98201379 });
+}
+
+TEST_CASE_METHOD(SmaugTest, "Lazy output allocation", "[scheduler]") {
+    // A switch forwards the input to either a relu or a sigmoid, and a merge
+    // joins the two branches. Outputs only get storage once they are written.
+    TensorShape inputShape({ 1, 4 }, DataLayout::NC);
+    Tensor* input = new Tensor("input", inputShape);
+    input->allocateStorage<float>();
+    input->fillData<float>({ -2, -1, 1, 2 });
+    Tensor* pred = new Tensor("pred", TensorShape({ 1 }, DataLayout::N));
+    pred->allocateStorage<bool>();
+    pred->fillData({ false });
+    workspace()->addTensor(input);
+    workspace()->addTensor(pred);
+
+    auto switchOp = new SwitchOp<ReferenceBackend>("switch", workspace());
+    switchOp->setInput(input, SwitchOp<ReferenceBackend>::Input);
+    switchOp->setInput(pred, SwitchOp<ReferenceBackend>::Pred);
+    switchOp->createAllTensors();
+    auto reluOp = new ReluOp<ReferenceBackend>("relu", workspace());
+    reluOp->setInput(switchOp->getOutput(0), 0);
+    reluOp->createAllTensors();
+    auto sigmoidOp = new SigmoidOp<ReferenceBackend>("sigmoid", workspace());
+    sigmoidOp->setInput(switchOp->getOutput(1), 0);
+    sigmoidOp->createAllTensors();
+    auto mergeOp = new MergeOp<ReferenceBackend>("merge", workspace());
+    mergeOp->setNumInputs(2);
+    mergeOp->setInput(reluOp->getOutput(0), 0);
+    mergeOp->setInput(sigmoidOp->getOutput(0), 1);
+    mergeOp->createAllTensors();
+    for (Operator* op : { (Operator*)switchOp, (Operator*)reluOp,
+                          (Operator*)sigmoidOp, (Operator*)mergeOp }) {
+        for (auto output : op->getOutputs())
+            output->setDataType(Float32);
+        network()->addOperator(op);
+    }
+    network()->addEdge(switchOp, reluOp, { 0, 0 });
+    network()->addEdge(switchOp, sigmoidOp, { 1, 0 });
+    network()->addEdge(reluOp, mergeOp, { 0, 0 });
+    network()->addEdge(sigmoidOp, mergeOp, { 0, 1 });
+
+    Scheduler scheduler(network(), workspace());
+    scheduler.runNetwork();
+    REQUIRE(switchOp->getOutput(0)->containsData());
+    REQUIRE(reluOp->getOutput(0)->containsData());
+    REQUIRE(switchOp->getOutput(1)->isDead());
+    REQUIRE(!switchOp->getOutput(1)->containsData());
+    REQUIRE(sigmoidOp->getOutput(0)->isDead());
+    REQUIRE(!sigmoidOp->getOutput(0)->containsData());
+    verifyOutputs<float>(mergeOp->getOutput(0), { 0, 0, 1, 2 });
+}
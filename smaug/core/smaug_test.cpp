@@ -3,6 +3,8 @@
 #include "smaug/core/network_builder.h"
 #include "smaug/core/scheduler.h"
 #include "smaug/core/smaug_test.h"
+#include "smaug/operators/data_op.h"
+#include "smaug/operators/relu_op.h"
 
 namespace smaug {
 
@@ -25,6 +27,35 @@ Tensor* SmaugTest::buildAndRunNetwork(const std::string& modelTopo,
     return scheduler.runNetwork();
 }
 
+Operator* SmaugTest::addDataOp(Tensor* tensor) {
+    auto dataOp = new DataOp<ReferenceBackend>(tensor->getName(), workspace_);
+    dataOp->setData(tensor);
+    network_->addOperator(dataOp);
+    return dataOp;
+}
+
+Operator* SmaugTest::addRelu(const std::string& name, Tensor* input) {
+    auto reluOp = new ReluOp<ReferenceBackend>(name, workspace_);
+    reluOp->setInput(input, 0);
+    reluOp->createAllTensors();
+    reluOp->getOutput(0)->setDataType(Float32);
+    network_->addOperator(reluOp);
+    return reluOp;
+}
+
+Operator* SmaugTest::addRelu(const std::string& name, Operator* producer) {
+    Operator* reluOp = addRelu(name, producer->getOutput(0));
+    network_->addEdge(producer, reluOp, { 0, 0 });
+    return reluOp;
+}
+
+std::vector<float> SmaugTest::getValues(Tensor* tensor) {
+    std::vector<float> values;
+    for (auto idx = tensor->startIndex(); !idx.end(); ++idx)
+        values.push_back(tensor->data<float>()[idx]);
+    return values;
+}
+
 // We can't directly compare with float16 values, so convert to float32.
 template <>
 void SmaugTest::verifyOutputs<float16>(Tensor* output, Tensor* expected) {
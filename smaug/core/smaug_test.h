@@ -49,6 +49,7 @@ class SmaugTest {
         // Set the global variables.
         runningInSimulation = false;
         useSystolicArrayWhenAvailable = false;
+        useDoubleBufferedSpads = false;
         numAcceleratorsAvailable = 1;
     }
 
@@ -140,6 +141,28 @@ class SmaugTest {
     Tensor* buildAndRunNetwork(const std::string& modelTopo,
                                const std::string& modelParams);
 
+    /** Adds a reference DataOp that produces the given Tensor. */
+    Operator* addDataOp(Tensor* tensor);
+
+    /**
+     * Adds a reference ReLU operator that reads the given Tensor. Its output
+     * has a float32 data type but no storage, as the network builder leaves
+     * it.
+     */
+    Operator* addRelu(const std::string& name, Tensor* input);
+
+    /**
+     * Adds a reference ReLU operator that reads the first output of the
+     * producer, connected to it.
+     */
+    Operator* addRelu(const std::string& name, Operator* producer);
+
+    /**
+     * Returns the float32 elements of the Tensor, skipping any alignment
+     * padding.
+     */
+    std::vector<float> getValues(Tensor* tensor);
+
     Network* network() const { return network_; }
     Workspace* workspace() const { return workspace_; }
 
@@ -6,6 +6,7 @@
 namespace smaug {
 
 TensorShapeProto* TensorShape::asTensorShapeProto() {
+    assert(isContiguous() && "Strided shapes cannot be serialized!");
     TensorShapeProto* shapeProto = new TensorShapeProto();
     *shapeProto->mutable_dims() = { dims_.begin(), dims_.end() };
     shapeProto->set_layout(layout);
@@ -21,7 +22,7 @@ TensorProto* Tensor::asTensorProto() {
     tensorProto->set_data_format(dataFormat);
     // Copy the tensor data into the proto.
     TensorData* protoData = new TensorData();
-    void* rawPtr = tensorData.get();
+    const void* rawPtr = rawData();
     switch (dataType) {
         case Float16:
             // Add 1 to cover the case when the storage size is odd.
@@ -62,6 +63,96 @@ TensorProto* Tensor::asTensorProto() {
     return tensorProto;
 }
 
+CopyPlan::CopyPlan(const TensorShape& destShape,
+                   const TensorShape& srcShape,
+                   const std::vector<int>& destOrigin,
+                   const std::vector<int>& srcOrigin,
+                   const std::vector<int>& regionSize)
+        : runLength(1), destOffset(0), srcOffset(0) {
+    assert(destShape.ndims() == srcShape.ndims());
+    const std::vector<int>& destStrides = destShape.strides();
+    const std::vector<int>& srcStrides = srcShape.strides();
+    const int ndims = srcShape.ndims();
+    for (int i = 0; i < ndims; i++) {
+        destOffset += destOrigin[i] * destStrides[i];
+        srcOffset += srcOrigin[i] * srcStrides[i];
+    }
+
+    // The region is clipped to both tensors, like a TensorRegionIndexIterator
+    // would. Dimensions of size one need no loop.
+    std::vector<int> dims;
+    for (int i = 0; i < ndims; i++) {
+        int count = std::min(regionSize[i],
+                             std::min(srcShape[i] - srcOrigin[i],
+                                      destShape[i] - destOrigin[i]));
+        if (count <= 0) {
+            runLength = 0;
+            return;
+        }
+        if (count > 1) {
+            dims.push_back(i);
+            loops.push_back({ count, destStrides[i], srcStrides[i] });
+        }
+    }
+
+    // Merge the innermost dimensions into the run while they are contiguous
+    // in both tensors. Once the run covers whole rows of both tensors, the
+    // alignment padding at the end of the rows is copied along with them, so
+    // that the next dimension can be merged too.
+    bool contiguous = srcShape.isContiguous() && destShape.isContiguous();
+    while (!loops.empty()) {
+        Loop& loop = loops.back();
+        if (loop.destStride != runLength || loop.srcStride != runLength)
+            break;
+        int dim = dims.back();
+        runLength *= loop.count;
+        if (contiguous && dim == ndims - 1 && loop.count == srcShape[dim] &&
+            loop.count == destShape[dim] &&
+            srcShape.getStorageDim(dim) == destShape.getStorageDim(dim))
+            runLength = srcShape.getStorageDim(dim);
+        loops.pop_back();
+        dims.pop_back();
+    }
+
+    // Fold every remaining loop that steps exactly over its inner loop into
+    // it, so that the nest has as few levels as possible.
+    for (int i = (int)loops.size() - 2; i >= 0; i--) {
+        Loop& outer = loops[i];
+        Loop& inner = loops[i + 1];
+        if (outer.destStride == inner.count * inner.destStride &&
+            outer.srcStride == inner.count * inner.srcStride) {
+            inner.count *= outer.count;
+            loops.erase(loops.begin() + i);
+        }
+    }
+}
+
+void CopyPlan::execute(Tensor* dest, Tensor* src) const {
+    assert(dest->getDataType() == src->getDataType());
+    switch (dest->getDataType()) {
+        case Float16:
+            execute<uint16_t>(dest->data<uint16_t>(), src->data<uint16_t>());
+            break;
+        case Float32:
+            execute<float>(dest->data<float>(), src->data<float>());
+            break;
+        case Float64:
+            execute<double>(dest->data<double>(), src->data<double>());
+            break;
+        case Int32:
+            execute<int>(dest->data<int>(), src->data<int>());
+            break;
+        case Int64:
+            execute<int64_t>(dest->data<int64_t>(), src->data<int64_t>());
+            break;
+        case Bool:
+            execute<bool>(dest->data<bool>(), src->data<bool>());
+            break;
+        default:
+            assert(false && "Unknown data type!");
+    }
+}
+
 Tensor* TiledTensor::getTileWithData(int index) {
     Tile* tile = &tiles[index];
     copyDataToTile(tile);
@@ -76,46 +167,27 @@ void TiledTensor::setTile(int index,
     tile->tensor = tensor;
     tile->origin = origin;
     tile->hasOrigin = true;
+    tile->hasCopyPlans = false;
     if (copyData)
         copyDataToTile(tile);
 }
 
-void* TiledTensor::tileCopyWorker(void* _args) {
-    auto args = reinterpret_cast<CopyTilesArgs*>(_args);
-    TiledTensor* tiledTensor = args->tiledTensor;
-    int start = args->start;
-    int numTiles = args->numTiles;
-    TileDataOperation op = args->op;
-    for (int i = start; i < start + numTiles; i++) {
-        Tile* tile = tiledTensor->getTile(i);
-        if (op == Scatter)
-            tiledTensor->copyDataToTile(tile);
-        else if (op == Gather)
-            tiledTensor->gatherDataFromTile(tile);
-    }
-    delete args;
-    return nullptr;
-}
-
 void TiledTensor::parallelCopyTileData(TileDataOperation op) {
     int totalNumTiles = tiles.size();
     int numTilesPerThread = std::ceil(totalNumTiles * 1.0 / threadPool->size());
-    int remainingTiles = totalNumTiles;
-    while (remainingTiles > 0) {
-        int numTiles = std::min(numTilesPerThread, remainingTiles);
-        auto args = new CopyTilesArgs(
-                this, totalNumTiles - remainingTiles, numTiles, op);
-        int cpuid =
-                threadPool->dispatchThread(tileCopyWorker, (void*)args);
-        assert(cpuid != -1 && "Failed to dispatch thread!");
-        remainingTiles -= numTiles;
-    }
-    threadPool->joinThreadPool();
+    threadPool->parallelFor(0, totalNumTiles, [this, op](int i) {
+        Tile* tile = getTile(i);
+        if (op == Scatter)
+            copyDataToTile(tile);
+        else if (op == Gather)
+            gatherDataFromTile(tile);
+    }, numTilesPerThread);
 }
 
 void TiledTensor::copyDataToAllTiles() {
-    // Don't copy if all the tiles have data filled.
-    if (dataFilled)
+    // Don't copy if all the tiles have up-to-date data.
+    if (filledInPlace ||
+        (dataFilled && filledVersion == origTensor->getDataVersion()))
         return;
 
     assert(origTensor != nullptr &&
@@ -127,12 +199,14 @@ void TiledTensor::copyDataToAllTiles() {
         parallelCopyTileData(Scatter);
     }
     dataFilled = true;
+    filledVersion = origTensor->getDataVersion();
 }
 
 void TiledTensor::copyDataToTile(Tile* tile) {
-    // Don't copy if the tile already has data,  or if the tile is the original
-    // tensor (we have only one tile).
-    if (tile->hasData || tile->tensor == origTensor)
+    // Don't copy if the tile already has up-to-date data, or if the tile is
+    // the original tensor (we have only one tile).
+    if (filledInPlace || tile->tensor == origTensor ||
+        (tile->hasData && tile->dataVersion == origTensor->getDataVersion()))
         return;
 
     // Perform the data copy.
@@ -143,11 +217,24 @@ void TiledTensor::copyDataToTile(Tile* tile) {
         copyRawTensorData(tile->tensor, origTensor, 0, tile->origin[0],
                           tile->tensor->getShape().storageSize());
     } else {
-        std::vector<int> dstOrigin(tile->tensor->ndims(), 0);
-        copyTensorRegion(tile->tensor, origTensor, dstOrigin, tile->origin,
-                         tile->tensor->getShape().dims());
+        buildCopyPlans(tile);
+        tile->scatterPlan.execute(tile->tensor, origTensor);
     }
     tile->hasData = true;
+    tile->dataVersion = origTensor->getDataVersion();
+}
+
+void TiledTensor::buildCopyPlans(Tile* tile) {
+    if (tile->hasCopyPlans)
+        return;
+    const TensorShape& tileShape = tile->tensor->getShape();
+    const TensorShape& origShape = origTensor->getShape();
+    std::vector<int> tileOrigin(tile->tensor->ndims(), 0);
+    tile->scatterPlan = CopyPlan(tileShape, origShape, tileOrigin,
+                                 tile->origin, tileShape.dims());
+    tile->gatherPlan = CopyPlan(origShape, tileShape, tile->origin,
+                                tileOrigin, tileShape.dims());
+    tile->hasCopyPlans = true;
 }
 
 void TiledTensor::untile() {
@@ -164,10 +251,40 @@ void TiledTensor::untile() {
         for (auto index = startIndex(); !index.end(); ++index)
             gatherDataFromTile(&tiles[index]);
     } else {
+        // The original tensor may not have storage yet. Allocate it before
+        // the tiles are gathered into it from multiple threads.
+        origTensor->allocateStorage(origTensor->getDataType());
         parallelCopyTileData(Gather);
     }
 }
 
+bool TiledTensor::hasSameTiling(const TiledTensor& other) const {
+    if (origTensor != other.origTensor || useRawTensor != other.useRawTensor ||
+        !(shape == other.shape) || tiles.size() != other.tiles.size())
+        return false;
+    for (int i = 0; i < tiles.size(); i++) {
+        const Tile& tile = tiles[i];
+        const Tile& otherTile = other.tiles[i];
+        if (!tile.tensor || !otherTile.tensor ||
+            tile.hasOrigin != otherTile.hasOrigin ||
+            tile.origin != otherTile.origin)
+            return false;
+        const TensorShape& tileShape = tile.tensor->getShape();
+        const TensorShape& otherShape = otherTile.tensor->getShape();
+        if (!(tileShape == otherShape) ||
+            tileShape.getAlignment() != otherShape.getAlignment())
+            return false;
+    }
+    return true;
+}
+
+void TiledTensor::setDataFilled() {
+    for (auto& tile : tiles)
+        tile.hasData = true;
+    dataFilled = true;
+    filledInPlace = true;
+}
+
 void TiledTensor::gatherDataFromTile(Tile* tile) {
     // Perform the data copy.
     assert(tile->hasOrigin &&
@@ -177,12 +294,8 @@ void TiledTensor::gatherDataFromTile(Tile* tile) {
         copyRawTensorData(origTensor, tile->tensor, tile->origin[0], 0,
                           tile->tensor->getShape().storageSize());
     } else {
-        std::vector<int> srcOrigin(tile->tensor->ndims(), 0);
-        copyTensorRegion(origTensor,
-                         tile->tensor,
-                         tile->origin,
-                         srcOrigin,
-                         tile->tensor->getShape().dims());
+        buildCopyPlans(tile);
+        tile->gatherPlan.execute(origTensor, tile->tensor);
     }
 }
 
@@ -1,9 +1,11 @@
 #ifndef _CORE_TENSOR_H_
 #define _CORE_TENSOR_H_
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cmath>
+#include <cstring>
 #include <initializer_list>
 #include <iostream>
 #include <memory>
@@ -34,23 +36,37 @@ namespace smaug {
  */
 class TensorShape {
    public:
-    TensorShape() : layout(DataLayout::UnknownLayout) {}
+    TensorShape()
+            : layout(DataLayout::UnknownLayout), customStrides(false) {}
     TensorShape(std::vector<int> _dims, DataLayout _layout, int _alignment = 0)
             : dims_(_dims), padding_(dims_.size()), layout(_layout),
-              alignment(_alignment) {
+              alignment(_alignment), customStrides(false) {
         computePadding();
     }
     TensorShape(std::initializer_list<int> _dims,
                 DataLayout _layout,
                 int _alignment = 0)
             : dims_(_dims), padding_(dims_.size()), layout(_layout),
-              alignment(_alignment) {
+              alignment(_alignment), customStrides(false) {
         computePadding();
     }
+    /**
+     * Creates a shape whose elements are laid out with the given strides
+     * rather than contiguously, e.g. a transposed or sliced view of another
+     * Tensor's data. Such a shape has no alignment padding.
+     */
+    TensorShape(std::vector<int> _dims,
+                std::vector<int> _strides,
+                DataLayout _layout)
+            : dims_(_dims), padding_(dims_.size(), 0), strides_(_strides),
+              layout(_layout), alignment(0), customStrides(true) {
+        assert(strides_.size() == dims_.size());
+    }
     TensorShape(const TensorShape& shape)
             : dims_(shape.dims_), padding_(shape.padding_),
-              layout(shape.layout), alignment(shape.alignment) {}
-    TensorShape(const TensorShapeProto& shapeProto) {
+              strides_(shape.strides_), layout(shape.layout),
+              alignment(shape.alignment), customStrides(shape.customStrides) {}
+    TensorShape(const TensorShapeProto& shapeProto) : customStrides(false) {
         std::copy(shapeProto.dims().begin(),
                   shapeProto.dims().end(),
                   std::back_inserter(dims_));
@@ -63,23 +79,91 @@ class TensorShape {
     const std::vector<int>& dims() const { return dims_; }
     /** Returns a vector of padding along each dimension. */
     const std::vector<int>& padding() const { return padding_; }
+    /**
+     * Returns the distance, in elements, between consecutive indices of each
+     * dimension. Unless the shape has explicit strides, they are derived from
+     * the padded dimensions on every call, so they follow any change to the
+     * dimensions made through operator[].
+     */
+    std::vector<int> strides() const {
+        if (customStrides)
+            return strides_;
+        std::vector<int> strides(dims_.size());
+        for (int i = 0; i < ndims(); i++)
+            strides[i] = getStride(i);
+        return strides;
+    }
+    int getStride(int index) const {
+        index = getIndex(index);
+        if (customStrides)
+            return strides_[index];
+        int stride = 1;
+        for (int i = ndims() - 1; i > index; i--)
+            stride *= dims_[i] + padding_[i];
+        return stride;
+    }
+    /**
+     * Returns true if the elements are stored densely in row-major order, apart
+     * from the alignment padding of the last dimension.
+     */
+    bool isContiguous() const {
+        if (!customStrides)
+            return true;
+        int stride = 1;
+        for (int i = ndims() - 1; i >= 0; i--) {
+            if (strides_[i] != stride)
+                return false;
+            stride *= dims_[i] + padding_[i];
+        }
+        return true;
+    }
     int operator[](int index) const { return dims_[getIndex(index)]; }
+    /**
+     * Returns a mutable reference to a dimension. Explicit strides are kept
+     * as they are.
+     */
     int& operator[](int index) { return dims_[getIndex(index)]; }
     /** Returns the alignment-padded size of the specified dimension. */
     int getStorageDim(int index) const {
         return dims_[getIndex(index)] + padding_[getIndex(index)];
     }
+    /**
+     * Two shapes are equal if they have the same dimensions and layout, and,
+     * if either is strided, the same strides.
+     */
     bool operator==(const TensorShape& other) const {
-        return (dims_ == other.dims_ && layout == other.layout);
+        if (dims_ != other.dims_ || layout != other.layout)
+            return false;
+        if (isContiguous() && other.isContiguous())
+            return true;
+        return strides() == other.strides();
     }
     DataLayout getLayout() const { return layout; }
     int ndims() const { return dims_.size(); }
     int size() const { return product(dims_); }
-    int storageSize() const { return product(sum(dims_, padding_)); }
+    /**
+     * Returns the number of elements spanned by the data, including alignment
+     * padding. For contiguous shapes, this is the product of the padded
+     * dimensions.
+     */
+    int storageSize() const {
+        if (!customStrides)
+            return product(sum(dims_, padding_));
+        int size = 1;
+        for (int i = 0; i < ndims(); i++) {
+            if (dims_[i] == 0)
+                return 0;
+            size += (dims_[i] - 1) * strides_[i];
+        }
+        return size;
+    }
     int getAlignment() const { return alignment; }
     int getPadding(int index) const { return padding_[index]; }
 
-    /** Return a TensorShapeProto that serializes this TensorShape. */
+    /**
+     * Return a TensorShapeProto that serializes this TensorShape. The proto
+     * has no strides, so the shape must be contiguous.
+     */
     TensorShapeProto* asTensorShapeProto();
 
    protected:
@@ -94,16 +178,21 @@ class TensorShape {
         for (int i = 0; i < ndims - 1; i++)
             padding_[i] = 0;
     }
+
     std::vector<int> dims_;
     /** Padding along each dimension. Only the last element be nonzero. */
     std::vector<int> padding_;
+    /** The explicit strides of each dimension, in elements, if any. */
+    std::vector<int> strides_;
     DataLayout layout;
     int alignment;
+    /** True if the strides were given explicitly rather than computed. */
+    bool customStrides;
 };
 
 /**
  * An iterator over a multidimensional tensor's indices, accounting for data
- * alignment padding.
+ * alignment padding and strides.
  *
  * The iterator tracks the current location as a coordinate and outputs the
  * linearized index so that the data in a tensor can be accessed. While most
@@ -123,21 +212,34 @@ class TensorShape {
  *   data[iter(1,2,3,4)] = 1.2;
  *   data[iter(3,4,0,0)] = 3.4;
  *
- * The iterator skips over data alignment padding areas, if any exist.
+ * The iterator skips over data alignment padding areas, if any exist. The
+ * linear index is maintained incrementally with the strides of the shape, so
+ * advancing the iterator does not recompute it from the coordinate.
  */
 class TensorIndexIterator {
    public:
     TensorIndexIterator(const TensorShape& shape, bool _atEnd = false)
-            : dims(shape.dims()), padding(shape.padding()), atEnd(_atEnd),
-              advanceOne(std::vector<int>(dims.size(), 1)) {
+            : dims(shape.dims()), padding(shape.padding()),
+              strides(shape.strides()), atEnd(_atEnd), linearIndex(0),
+              advanceOne(std::vector<int>(dims.size(), 1)),
+              lowerBound(dims.size(), 0), upperBound(dims) {
         state.resize(dims.size(), 0);
     }
 
-    operator int() const { return getIndex(state); }
+    operator int() const { return linearIndex; }
 
     bool end() const { return atEnd; }
 
-    void operator++() { advanceRegion(advanceOne); }
+    void operator++() {
+        // Fast path: step along the innermost dimension.
+        int last = (int)state.size() - 1;
+        if (last >= 0 && state[last] + 1 < upperBound[last]) {
+            state[last]++;
+            linearIndex += strides[last];
+            return;
+        }
+        advanceRegion(advanceOne);
+    }
 
     void operator+=(const std::vector<int>& region) {
         assert(region.size() == state.size());
@@ -172,12 +274,10 @@ class TensorIndexIterator {
      */
     template <typename Container>
     int getIndex(Container indices) const {
-        int linearIndex = 0, stride = 1;
-        for (int i = (int)indices.size() - 1; i >= 0; i--) {
-            linearIndex += indices[i] * stride;
-            stride *= (dims.at(i) + padding.at(i));
-        }
-        return linearIndex;
+        int index = 0;
+        for (int i = 0; i < (int)indices.size(); i++)
+            index += indices[i] * strides[i];
+        return index;
     }
 
     /*
@@ -187,13 +287,14 @@ class TensorIndexIterator {
      * dimension, if the previous dimension overflowed and caused a carry-over
      * into the next dimension.
      */
-    virtual void advanceRegion(const std::vector<int>& region) {
+    void advanceRegion(const std::vector<int>& region) {
         bool carry = true;
         for (int i = (int)state.size() - 1; i >= 0 && carry; i--) {
             int currValue = state[i] + region[i];
-            carry = (currValue >= dims[i]);
+            carry = (currValue >= upperBound[i]);
             if (carry)
-                currValue = 0;
+                currValue = lowerBound[i];
+            linearIndex += (currValue - state[i]) * strides[i];
             state[i] = currValue;
         }
         if (carry)
@@ -206,10 +307,18 @@ class TensorIndexIterator {
     std::vector<int> dims;
     /** Alignment padding of the Tensor. */
     std::vector<int> padding;
+    /** Strides of the Tensor's dimensions. */
+    std::vector<int> strides;
     /** If true, we've reached the end of the Tensor. */
     bool atEnd;
+    /** The linear index of the current location. */
+    int linearIndex;
     /** A vector of all ones, used to implement operator++. */
     const std::vector<int> advanceOne;
+    /** The coordinate each dimension wraps around to. */
+    std::vector<int> lowerBound;
+    /** The coordinate past the last one visited in each dimension. */
+    std::vector<int> upperBound;
 };
 
 /**
@@ -233,29 +342,99 @@ class TensorRegionIndexIterator : public TensorIndexIterator {
     TensorRegionIndexIterator(const TensorShape& shape,
                               const std::vector<int>& _origin,
                               const std::vector<int>& _regionSize)
-            : TensorIndexIterator(shape, false), origin(_origin),
-              regionSize(_regionSize) {
-        state = origin;
+            : TensorIndexIterator(shape, false) {
+        state = _origin;
+        lowerBound = _origin;
+        for (int i = 0; i < (int)dims.size(); i++)
+            upperBound[i] = std::min(dims[i], _origin[i] + _regionSize[i]);
+        linearIndex = getIndex(state);
+    }
+};
+
+class Tensor;
+
+/**
+ * A precomputed plan for copying a rectangular region between two Tensors.
+ *
+ * The plan reduces the copy to a nest of loops over the region, in which the
+ * innermost dimensions that are contiguous in both Tensors are merged into a
+ * single run of memory. Executing the plan only adds precomputed strides to
+ * the data pointers and copies each run with memcpy, so it does no index
+ * arithmetic, virtual calls or allocation per run. A plan depends only on the
+ * shapes and the region, so it can be built once and reused for every copy
+ * between Tensors of the same shapes, as TiledTensor does for its tiles.
+ *
+ * Example: to copy the upper left 2x2 block of a 4x4 tensor A into the lower
+ * left 2x2 block of a 3x3 tensor B:
+ *
+ *    CopyPlan plan(B->getShape(), A->getShape(), {1,0}, {0,0}, {2,2});
+ *    plan.execute(B, A);
+ */
+class CopyPlan {
+   public:
+    CopyPlan() : runLength(0), destOffset(0), srcOffset(0) {}
+    CopyPlan(const TensorShape& destShape,
+             const TensorShape& srcShape,
+             const std::vector<int>& destOrigin,
+             const std::vector<int>& srcOrigin,
+             const std::vector<int>& regionSize);
+
+    /** Copies the region from src to dest. */
+    void execute(Tensor* dest, Tensor* src) const;
+
+    /** Copies the region between the given data arrays. */
+    template <typename DType>
+    void execute(DType* dest, const DType* src) const {
+        if (runLength == 0)
+            return;
+        executeLoop(0, dest + destOffset, src + srcOffset);
+    }
+
+    /** Returns the number of elements in each contiguous run. */
+    int getRunLength() const { return runLength; }
+    /** Returns the number of contiguous runs the region is copied in. */
+    int getNumRuns() const {
+        if (runLength == 0)
+            return 0;
+        int numRuns = 1;
+        for (const Loop& loop : loops)
+            numRuns *= loop.count;
+        return numRuns;
     }
 
    protected:
-    /** Advance the tensor region index with the specified region size. */
-    virtual void advanceRegion(const std::vector<int>& advanceRegionSize) {
-        bool carry = true;
-        for (int i = (int)state.size() - 1; i >= 0 && carry; i--) {
-            int currValue = state[i] + advanceRegionSize[i];
-            carry = (currValue >= dims[i] ||
-                     currValue >= origin[i] + regionSize[i]);
-            if (carry)
-                currValue = origin[i];
-            state[i] = currValue;
+    /** A loop over one dimension of the region that is not in the run. */
+    struct Loop {
+        int count;
+        int destStride;
+        int srcStride;
+    };
+
+    template <typename DType>
+    void executeLoop(int level, DType* dest, const DType* src) const {
+        if (level == (int)loops.size()) {
+            if (runLength == 1)
+                *dest = *src;
+            else
+                memcpy(dest, src, runLength * sizeof(DType));
+            return;
+        }
+        const Loop& loop = loops[level];
+        for (int i = 0; i < loop.count; i++) {
+            executeLoop(level + 1, dest, src);
+            dest += loop.destStride;
+            src += loop.srcStride;
         }
-        if (carry)
-            atEnd = true;
     }
 
-    std::vector<int> origin;
-    std::vector<int> regionSize;
+    /** The loops around the contiguous runs, outermost first. */
+    std::vector<Loop> loops;
+    /** The number of elements copied with each memcpy. */
+    int runLength;
+    /** The linear index of the start of the region in the destination. */
+    int destOffset;
+    /** The linear index of the start of the region in the source. */
+    int srcOffset;
 };
 
 /**
@@ -268,17 +447,20 @@ class TensorRegionIndexIterator : public TensorIndexIterator {
  */
 class TensorBase {
    public:
-    TensorBase() : name(""), dataFormat(UnknownStorageFormat), dead(false) {}
+    TensorBase()
+            : name(""), dataFormat(UnknownStorageFormat), dead(false),
+              dataVersion(0) {}
     virtual ~TensorBase() {}
 
     TensorBase(const std::string& _name, const TensorShape& _shape)
             : name(_name), shape(_shape), dataFormat(Uncompressed),
-              dataType(UnknownDataType), dead(false) {}
+              dataType(UnknownDataType), dead(false), dataVersion(0) {}
 
     TensorBase(const TensorProto& tensorProto)
             : name(tensorProto.name()), shape(tensorProto.shape()),
               dataFormat(tensorProto.data_format()),
-              dataType(tensorProto.data_type()), dead(false) {}
+              dataType(tensorProto.data_type()), dead(false),
+              dataVersion(0) {}
 
     // TODO: Do we need a copy constructor?
 
@@ -289,6 +471,11 @@ class TensorBase {
     int getTotalDim(int index) const { return shape.getStorageDim(index); }
     int getDataStorageFormat() const { return dataFormat; }
     DataType getDataType() const { return dataType; }
+    /**
+     * Sets the data type of a Tensor whose storage has not been allocated
+     * yet. Allocating storage of a different type overrides this.
+     */
+    void setDataType(DataType _dataType) { dataType = _dataType; }
     int getDataTypeSize() const {
         switch (dataType) {
             case Float16:
@@ -310,6 +497,13 @@ class TensorBase {
     }
     bool isDead() const { return dead; }
     void setDead(bool _dead = true) { dead = _dead; }
+    /**
+     * Returns a counter of the times the data of the Tensor was replaced, so
+     * that copies of the data (e.g. tiles) can tell whether they are stale.
+     */
+    int getDataVersion() const { return dataVersion; }
+    /** Marks the data as replaced, which invalidates all copies of it. */
+    void markDataChanged() { dataVersion++; }
     virtual bool containsData() const = 0;
 
    protected:
@@ -329,6 +523,8 @@ class TensorBase {
      * marked dead (except for MergeOp).
      */
     bool dead;
+    /** The number of times the data was replaced. */
+    int dataVersion;
 };
 
 /**
@@ -343,11 +539,14 @@ class TensorBase {
  */
 class Tensor : public TensorBase {
    public:
-    Tensor() : TensorBase(), tensorData(NULL) {}
+    Tensor()
+            : TensorBase(), tensorData(NULL), viewBase(nullptr), viewOffset(0) {
+    }
 
     /** Construct a Tensor with the given name and shape. */
     Tensor(const std::string& _name, const TensorShape& _shape)
-            : TensorBase(_name, _shape), tensorData(NULL) {}
+            : TensorBase(_name, _shape), tensorData(NULL), viewBase(nullptr),
+              viewOffset(0) {}
     virtual ~Tensor() {}
 
     /**
@@ -357,7 +556,8 @@ class Tensor : public TensorBase {
      * @param tensorData The data contents of the Tensor.
      */
     Tensor(const TensorProto& tensorProto, const TensorData& tensorData)
-            : TensorBase(tensorProto), tensorData(NULL) {
+            : TensorBase(tensorProto), tensorData(NULL), viewBase(nullptr),
+              viewOffset(0) {
         DataType dataType = tensorProto.data_type();
         switch (dataType) {
             case Float16:
@@ -383,12 +583,25 @@ class Tensor : public TensorBase {
         }
     }
 
+    /**
+     * Constructs a Tensor from a serialized TensorProto whose data lives in
+     * existing storage, without copying it.
+     *
+     * @param tensorProto Basic parameters of the Tensor.
+     * @param storage The data of the Tensor, laid out as in storageSize().
+     */
+    Tensor(const TensorProto& tensorProto, std::shared_ptr<void> storage)
+            : TensorBase(tensorProto), tensorData(storage), viewBase(nullptr),
+              viewOffset(0) {}
+
     /** Returns an iterator starting at the beginning of the Tensor. */
     TensorIndexIterator startIndex() const {
         return TensorIndexIterator(shape);
     }
 
-    virtual bool containsData() const { return tensorData != nullptr; }
+    virtual bool containsData() const {
+        return viewBase ? viewBase->containsData() : tensorData != nullptr;
+    }
 
     /**
      * Fills the Tensor with externalData.
@@ -471,6 +684,10 @@ class Tensor : public TensorBase {
      */
     template <typename T>
     T* allocateStorage() {
+        if (viewBase) {
+            dataType = ToDataType<T>::dataType;
+            return viewBase->allocateStorage<T>() + viewOffset;
+        }
         if (tensorData == NULL) {
             dataType = ToDataType<T>::dataType;
             int size = shape.storageSize();
@@ -511,6 +728,60 @@ class Tensor : public TensorBase {
         }
     }
 
+    /**
+     * Points the Tensor at storage owned elsewhere, e.g. a region of a shared
+     * memory arena. The storage must be large enough to hold the Tensor's
+     * shape with its current data type.
+     */
+    void setStorage(std::shared_ptr<void> storage) {
+        assert(!viewBase && "Views cannot have storage of their own!");
+        tensorData = storage;
+    }
+
+    /**
+     * Makes this Tensor a view of another Tensor. Instead of having storage of
+     * its own, a view aliases the storage of its base Tensor, starting at the
+     * given element offset, so writes to either are visible through both. The
+     * aliased region must be contiguous in the base and laid out exactly like
+     * this Tensor's shape.
+     *
+     * The base need not have storage yet: it is allocated lazily as usual, on
+     * the first write to either Tensor. A view may itself be the base of other
+     * views. Calling this again on a view points it at a new base.
+     */
+    void setView(Tensor* base, int offset = 0) {
+        assert(!tensorData && "Tensors with storage cannot become views!");
+        assert(base != this);
+        assert(offset + shape.storageSize() <= base->getShape().storageSize() &&
+               "The view does not fit in its base Tensor!");
+        viewBase = base;
+        viewOffset = offset;
+        if (dataType == UnknownDataType)
+            dataType = base->getDataType();
+    }
+
+    /** Returns true if this Tensor is a view of another Tensor. */
+    bool isView() const { return viewBase != nullptr; }
+    /** Returns the Tensor whose storage this view aliases, or nullptr. */
+    Tensor* getViewBase() const { return viewBase; }
+    /** Returns the element offset of this view in its base Tensor. */
+    int getViewOffset() const { return viewOffset; }
+
+    /**
+     * Returns true if this Tensor is a view, directly or through other views,
+     * of the region of base that starts at the given element offset.
+     */
+    bool isViewOf(const Tensor* base, int offset = 0) const {
+        int totalOffset = 0;
+        for (const Tensor* tensor = this; tensor->viewBase;
+             tensor = tensor->viewBase) {
+            totalOffset += tensor->viewOffset;
+            if (tensor->viewBase == base)
+                return totalOffset == offset;
+        }
+        return false;
+    }
+
     /** Serializes this Tensor to a TensorProto. */
     TensorProto* asTensorProto();
 
@@ -520,15 +791,31 @@ class Tensor : public TensorBase {
     template <typename T>
     const T* data() const {
         assert(ToDataType<T>::dataType == dataType);
+        if (viewBase) {
+            const Tensor* base = viewBase;
+            return base->data<T>() + viewOffset;
+        }
         return reinterpret_cast<T*>(tensorData.get());
     }
 
     /**
      * Returns a non-const pointer to the Tensor data.
+     *
+     * If the Tensor has no storage yet, it is allocated here, on the first
+     * write. This lets the outputs of dead operators and untaken control flow
+     * branches go without any memory. The first call must not race with
+     * another call on the same Tensor, or on a view of it; the Scheduler
+     * allocates the bases of views before running Operators concurrently.
      */
     template <typename T>
     T* data() {
         assert(ToDataType<T>::dataType == dataType);
+        if (viewBase)
+            return viewBase->data<T>() + viewOffset;
+        if (tensorData == NULL) {
+            assert(!dead && "Dead tensors should never be written!");
+            return allocateStorage<T>();
+        }
         return reinterpret_cast<T*>(tensorData.get());
     }
 
@@ -538,7 +825,21 @@ class Tensor : public TensorBase {
     friend std::ostream& operator<<(std::ostream& os, const Tensor& tensor);
 
    protected:
+    /** Returns a pointer to the data, which may be null, resolving views. */
+    const void* rawData() const {
+        if (viewBase) {
+            const char* base = static_cast<const char*>(viewBase->rawData());
+            return base ? base + viewOffset * viewBase->getDataTypeSize()
+                        : nullptr;
+        }
+        return tensorData.get();
+    }
+
     std::shared_ptr<void> tensorData;
+    /** The Tensor whose storage this Tensor aliases, if it is a view. */
+    Tensor* viewBase;
+    /** The element offset of a view in the storage of its base. */
+    int viewOffset;
 };
 
 /**
@@ -553,7 +854,7 @@ class TiledTensor : public TensorBase {
   public:
    TiledTensor(Tensor* _origTensor = nullptr, bool _useRawTensor = false)
            : TensorBase(), origTensor(_origTensor), useRawTensor(_useRawTensor),
-             dataFilled(false) {}
+             dataFilled(false), filledVersion(0), filledInPlace(false) {}
    /**
     * Construct a TiledTensor.
     *
@@ -568,7 +869,8 @@ class TiledTensor : public TensorBase {
                Tensor* _origTensor = nullptr,
                bool _useRawTensor = false)
            : TensorBase("", shape), origTensor(_origTensor),
-             useRawTensor(_useRawTensor), dataFilled(false) {
+             useRawTensor(_useRawTensor), dataFilled(false), filledVersion(0),
+             filledInPlace(false) {
        tiles.resize(shape.size());
    }
 
@@ -612,7 +914,11 @@ class TiledTensor : public TensorBase {
                 Tensor* tensor,
                 bool copyData);
 
-   /** Copies data (if needed) to all the tiles from the original Tensor. */
+   /**
+    * Copies data (if needed) to all the tiles from the original Tensor. The
+    * tiles are only copied again once the data version of the original Tensor
+    * changes.
+    */
    void copyDataToAllTiles();
 
    /**
@@ -621,7 +927,18 @@ class TiledTensor : public TensorBase {
     */
    void untile();
 
-   static void* tileCopyWorker(void* _args);
+   /**
+    * Returns true if both TiledTensors tile the same original Tensor into
+    * tiles of the same shapes at the same positions.
+    */
+   bool hasSameTiling(const TiledTensor& other) const;
+
+   /**
+    * Marks all the tiles as filled, so that data is never copied into them
+    * from the original Tensor. This is for tiles that are written directly by
+    * the Operator that produces the original Tensor.
+    */
+   void setDataFilled();
 
   protected:
    /**
@@ -636,13 +953,23 @@ class TiledTensor : public TensorBase {
        bool hasOrigin;
        /** True if we have copied data to this tile. */
        bool hasData;
+       /** The data version of the original Tensor that was copied. */
+       int dataVersion;
+       /** True if the copy plans below have been built. */
+       bool hasCopyPlans;
+       /** The plan for copying this tile's data from the original Tensor. */
+       CopyPlan scatterPlan;
+       /** The plan for copying this tile's data to the original Tensor. */
+       CopyPlan gatherPlan;
 
        /**
         * Construct a new blank Tile.
         *
         * Set the properties of this Tile using TiledTensor::setTile
         */
-       Tile() : tensor(nullptr), origin(), hasOrigin(false), hasData(false) {}
+       Tile()
+               : tensor(nullptr), origin(), hasOrigin(false), hasData(false),
+                 dataVersion(0), hasCopyPlans(false) {}
    };
 
    /**
@@ -655,20 +982,6 @@ class TiledTensor : public TensorBase {
      Gather
    };
 
-   struct CopyTilesArgs {
-       TiledTensor* tiledTensor;
-       int start;
-       int numTiles;
-       TileDataOperation op;
-
-       CopyTilesArgs(TiledTensor* _tiledTensor,
-                     int _start,
-                     int _numTiles,
-                     TileDataOperation _op)
-               : tiledTensor(_tiledTensor), start(_start), numTiles(_numTiles),
-                 op(_op) {}
-   };
-
    Tile* getTile(int index) { return &tiles[index]; }
 
    /** Copy data (if needed) to this tile from the original Tensor. */
@@ -677,6 +990,13 @@ class TiledTensor : public TensorBase {
    /** Copy data from this tile to the original Tensor. */
    void gatherDataFromTile(Tile* tile);
 
+   /**
+    * Builds the plans for copying data between this tile and the original
+    * Tensor, if they have not been built yet. The shapes of both are fixed
+    * once the tile is set, so the plans are reused by every copy.
+    */
+   void buildCopyPlans(Tile* tile);
+
    /** Split the work (data filling or gathering) across multiple threads. */
    void parallelCopyTileData(TileDataOperation op);
 
@@ -689,6 +1009,12 @@ class TiledTensor : public TensorBase {
    /** True if all the tiles have data filled. */
    bool dataFilled;
 
+   /** The data version of the original Tensor when the tiles were filled. */
+   int filledVersion;
+
+   /** True if the tiles are written directly by the producer of the data. */
+   bool filledInPlace;
+
    /** The list of Tiles, indexed using a TensorIndexIterator. */
    std::vector<Tile> tiles;
 };
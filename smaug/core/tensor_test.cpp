@@ -52,3 +52,108 @@ TEST_CASE_METHOD(SmaugTest, "Unpacking of float16 tensor data", "[fp16]") {
     }
 }
 
+
+static std::vector<int> collectIndices(TensorIndexIterator iter) {
+    std::vector<int> indices;
+    for (; !iter.end(); ++iter)
+        indices.push_back(iter);
+    return indices;
+}
+
+TEST_CASE_METHOD(SmaugTest, "Strided tensor indexing", "[tensor]") {
+    SECTION("Padded shapes have row-major strides") {
+        TensorShape shape({ 2, 2, 3 }, DataLayout::NHWC, 4);
+        REQUIRE(shape.strides() == std::vector<int>{ 8, 4, 1 });
+        REQUIRE(shape.isContiguous());
+        REQUIRE(shape.storageSize() == 16);
+        REQUIRE(collectIndices(TensorIndexIterator(shape)) ==
+                std::vector<int>{ 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14 });
+        TensorIndexIterator iter(shape);
+        REQUIRE(iter(1, 0, 2) == 10);
+    }
+
+    SECTION("Region iterators follow the strides") {
+        TensorShape shape({ 3, 5 }, DataLayout::NC, 8);
+        TensorRegionIndexIterator iter(shape, { 1, 2 }, { 2, 3 });
+        REQUIRE(collectIndices(iter) ==
+                std::vector<int>{ 10, 11, 12, 18, 19, 20 });
+    }
+
+    SECTION("Explicit strides describe a transposed view") {
+        // A 3x2 view of the transpose of a 2x3 row-major matrix.
+        TensorShape shape({ 3, 2 }, { 1, 3 }, DataLayout::NC);
+        REQUIRE(!shape.isContiguous());
+        REQUIRE(shape.storageSize() == 6);
+        REQUIRE(collectIndices(TensorIndexIterator(shape)) ==
+                std::vector<int>{ 0, 3, 1, 4, 2, 5 });
+        Tensor* tensor = new Tensor("transposed", shape);
+        workspace()->addTensor(tensor);
+        float* data = tensor->allocateStorage<float>();
+        for (int i = 0; i < 6; i++)
+            data[i] = i;
+        verifyOutputs<float>(tensor, { 0, 3, 1, 4, 2, 5 });
+    }
+
+    SECTION("Strides follow changes to the dimensions") {
+        TensorShape shape({ 2, 3, 4 }, DataLayout::NHWC);
+        shape[1] = 5;
+        REQUIRE(shape.strides() == std::vector<int>{ 20, 4, 1 });
+        REQUIRE(shape.getStride(0) == 20);
+    }
+
+    SECTION("Shapes with different strides are not equal") {
+        TensorShape dense({ 3, 2 }, DataLayout::NC);
+        TensorShape transposed({ 3, 2 }, { 1, 3 }, DataLayout::NC);
+        REQUIRE(dense == TensorShape({ 3, 2 }, { 2, 1 }, DataLayout::NC));
+        REQUIRE(!(dense == transposed));
+        REQUIRE(transposed == TensorShape(transposed));
+    }
+}
+
+TEST_CASE_METHOD(SmaugTest, "Copy plans", "[tensor]") {
+    SECTION("Whole padded tensors are copied in one run") {
+        TensorShape shape({ 2, 3, 5 }, DataLayout::NHWC, 8);
+        CopyPlan plan(shape, shape, { 0, 0, 0 }, { 0, 0, 0 }, { 2, 3, 5 });
+        REQUIRE(plan.getNumRuns() == 1);
+        REQUIRE(plan.getRunLength() == 48);
+    }
+
+    SECTION("Regions are copied one row at a time") {
+        TensorShape srcShape({ 4, 4 }, DataLayout::NC);
+        TensorShape destShape({ 3, 3 }, DataLayout::NC);
+        CopyPlan plan(destShape, srcShape, { 1, 0 }, { 0, 1 }, { 2, 2 });
+        REQUIRE(plan.getNumRuns() == 2);
+        REQUIRE(plan.getRunLength() == 2);
+        std::vector<float> src(16), dest(9, 0);
+        for (int i = 0; i < 16; i++)
+            src[i] = i;
+        plan.execute(dest.data(), src.data());
+        REQUIRE(dest == std::vector<float>{ 0, 0, 0, 1, 2, 0, 5, 6, 0 });
+    }
+
+    SECTION("Regions are clipped to both tensors") {
+        TensorShape srcShape({ 2, 6 }, DataLayout::NC);
+        TensorShape destShape({ 2, 4 }, DataLayout::NC);
+        CopyPlan plan(destShape, srcShape, { 0, 2 }, { 0, 0 }, { 2, 6 });
+        REQUIRE(plan.getNumRuns() == 2);
+        REQUIRE(plan.getRunLength() == 2);
+    }
+
+    SECTION("Strided tensors are copied element by element") {
+        // Copies the transpose of a 2x3 matrix into a 3x2 tensor.
+        TensorShape srcShape({ 3, 2 }, { 1, 3 }, DataLayout::NC);
+        TensorShape destShape({ 3, 2 }, DataLayout::NC);
+        Tensor* src = new Tensor("src", srcShape);
+        Tensor* dest = new Tensor("dest", destShape);
+        workspace()->addTensor(src);
+        workspace()->addTensor(dest);
+        float* srcData = src->allocateStorage<float>();
+        for (int i = 0; i < 6; i++)
+            srcData[i] = i;
+        dest->allocateStorage<float>();
+        CopyPlan plan(destShape, srcShape, { 0, 0 }, { 0, 0 }, { 3, 2 });
+        REQUIRE(plan.getNumRuns() == 6);
+        plan.execute(dest, src);
+        verifyOutputs<float>(dest, { 0, 3, 1, 4, 2, 5 });
+    }
+}
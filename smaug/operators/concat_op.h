@@ -1,6 +1,8 @@
 #ifndef _OPERATORS_CONCAT_OP_H_
 #define _OPERATORS_CONCAT_OP_H_
 
+#include <set>
+
 #include "smaug/core/backend.h"
 #include "smaug/core/operator.h"
 #include "smaug/core/tensor_utils.h"
@@ -63,16 +65,59 @@ class ConcatOp : public Operator {
         outputs.at(0) = output;
     }
 
-    void createAllTensors() override{
+    void createAllTensors() override {
         createOutputTensor();
+        createTensorViews();
+    }
+
+    /**
+     * If every input fills a contiguous region of the output, the inputs that
+     * have no storage yet are made views of the output, so that their
+     * producers write directly into it. An input that is a view of the whole
+     * of another tensor (e.g. the output of a reshape) redirects that tensor
+     * instead.
+     */
+    void createTensorViews() override {
+        Tensor* output = getOutput(0);
+        const TensorShape& outputShape = output->getShape();
+        if (!isConcatContiguous(outputShape))
+            return;
+        int lastDim = outputShape.ndims() - 1;
+        int offset = 0;
+        std::set<Tensor*> redirected;
+        for (int i = 0; i < getInputs().size(); i++) {
+            Tensor* input = getInput(i);
+            const TensorShape& inputShape = input->getShape();
+            Tensor* storageOwner = input;
+            while (storageOwner->isView() &&
+                   storageOwner->getViewOffset() == 0)
+                storageOwner = storageOwner->getViewBase();
+            if (!storageOwner->isView() && !storageOwner->containsData() &&
+                storageOwner != output &&
+                storageOwner->getShape().storageSize() ==
+                        inputShape.storageSize() &&
+                inputShape.getPadding(lastDim) ==
+                        outputShape.getPadding(lastDim) &&
+                redirected.insert(storageOwner).second) {
+                storageOwner->setView(output, offset);
+            }
+            offset += inputShape.storageSize();
+        }
     }
 
     void run() override {
         Tensor* output = getOutput(0);
         int ndims = output->ndims();
         std::vector<int> dstOrigin(ndims, 0);
+        int offset = 0;
         for (int i = 0; i < getInputs().size(); i++) {
             Tensor* input = getInput(i);
+            int inputOffset = offset;
+            offset += input->getShape().storageSize();
+            if (input->isViewOf(output, inputOffset)) {
+                dstOrigin[concatAxis] += input->dim(concatAxis);
+                continue;
+            }
             copyTensorRegion(output,
                              input,
                              dstOrigin,
@@ -85,6 +130,21 @@ class ConcatOp : public Operator {
     int getConcatAxis() const { return concatAxis; }
 
    protected:
+    /**
+     * Returns true if the inputs are contiguous regions of an output of the
+     * given shape: all the dimensions outside of the concatenation axis must
+     * be 1, and the axis must not be the innermost, padded dimension.
+     */
+    bool isConcatContiguous(const TensorShape& shape) const {
+        if (concatAxis >= shape.ndims() - 1)
+            return false;
+        for (int i = 0; i < concatAxis; i++) {
+            if (shape[i] != 1)
+                return false;
+        }
+        return true;
+    }
+
     int concatAxis;
 };
 
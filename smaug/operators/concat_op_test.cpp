@@ -106,3 +106,81 @@ TEST_CASE_METHOD(SmaugTest, "Concatenate 2 tensors", "[refop]") {
         verifyOutputs(outputsTensor, expectedValues);
     }
 }
+
+TEST_CASE_METHOD(SmaugTest,
+                 "Concatenate into a preplanned destination",
+                 "[refop]") {
+    auto concatOp = new ConcatOp<ReferenceBackend>("concat", workspace(), 3);
+    TensorShape inputShape({ 1, 2, 4 }, DataLayout::NTC);
+    std::vector<Tensor*> inputs;
+    for (int i = 0; i < 3; i++) {
+        Tensor* input = new Tensor("input" + std::to_string(i), inputShape);
+        workspace()->addTensor(input);
+        concatOp->setInput(input, i);
+        inputs.push_back(input);
+    }
+    SECTION("Inputs without storage are written into the output") {
+        concatOp->setConcatAxis(1);
+        concatOp->createAllTensors();
+        Tensor* output = concatOp->getOutput(0);
+        for (int i = 0; i < 3; i++) {
+            // Write the inputs the way their producers would.
+            REQUIRE(inputs[i]->getViewBase() == output);
+            float* data = inputs[i]->allocateStorage<float>();
+            REQUIRE(data == output->data<float>() + i * 8);
+            for (int j = 0; j < 8; j++)
+                data[j] = i * 10 + j;
+        }
+        concatOp->run();
+        REQUIRE(output->getShape().dims() == std::vector<int>{ 1, 6, 4 });
+        verifyOutputs<float>(output, { 0,  1,  2,  3,  4,  5,  6,  7,
+                                       10, 11, 12, 13, 14, 15, 16, 17,
+                                       20, 21, 22, 23, 24, 25, 26, 27 });
+    }
+    SECTION("Inputs with storage are copied") {
+        inputs[1]->allocateStorage<float>();
+        inputs[1]->fillData<float>({ 1, 2, 3, 4, 5, 6, 7, 8 });
+        concatOp->setConcatAxis(1);
+        concatOp->createAllTensors();
+        Tensor* output = concatOp->getOutput(0);
+        REQUIRE(inputs[0]->getViewBase() == output);
+        REQUIRE(!inputs[1]->isView());
+        REQUIRE(inputs[2]->getViewBase() == output);
+        inputs[0]->allocateStorage<float>();
+        inputs[0]->fillData<float>({ 0, 0, 0, 0, 0, 0, 0, 0 });
+        inputs[2]->allocateStorage<float>();
+        inputs[2]->fillData<float>({ 9, 9, 9, 9, 9, 9, 9, 9 });
+        concatOp->run();
+        verifyOutputs<float>(output, { 0, 0, 0, 0, 0, 0, 0, 0,
+                                       1, 2, 3, 4, 5, 6, 7, 8,
+                                       9, 9, 9, 9, 9, 9, 9, 9 });
+    }
+    SECTION("Views of whole tensors redirect the tensors they alias") {
+        // Make input1 a reshaped view of a tensor that has no storage yet.
+        Tensor* source = new Tensor(
+                "source", TensorShape({ 2, 4 }, DataLayout::NC));
+        workspace()->addTensor(source);
+        inputs[1]->setView(source);
+        concatOp->setConcatAxis(1);
+        concatOp->createAllTensors();
+        Tensor* output = concatOp->getOutput(0);
+        REQUIRE(source->getViewBase() == output);
+        REQUIRE(inputs[1]->isViewOf(output, 8));
+        for (int i = 0; i < 3; i++) {
+            Tensor* producerOutput = i == 1 ? source : inputs[i];
+            float* data = producerOutput->allocateStorage<float>();
+            for (int j = 0; j < 8; j++)
+                data[j] = i * 10 + j;
+        }
+        concatOp->run();
+        verifyOutputs<float>(output, { 0,  1,  2,  3,  4,  5,  6,  7,
+                                       10, 11, 12, 13, 14, 15, 16, 17,
+                                       20, 21, 22, 23, 24, 25, 26, 27 });
+    }
+    SECTION("Inner dimensions are not concatenated in place") {
+        concatOp->setConcatAxis(2);
+        concatOp->createAllTensors();
+        for (int i = 0; i < 3; i++)
+            REQUIRE(!inputs[i]->isView());
+    }
+}
@@ -85,7 +85,9 @@ class SwitchOp : public Operator {
  * \brief Forwards the first live input to its output.
  *
  * The merge operator takes multiple tensors, all but one of which should be
- * dead, and copies the one live Tensor to its output.
+ * dead, and forwards the one live Tensor to its output. The output is a view
+ * of the live input unless it already has storage (e.g. from the
+ * MemoryPlanner), in which case the input is copied.
  */
 template <typename Backend>
 class MergeOp : public Operator {
@@ -118,8 +120,14 @@ class MergeOp : public Operator {
         for (int i = 0; i < getInputs().size(); i++) {
             Tensor* input = getInput(i);
             if (!input->isDead()) {
-                copyRawTensorData(
-                        output, input, 0, 0, input->getShape().storageSize());
+                // Unless the output already has storage of its own, forward
+                // the live input as a view instead of copying it.
+                if (output->isView() || !output->containsData()) {
+                    output->setView(input);
+                } else {
+                    copyRawTensorData(output, input, 0, 0,
+                                      input->getShape().storageSize());
+                }
                 forwarded = true;
                 break;
             }
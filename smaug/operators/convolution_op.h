@@ -27,7 +27,8 @@ class ConvolutionOp : public FusedActivationOp {
             : FusedActivationOp(name, OpType::Convolution3d, workspace),
               weightRows(0), weightCols(0), numOfmaps(0), rowStride(0),
               colStride(0), paddingType(UnknownPadding),
-              weightsName(name + "/kernels"), sampling({ NoSampling, 1 }) {
+              weightsName(name + "/kernels"), bias(nullptr),
+              sampling({ NoSampling, 1 }) {
         inputs.resize(kNumInputs, nullptr);
         outputs.resize(kNumOutputs, nullptr);
     }
@@ -123,13 +124,24 @@ class ConvolutionOp : public FusedActivationOp {
     void run() override {}
 
     int getNumParameters() const override {
-        return inputs.at(Kernels)->getShape().size();
+        int numParameters = inputs.at(Kernels)->getShape().size();
+        if (bias)
+            numParameters += bias->getShape().size();
+        return numParameters;
     }
 
     std::vector<TensorBase*> getParameterizableInputs() override {
         return { inputs[Kernels] };
     }
 
+    /**
+     * Set a per output feature map bias, which is added to the results before
+     * the activation function. The bias is a 1xK tensor, where K is the
+     * number of output feature maps. Convolutions have no bias by default.
+     */
+    void setBias(Tensor* _bias) { bias = _bias; }
+    Tensor* getBias() const { return bias; }
+
     int getRowStride() const { return rowStride; }
     int getColStride() const { return colStride; }
     int getWeightRows() const { return weightRows; }
@@ -183,6 +195,8 @@ class ConvolutionOp : public FusedActivationOp {
     int colStride;
     PaddingType paddingType;
     std::string weightsName;
+    /** The optional bias. It is not an input of the operator in the graph. */
+    Tensor* bias;
     SamplingInfo sampling;
 };
 
@@ -23,7 +23,7 @@ class InnerProductOp : public FusedActivationOp {
             : FusedActivationOp(name, OpType::InnerProduct, workspace),
               numOutputs(0), weightsTensorsCreated(false),
               outputTensorsCreated(false), weightsName(name + "/weights"),
-              sampling({ NoSampling, 1 }) {
+              bias(nullptr), sampling({ NoSampling, 1 }) {
         inputs.resize(kNumInputs, nullptr);
         outputs.resize(kNumOutputs, nullptr);
     }
@@ -80,8 +80,19 @@ class InnerProductOp : public FusedActivationOp {
 
     int getNumOutputs() const { return numOutputs; }
 
+    /**
+     * Set a per neuron bias, which is added to the results before the
+     * activation function. The bias is a 1xK tensor, where K is the number of
+     * output neurons. Inner products have no bias by default.
+     */
+    void setBias(Tensor* _bias) { bias = _bias; }
+    Tensor* getBias() const { return bias; }
+
     int getNumParameters() const override {
-        return inputs.at(Weights)->getShape().size();
+        int numParameters = inputs.at(Weights)->getShape().size();
+        if (bias)
+            numParameters += bias->getShape().size();
+        return numParameters;
     }
 
     std::vector<TensorBase*> getParameterizableInputs() override {
@@ -102,6 +113,8 @@ class InnerProductOp : public FusedActivationOp {
     bool weightsTensorsCreated;
     bool outputTensorsCreated;
     std::string weightsName;
+    /** The optional bias. It is not an input of the operator in the graph. */
+    Tensor* bias;
     SamplingInfo sampling;
 };
 
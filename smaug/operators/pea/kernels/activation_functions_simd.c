@@ -47,11 +47,8 @@ void smv_softmax_nc_vec_fxp(float16* host_inputs,
     for (int i = 0; i < input_num; i++) {
         // Exponentiate.
         softmax_exp:
-        for (int j = 0; j < input_vec_size; j++) {
-            softmax_exp_vec:
-            for (int k = 0; k < VECTOR_SIZE; k++)
-                _results[i][j][k] = exp(_inputs[i][j][k]);
-        }
+        for (int j = 0; j < input_vec_size; j++)
+            _results[i][j] = exp_vec_unit(_inputs[i][j]);
 
         // Compute the normalization factor.
         float normaliz = 0.0;
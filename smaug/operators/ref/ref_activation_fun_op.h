@@ -86,17 +86,11 @@ static inline void sigmoid(float* inputs, float* results, int input_size) {
 
 ALWAYS_INLINE
 static inline void tanh_act(float* inputs, float* results, int input_size) {
-    int i;
-    tanh_act_loop1:
-    for (i = 0; i < input_size; i++) {
-        results[i] = 2 * inputs[i];
-    }
-
-    sigmoid(results, results, input_size);
-
-    tanh_act_loop2:
-    for (i = 0; i < input_size; i++) {
-        results[i] = 2 * results[i] - 1;
+    // Computing this as 2 * sigmoid(2x) - 1 loses most of the precision near
+    // zero to cancellation.
+    tanh_act_loop:
+    for (int i = 0; i < input_size; i++) {
+        results[i] = tanh(inputs[i]);
     }
 }
 
@@ -1,8 +1,14 @@
+#include <algorithm>
+#include <vector>
+
 #include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
 #include "smaug/operators/common.h"
 #include "smaug/operators/convolution_op.h"
 #include "smaug/operators/ref/ref_activation_fun_op.h"
+#include "smaug/operators/ref/ref_convolution_op.h"
 #include "smaug/utility/debug_stream.h"
+#include "smaug/utility/thread_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,11 +17,13 @@ extern "C" {
 /** \ingroup AladdinKernels
  *
  * A Reference implementation of a 3D convolution on NCHW data with valid
- * padding.
+ * padding. If bias is not NULL, it holds one value per kernel that is added to
+ * the results.
  */
 void ref_conv3d_nchw_valid_padding(float* input,
                                    float* kernels,
                                    float* result,
+                                   float* bias,
                                    int img_num,
                                    int img_chans,
                                    int img_rows,
@@ -37,6 +45,8 @@ void ref_conv3d_nchw_valid_padding(float* input,
     int result_size = img_num * k_num * res_rows * (res_cols + res_pad);
     dmaLoad(input, input, input_size * sizeof(float));
     dmaLoad(kernels, kernels, kernel_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, k_num * sizeof(float));
 
     // Convolution borders.
     const int start_i = 0;
@@ -58,7 +68,7 @@ void ref_conv3d_nchw_valid_padding(float* input,
                 int out_j = 0;
                 conv3d_input_cols:
                 for (int j = start_j; j < end_j; j += k_col_stride) {
-                    float partial_sum = 0;
+                    float partial_sum = bias ? bias[kern] : 0;
                     conv3d_kernel_height:
                     // Convolution loop over the kernel.
                     for (int d = 0; d < img_chans; d++) {
@@ -94,6 +104,7 @@ void ref_conv3d_nchw_valid_padding(float* input,
 void ref_conv3d_nchw_same_padding(float* input,
                                   float* kernels,
                                   float* result,
+                                  float* bias,
                                   int img_num,
                                   int img_chans,
                                   int img_rows,
@@ -115,6 +126,8 @@ void ref_conv3d_nchw_same_padding(float* input,
     int result_size = img_num * k_num * res_rows * (res_cols + res_pad);
     dmaLoad(input, input, input_size * sizeof(float));
     dmaLoad(kernels, kernels, kernel_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, k_num * sizeof(float));
 
     const int total_row_pad = k_rows - 1;
     const int total_col_pad = k_cols - 1;
@@ -143,7 +156,7 @@ void ref_conv3d_nchw_same_padding(float* input,
                 int out_j = 0;
                 conv3d_input_cols:
                 for (int j = start_j; j < end_j; j += k_col_stride) {
-                    float partial_sum = 0;
+                    float partial_sum = bias ? bias[kern] : 0;
 
                     conv3d_kernel_height:
                     // Convolution loop over the kernel.
@@ -188,6 +201,7 @@ void ref_conv3d_nchw_same_padding(float* input,
 void ref_conv3d_nhwc_valid_padding(float* input,
                                    float* kernels,
                                    float* result,
+                                   float* bias,
                                    int img_num,
                                    int img_chans,
                                    int img_rows,
@@ -209,6 +223,8 @@ void ref_conv3d_nhwc_valid_padding(float* input,
     int result_size = img_num * res_rows * res_cols * (k_num + res_pad);
     dmaLoad(input, input, input_size * sizeof(float));
     dmaLoad(kernels, kernels, kernel_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, k_num * sizeof(float));
 
     // Convolution borders.
     const int start_i = 0;
@@ -230,7 +246,7 @@ void ref_conv3d_nhwc_valid_padding(float* input,
                 int out_j = 0;
                 conv3d_input_cols:
                 for (int j = start_j; j < end_j; j += k_col_stride) {
-                    float partial_sum = 0;
+                    float partial_sum = bias ? bias[kern] : 0;
                     conv3d_kernel_height:
                     // Convolution loop over the kernel.
                     for (int d = 0; d < img_chans; d++) {
@@ -266,6 +282,7 @@ void ref_conv3d_nhwc_valid_padding(float* input,
 void ref_conv3d_nhwc_same_padding(float* input,
                                   float* kernels,
                                   float* result,
+                                  float* bias,
                                   int img_num,
                                   int img_chans,
                                   int img_rows,
@@ -287,6 +304,8 @@ void ref_conv3d_nhwc_same_padding(float* input,
     int result_size = img_num * res_rows * res_cols * (k_num + res_pad);
     dmaLoad(input, input, input_size * sizeof(float));
     dmaLoad(kernels, kernels, kernel_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, k_num * sizeof(float));
 
     const int total_row_pad = k_rows - 1;
     const int total_col_pad = k_cols - 1;
@@ -315,7 +334,7 @@ void ref_conv3d_nhwc_same_padding(float* input,
                 int out_j = 0;
                 conv3d_input_cols:
                 for (int j = start_j; j < end_j; j += k_col_stride) {
-                    float partial_sum = 0;
+                    float partial_sum = bias ? bias[kern] : 0;
 
                     conv3d_kernel_height:
                     // Convolution loop over the kernel.
@@ -357,6 +376,171 @@ void ref_conv3d_nhwc_same_padding(float* input,
 #endif
 
 namespace smaug {
+namespace ref {
+
+/** Runs func(i) for every i in [0, count), on the thread pool if there is one. */
+template <typename Func>
+static void parallelForEach(int count, Func func) {
+    if (threadPool) {
+        threadPool->parallelFor(0, count, func);
+    } else {
+        for (int i = 0; i < count; i++)
+            func(i);
+    }
+}
+
+/**
+ * Returns the range [begin, end) of output positions o in [0, numOutputs) for
+ * which the input position o * stride + offset is in [0, inputSize).
+ */
+static std::pair<int, int> getValidOutputRange(
+        int numOutputs, int stride, int offset, int inputSize) {
+    // The first o with o * stride + offset >= 0.
+    int begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+    // The last o with o * stride + offset <= inputSize - 1.
+    int last = inputSize - 1 - offset;
+    int end = last < 0 ? 0 : last / stride + 1;
+    return std::make_pair(begin, std::min(end, numOutputs));
+}
+
+void conv3dNative(DataLayout layout,
+                  PaddingType paddingType,
+                  float* input,
+                  float* kernels,
+                  float* result,
+                  float* bias,
+                  int imgNum,
+                  int imgChans,
+                  int imgRows,
+                  int imgCols,
+                  int imgPad,
+                  int kNum,
+                  int kRows,
+                  int kCols,
+                  int kPad,
+                  int rowStride,
+                  int colStride,
+                  int resRows,
+                  int resCols,
+                  int resPad,
+                  activation_type actFunction,
+                  activation_param_t actParams) {
+    // The padding and borders are computed the same way as in the kernels.
+    int topPad = 0, leftPad = 0, bottomPad = 0, rightPad = 0;
+    if (paddingType == SamePadding) {
+        leftPad = kRows / 2;
+        rightPad = kCols - 1 - leftPad;
+        topPad = kCols / 2;
+        bottomPad = kRows - 1 - topPad;
+    }
+    int numOutRows = std::min(
+            resRows, (imgRows + topPad + bottomPad - kRows) / rowStride + 1);
+    int numOutCols = std::min(
+            resCols, (imgCols + leftPad + rightPad - kCols) / colStride + 1);
+    int resultSize;
+
+    if (layout == DataLayout::NCHW) {
+        int inRowSize = imgCols + imgPad;
+        int kRowSize = kCols + kPad;
+        int resRowSize = resCols + resPad;
+        resultSize = imgNum * kNum * resRows * resRowSize;
+        // Every task computes one output feature map of one image. The output
+        // rows are accumulated one input row at a time, so each input row is
+        // reused for all the kernel columns.
+        parallelForEach(imgNum * kNum, [&](int task) {
+            int img = task / kNum;
+            int kern = task % kNum;
+            float* res = result + (img * kNum + kern) * resRows * resRowSize;
+            float init = bias ? bias[kern] : 0;
+            for (int i = 0; i < numOutRows; i++)
+                std::fill(res + i * resRowSize,
+                          res + i * resRowSize + numOutCols, init);
+            for (int d = 0; d < imgChans; d++) {
+                float* in = input + (img * imgChans + d) * imgRows * inRowSize;
+                float* kern2d =
+                        kernels + (kern * imgChans + d) * kRows * kRowSize;
+                for (int k = 0; k < kRows; k++) {
+                    auto rows = getValidOutputRange(
+                            numOutRows, rowStride, k - topPad, imgRows);
+                    for (int i = rows.first; i < rows.second; i++) {
+                        float* inRow =
+                                in + (i * rowStride + k - topPad) * inRowSize;
+                        float* resRow = res + i * resRowSize;
+                        for (int l = 0; l < kCols; l++) {
+                            float weight = kern2d[k * kRowSize + l];
+                            auto cols = getValidOutputRange(
+                                    numOutCols, colStride, l - leftPad,
+                                    imgCols);
+                            float* inCol = inRow + l - leftPad;
+                            for (int j = cols.first; j < cols.second; j++)
+                                resRow[j] += weight * inCol[j * colStride];
+                        }
+                    }
+                }
+            }
+        });
+    } else {
+        int inPixelSize = imgChans + imgPad;
+        int kPixelSize = imgChans + kPad;
+        int resPixelSize = kNum + resPad;
+        resultSize = imgNum * resRows * resCols * resPixelSize;
+        // Repack the kernels so that all the kernels are innermost, which lets
+        // every input element update all the output channels of a pixel in
+        // one contiguous loop.
+        std::vector<float> packedKernels(imgChans * kRows * kCols * kNum);
+        for (int kern = 0; kern < kNum; kern++) {
+            for (int k = 0; k < kRows; k++) {
+                for (int l = 0; l < kCols; l++) {
+                    for (int d = 0; d < imgChans; d++) {
+                        packedKernels[((d * kRows + k) * kCols + l) * kNum +
+                                      kern] =
+                                kernels[((kern * kRows + k) * kCols + l) *
+                                                kPixelSize +
+                                        d];
+                    }
+                }
+            }
+        }
+        // Every task computes one output row of one image.
+        parallelForEach(imgNum * numOutRows, [&](int task) {
+            int img = task / numOutRows;
+            int i = task % numOutRows;
+            auto rows = getValidOutputRange(
+                    kRows, 1, i * rowStride - topPad, imgRows);
+            for (int j = 0; j < numOutCols; j++) {
+                float* res = result +
+                             ((img * resRows + i) * resCols + j) * resPixelSize;
+                for (int kern = 0; kern < kNum; kern++)
+                    res[kern] = bias ? bias[kern] : 0;
+                auto cols = getValidOutputRange(
+                        kCols, 1, j * colStride - leftPad, imgCols);
+                for (int d = 0; d < imgChans; d++) {
+                    for (int k = rows.first; k < rows.second; k++) {
+                        int inRow = i * rowStride - topPad + k;
+                        for (int l = cols.first; l < cols.second; l++) {
+                            int inCol = j * colStride - leftPad + l;
+                            float value = input[((img * imgRows + inRow) *
+                                                         imgCols +
+                                                 inCol) *
+                                                        inPixelSize +
+                                                d];
+                            float* weights =
+                                    &packedKernels[((d * kRows + k) * kCols +
+                                                    l) *
+                                                   kNum];
+                            for (int kern = 0; kern < kNum; kern++)
+                                res[kern] += value * weights[kern];
+                        }
+                    }
+                }
+            }
+        });
+    }
+    if (actFunction != NO_ACTIVATION)
+        activation_fun(result, result, resultSize, actFunction, actParams);
+}
+
+}  // namespace ref
 
 template <>
 void ConvolutionOp<ReferenceBackend>::run() {
@@ -371,12 +555,17 @@ void ConvolutionOp<ReferenceBackend>::run() {
     float* inputData = input->data<float>();
     float* kernelData = kernels->data<float>();
     float* outputData = output->data<float>();
+    float* biasData = bias ? bias->data<float>() : nullptr;
     mapArrayToAccel(ref::kConvolutionHw, "input", inputData,
                     inputShape.storageSize() * sizeof(float));
     mapArrayToAccel(ref::kConvolutionHw, "kernels", kernelData,
                     kernelShape.storageSize() * sizeof(float));
     mapArrayToAccel(ref::kConvolutionHw, "result", outputData,
                     outputShape.storageSize() * sizeof(float));
+    if (bias) {
+        mapArrayToAccel(ref::kConvolutionHw, "bias", biasData,
+                        bias->getShape().storageSize() * sizeof(float));
+    }
     bool isNCHW = input->getShape().getLayout() == NCHW;
     auto func = isNCHW ? (paddingType == ValidPadding
                                   ? ref_conv3d_nchw_valid_padding
@@ -387,9 +576,26 @@ void ConvolutionOp<ReferenceBackend>::run() {
     int rowIdx = isNCHW ? 2 : 1;
     int colIdx = isNCHW ? 3 : 2;
     int chanIdx = isNCHW ? 1 : 3;
+#ifndef TRACE_MODE
+    // The kernels are only needed to model the accelerator. Native runs use
+    // the much faster equivalent implementation.
+    if (!runningInSimulation) {
+        ref::conv3dNative(inputShape.getLayout(), paddingType, inputData,
+                          kernelData, outputData, biasData, inputShape[0],
+                          inputShape[chanIdx], inputShape[rowIdx],
+                          inputShape[colIdx], inputShape.getPadding(3),
+                          kernelShape[0], kernelShape[rowIdx],
+                          kernelShape[colIdx], kernelShape.getPadding(3),
+                          getRowStride(), getColStride(), outputShape[rowIdx],
+                          outputShape[colIdx], outputShape.getPadding(3),
+                          actInfo.function, actInfo.params);
+        return;
+    }
+#endif
     invokeKernel(ref::kConvolutionHw, func, inputData, kernelData, outputData,
-                 inputShape[0], inputShape[chanIdx], inputShape[rowIdx],
-                 inputShape[colIdx], inputShape.getPadding(3), kernelShape[0],
+                 biasData, inputShape[0], inputShape[chanIdx],
+                 inputShape[rowIdx], inputShape[colIdx],
+                 inputShape.getPadding(3), kernelShape[0],
                  kernelShape[rowIdx], kernelShape[colIdx],
                  kernelShape.getPadding(3), getRowStride(), getColStride(),
                  outputShape[rowIdx], outputShape[colIdx],
@@ -0,0 +1,150 @@
+#ifndef _OPERATORS_REF_REF_CONVOLUTION_OP_H_
+#define _OPERATORS_REF_REF_CONVOLUTION_OP_H_
+
+#include "smaug/operators/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \ingroup AladdinKernels
+ * @{
+ *
+ * Reference implementations of a 3D convolution, for each combination of data
+ * layout (NCHW or NHWC) and padding type (valid or same). If bias is not NULL,
+ * it holds one value per kernel that is added to the results.
+ */
+void ref_conv3d_nchw_valid_padding(float* input,
+                                   float* kernels,
+                                   float* result,
+                                   float* bias,
+                                   int img_num,
+                                   int img_chans,
+                                   int img_rows,
+                                   int img_cols,
+                                   int img_pad,
+                                   int k_num,
+                                   int k_rows,
+                                   int k_cols,
+                                   int k_pad,
+                                   int k_row_stride,
+                                   int k_col_stride,
+                                   int res_rows,
+                                   int res_cols,
+                                   int res_pad,
+                                   activation_type act_function,
+                                   activation_param_t act_params);
+
+void ref_conv3d_nchw_same_padding(float* input,
+                                  float* kernels,
+                                  float* result,
+                                  float* bias,
+                                  int img_num,
+                                  int img_chans,
+                                  int img_rows,
+                                  int img_cols,
+                                  int img_pad,
+                                  int k_num,
+                                  int k_rows,
+                                  int k_cols,
+                                  int k_pad,
+                                  int k_row_stride,
+                                  int k_col_stride,
+                                  int res_rows,
+                                  int res_cols,
+                                  int res_pad,
+                                  activation_type act_function,
+                                  activation_param_t act_params);
+
+void ref_conv3d_nhwc_valid_padding(float* input,
+                                   float* kernels,
+                                   float* result,
+                                   float* bias,
+                                   int img_num,
+                                   int img_chans,
+                                   int img_rows,
+                                   int img_cols,
+                                   int img_pad,
+                                   int k_num,
+                                   int k_rows,
+                                   int k_cols,
+                                   int k_pad,
+                                   int k_row_stride,
+                                   int k_col_stride,
+                                   int res_rows,
+                                   int res_cols,
+                                   int res_pad,
+                                   activation_type act_function,
+                                   activation_param_t act_params);
+
+void ref_conv3d_nhwc_same_padding(float* input,
+                                  float* kernels,
+                                  float* result,
+                                  float* bias,
+                                  int img_num,
+                                  int img_chans,
+                                  int img_rows,
+                                  int img_cols,
+                                  int img_pad,
+                                  int k_num,
+                                  int k_rows,
+                                  int k_cols,
+                                  int k_pad,
+                                  int k_row_stride,
+                                  int k_col_stride,
+                                  int res_rows,
+                                  int res_cols,
+                                  int res_pad,
+                                  activation_type act_function,
+                                  activation_param_t act_params);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+namespace smaug {
+namespace ref {
+
+/**
+ * A native implementation of the reference convolution kernels, which is used
+ * instead of them when SMAUG is neither simulated nor traced.
+ *
+ * It takes the same arguments as the kernels, plus the data layout and the
+ * padding type that select among them. For every output element, the products
+ * are accumulated in the same order as in the kernels, but the loops are
+ * reordered so that input rows (NCHW) or input pixels (NHWC) are reused from
+ * the cache and the innermost loop is vectorizable. The work is split across
+ * the images and output channels (NCHW) or output rows (NHWC) on the thread
+ * pool, if there is one.
+ */
+void conv3dNative(DataLayout layout,
+                  PaddingType paddingType,
+                  float* input,
+                  float* kernels,
+                  float* result,
+                  float* bias,
+                  int imgNum,
+                  int imgChans,
+                  int imgRows,
+                  int imgCols,
+                  int imgPad,
+                  int kNum,
+                  int kRows,
+                  int kCols,
+                  int kPad,
+                  int rowStride,
+                  int colStride,
+                  int resRows,
+                  int resCols,
+                  int resPad,
+                  activation_type actFunction,
+                  activation_param_t actParams);
+
+}  // namespace ref
+}  // namespace smaug
+
+#endif
@@ -3,6 +3,7 @@
 #include "smaug/core/tensor.h"
 #include "smaug/core/smaug_test.h"
 #include "smaug/operators/convolution_op.h"
+#include "smaug/operators/ref/ref_convolution_op.h"
 
 using namespace smaug;
 
@@ -275,3 +276,84 @@ TEST_CASE_METHOD(SmaugTest, "Reference convolution operator", "[refop]") {
         }
     }
 }
+
+// Runs the operator, which uses the native implementation, and compares its
+// output against that of the reference kernel.
+static void verifyNativeConvolution(SmaugTest* test,
+                                    const std::string& name,
+                                    DataLayout layout,
+                                    PaddingType padding,
+                                    int stride) {
+    bool isNCHW = layout == DataLayout::NCHW;
+    auto convOp = new ConvolutionOp<ReferenceBackend>(name, test->workspace());
+    TensorShape inputShape(isNCHW ? std::vector<int>{ 1, 5, 9, 7 }
+                                  : std::vector<int>{ 1, 9, 7, 5 },
+                           layout);
+    Tensor* input = new Tensor(name + "/input", inputShape);
+    input->allocateStorage<float>();
+    std::vector<float> inputData;
+    for (int i = 0; i < inputShape.size(); i++)
+        inputData.push_back(((i * 7) % 13) - 6);
+    input->fillData(inputData.data(), inputData.size());
+    test->workspace()->addTensor(input);
+    convOp->setInput(input, 0);
+    convOp->setPadding(padding);
+    convOp->setWeightDims(3, 3, 6);
+    convOp->setStride(stride, stride);
+    ActivationInfo actInfo;
+    actInfo.function = activation_type::RELU;
+    convOp->setActivation(actInfo);
+    convOp->createAllTensors();
+    test->allocateAllTensors<float>(convOp);
+    Tensor* kernels = convOp->getInput(1);
+    std::vector<float> kernelData;
+    for (int i = 0; i < kernels->getShape().size(); i++)
+        kernelData.push_back(((i * 5) % 11) - 5);
+    kernels->fillData(kernelData.data(), kernelData.size());
+    Tensor* bias = new Tensor(name + "/bias", TensorShape({ 1, 6 }, DataLayout::NC));
+    bias->allocateStorage<float>();
+    bias->fillData<float>({ 1, -2, 3, -4, 5, -6 });
+    test->workspace()->addTensor(bias);
+    convOp->setBias(bias);
+    convOp->run();
+
+    Tensor* output = convOp->getOutput(0);
+    const TensorShape& outputShape = output->getShape();
+    const TensorShape& kernelShape = kernels->getShape();
+    Tensor* expected = new Tensor(name + "/expected", outputShape);
+    expected->allocateStorage<float>();
+    test->workspace()->addTensor(expected);
+    auto func = isNCHW ? (padding == ValidPadding
+                                  ? ref_conv3d_nchw_valid_padding
+                                  : ref_conv3d_nchw_same_padding)
+                       : (padding == ValidPadding
+                                  ? ref_conv3d_nhwc_valid_padding
+                                  : ref_conv3d_nhwc_same_padding);
+    int rowIdx = isNCHW ? 2 : 1;
+    int colIdx = isNCHW ? 3 : 2;
+    int chanIdx = isNCHW ? 1 : 3;
+    func(input->data<float>(), kernels->data<float>(),
+         expected->data<float>(), bias->data<float>(), inputShape[0],
+         inputShape[chanIdx], inputShape[rowIdx], inputShape[colIdx],
+         inputShape.getPadding(3), kernelShape[0], kernelShape[rowIdx],
+         kernelShape[colIdx], kernelShape.getPadding(3), stride, stride,
+         outputShape[rowIdx], outputShape[colIdx], outputShape.getPadding(3),
+         actInfo.function, actInfo.params);
+    test->verifyOutputs<float>(output, expected);
+}
+
+TEST_CASE_METHOD(SmaugTest,
+                 "Native reference convolution matches the kernels",
+                 "[refop]") {
+    int numTests = 0;
+    for (DataLayout layout : { DataLayout::NCHW, DataLayout::NHWC }) {
+        for (PaddingType padding : { ValidPadding, SamePadding }) {
+            for (int stride : { 1, 2 }) {
+                INFO("Layout " << layout << ", padding " << padding
+                               << ", stride " << stride);
+                verifyNativeConvolution(this, "conv" + std::to_string(numTests++),
+                                        layout, padding, stride);
+            }
+        }
+    }
+}
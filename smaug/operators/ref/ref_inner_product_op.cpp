@@ -1,8 +1,14 @@
+#include <algorithm>
+#include <vector>
+
 #include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
 #include "smaug/operators/common.h"
 #include "smaug/operators/inner_product_op.h"
 #include "smaug/operators/ref/ref_activation_fun_op.h"
+#include "smaug/operators/ref/ref_inner_product_op.h"
 #include "smaug/utility/debug_stream.h"
+#include "smaug/utility/thread_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,6 +21,7 @@ extern "C" {
  * @param a A matrix of dimensions a_height x a_width
  * @param b A matrix of dimensions a_width x b_width
  * @param c A matrix of dimensions a_height x b_width
+ * @param bias A bias of b_width elements to add to each row of c, or NULL.
  * @param a_height Number of rows in A
  * @param a_width Number of columns in A
  * @param b_width Number of columns in B
@@ -28,6 +35,7 @@ extern "C" {
 void ref_inner_product_ab_times_bc(float* a,
                                    float* b,
                                    float* c,
+                                   float* bias,
                                    int a_height,
                                    int a_width,
                                    int b_width,
@@ -41,6 +49,8 @@ void ref_inner_product_ab_times_bc(float* a,
     int result_size = a_height * (b_width + c_pad);
     dmaLoad(a, a, input_size * sizeof(float));
     dmaLoad(b, b, weight_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, b_width * sizeof(float));
 
     ARRAY_2D(float, _a, a, a_width + a_pad);
     ARRAY_2D(float, _b, b, b_width + b_pad);
@@ -50,7 +60,7 @@ void ref_inner_product_ab_times_bc(float* a,
     for (int i = 0; i < a_height; i++) {
         matmul1:
         for (int j = 0; j < b_width; j++) {
-            float result = 0;
+            float result = bias ? bias[j] : 0;
             matmul2:
             for (int k = 0; k < a_width; k++) {
                 float a_val = _a[i][k];
@@ -74,6 +84,7 @@ void ref_inner_product_ab_times_bc(float* a,
  * @param a A matrix of dimensions a_height x b_width
  * @param b A matrix of dimensions b_height x b_width
  * @param c A matrix of dimensions a_height x b_width
+ * @param bias A bias of b_height elements to add to each row of c, or NULL.
  * @param a_height Number of rows in A
  * @param b_width Number of columns in B
  * @param b_height Number of rows in B
@@ -87,6 +98,7 @@ void ref_inner_product_ab_times_bc(float* a,
 void ref_inner_product_ab_times_cb(float* a,
                                    float* b,
                                    float* c,
+                                   float* bias,
                                    int a_height,
                                    int b_width,
                                    int b_height,
@@ -101,6 +113,8 @@ void ref_inner_product_ab_times_cb(float* a,
     int result_size = a_height * (b_height + c_pad);
     dmaLoad(a, a, input_size * sizeof(float));
     dmaLoad(b, b, weight_size * sizeof(float));
+    if (bias)
+        dmaLoad(bias, bias, b_height * sizeof(float));
 
     ARRAY_2D(float, _a, a, a_width);
     ARRAY_2D(float, _b, b, b_width);
@@ -110,7 +124,7 @@ void ref_inner_product_ab_times_cb(float* a,
     for (int i = 0; i < a_height; i++) {
         matmul1:
         for (int j = 0; j < b_height; j++) {
-            float result = 0;
+            float result = bias ? bias[j] : 0;
             matmul2:
             for (int k = 0; k < a_width; k++) {
                 float a_val = _a[i][k];
@@ -131,6 +145,153 @@ void ref_inner_product_ab_times_cb(float* a,
 #endif
 
 namespace smaug {
+namespace ref {
+
+// The micro-kernel computes kMicroRows rows of one panel of C at a time, where
+// a panel is kPanelVecs vectors wide.
+static const int kMicroRows = 4;
+static const int kPanelVecs = 2;
+static const int kPanelWidth = kPanelVecs * VECTOR_SIZE;
+// Cache blocking sizes along the rows of A, the neurons and the depth of the
+// product. A packed block of the weights is 128 KB.
+static const int kRowBlock = 64;
+static const int kNeuronBlock = 8 * kPanelWidth;
+static const int kDepthBlock = 256;
+
+/**
+ * Packs the depth x numCols block of the weights starting at row k0 and column
+ * j0 of B into panels. Each panel holds kPanelWidth consecutive columns, with
+ * the elements of each row contiguous. Columns past numCols are zero.
+ */
+static void packWeights(bool weightsTransposed,
+                        const float* b,
+                        int bRowSize,
+                        int k0,
+                        int depth,
+                        int j0,
+                        int numCols,
+                        v8fp_t* packed) {
+    int numPanels = FRAC_CEIL(numCols, kPanelWidth);
+    for (int p = 0; p < numPanels; p++) {
+        float* panel = (float*)(packed + p * depth * kPanelVecs);
+        for (int col = 0; col < kPanelWidth; col++) {
+            int j = j0 + p * kPanelWidth + col;
+            bool valid = j < j0 + numCols;
+            for (int k = 0; k < depth; k++) {
+                float value = 0;
+                if (valid) {
+                    value = weightsTransposed ? b[j * bRowSize + k0 + k]
+                                              : b[(k0 + k) * bRowSize + j];
+                }
+                panel[k * kPanelWidth + col] = value;
+            }
+        }
+    }
+}
+
+/**
+ * Accumulates the product of up to kMicroRows rows of A and one panel of the
+ * packed weights into C. Only the first rows x cols elements of C are read and
+ * written.
+ */
+static void matmulMicroKernel(const float* a,
+                              int aRowSize,
+                              const v8fp_t* panel,
+                              int depth,
+                              float* c,
+                              int cRowSize,
+                              int rows,
+                              int cols) {
+    // Missing rows repeat the last row of A so that the inner loop is
+    // branch-free. Their results are discarded.
+    const float* aRows[kMicroRows];
+    for (int r = 0; r < kMicroRows; r++)
+        aRows[r] = a + std::min(r, rows - 1) * aRowSize;
+    v8fp_t acc[kMicroRows][kPanelVecs];
+    for (int r = 0; r < kMicroRows; r++) {
+        for (int v = 0; v < kPanelVecs; v++) {
+            for (int e = 0; e < VECTOR_SIZE; e++) {
+                int col = v * VECTOR_SIZE + e;
+                acc[r][v][e] = r < rows && col < cols ? c[r * cRowSize + col] : 0;
+            }
+        }
+    }
+    for (int k = 0; k < depth; k++) {
+        const v8fp_t* weights = panel + k * kPanelVecs;
+        for (int r = 0; r < kMicroRows; r++) {
+            float value = aRows[r][k];
+            for (int v = 0; v < kPanelVecs; v++)
+                acc[r][v] += value * weights[v];
+        }
+    }
+    for (int r = 0; r < rows; r++) {
+        for (int col = 0; col < cols; col++)
+            c[r * cRowSize + col] = acc[r][col / VECTOR_SIZE][col % VECTOR_SIZE];
+    }
+}
+
+void matmulNative(bool weightsTransposed,
+                  float* a,
+                  float* b,
+                  float* c,
+                  float* bias,
+                  int height,
+                  int width,
+                  int numNeurons,
+                  int aPad,
+                  int bPad,
+                  int cPad,
+                  activation_type actFunction,
+                  activation_param_t actParams) {
+    int aRowSize = width + aPad;
+    int bRowSize = (weightsTransposed ? width : numNeurons) + bPad;
+    int cRowSize = numNeurons + cPad;
+    int numRowBlocks = FRAC_CEIL(height, kRowBlock);
+    int numNeuronBlocks = FRAC_CEIL(numNeurons, kNeuronBlock);
+    // Every task computes one block of C. The products are accumulated into C
+    // one depth block at a time, in order, so every output element sums its
+    // products in the same order as the kernels.
+    auto computeBlock = [&](int block) {
+        int i0 = (block / numNeuronBlocks) * kRowBlock;
+        int j0 = (block % numNeuronBlocks) * kNeuronBlock;
+        int rows = std::min(kRowBlock, height - i0);
+        int cols = std::min(kNeuronBlock, numNeurons - j0);
+        for (int i = i0; i < i0 + rows; i++) {
+            for (int j = j0; j < j0 + cols; j++)
+                c[i * cRowSize + j] = bias ? bias[j] : 0;
+        }
+        std::vector<v8fp_t> packed(kDepthBlock * kNeuronBlock / VECTOR_SIZE);
+        for (int k0 = 0; k0 < width; k0 += kDepthBlock) {
+            int depth = std::min(kDepthBlock, width - k0);
+            packWeights(weightsTransposed, b, bRowSize, k0, depth, j0, cols,
+                        packed.data());
+            for (int p = 0; p * kPanelWidth < cols; p++) {
+                const v8fp_t* panel = &packed[p * depth * kPanelVecs];
+                int panelCols = std::min(kPanelWidth, cols - p * kPanelWidth);
+                for (int i = i0; i < i0 + rows; i += kMicroRows) {
+                    matmulMicroKernel(a + i * aRowSize + k0, aRowSize, panel,
+                                      depth,
+                                      c + i * cRowSize + j0 + p * kPanelWidth,
+                                      cRowSize,
+                                      std::min(kMicroRows, i0 + rows - i),
+                                      panelCols);
+                }
+            }
+        }
+    };
+    int numBlocks = numRowBlocks * numNeuronBlocks;
+    if (threadPool) {
+        threadPool->parallelFor(0, numBlocks, computeBlock);
+    } else {
+        for (int block = 0; block < numBlocks; block++)
+            computeBlock(block);
+    }
+    if (actFunction != NO_ACTIVATION) {
+        activation_fun(c, c, height * cRowSize, actFunction, actParams);
+    }
+}
+
+}  // namespace ref
 
 template <>
 void InnerProductOp<ReferenceBackend>::run() {
@@ -149,19 +310,37 @@ void InnerProductOp<ReferenceBackend>::run() {
     float* inputData = input->data<float>();
     float* weightData = weights->data<float>();
     float* outputData = output->data<float>();
+    float* biasData = bias ? bias->data<float>() : nullptr;
     mapArrayToAccel(ref::kInnerProductHw, "a", inputData,
                     inputShape.storageSize() * sizeof(float));
     mapArrayToAccel(ref::kInnerProductHw, "b", weightData,
                     weightShape.storageSize() * sizeof(float));
     mapArrayToAccel(ref::kInnerProductHw, "c", outputData,
                     outputShape.storageSize() * sizeof(float));
+    if (bias) {
+        mapArrayToAccel(ref::kInnerProductHw, "bias", biasData,
+                        bias->getShape().storageSize() * sizeof(float));
+    }
     bool weightsTransposed = weightShape.getLayout() == DataLayout::NC;
     auto func = weightsTransposed ? ref_inner_product_ab_times_cb
                                   : ref_inner_product_ab_times_bc;
     int actIdx = weightsTransposed ? 1 : 0;
     int neuronIdx = weightsTransposed ? 0 : 1;
+#ifndef TRACE_MODE
+    // The kernels are only needed to model the accelerator. Native runs use
+    // the much faster equivalent implementation.
+    if (!runningInSimulation) {
+        ref::matmulNative(weightsTransposed, inputData, weightData, outputData,
+                          biasData, inputShape[0], weightShape[actIdx],
+                          weightShape[neuronIdx], inputShape.getPadding(1),
+                          weightShape.getPadding(1), outputShape.getPadding(1),
+                          actInfo.function, actInfo.params);
+        return;
+    }
+#endif
     invokeKernel(ref::kInnerProductHw, func, inputData, weightData, outputData,
-                 inputShape[0], weightShape[actIdx], weightShape[neuronIdx],
+                 biasData, inputShape[0], weightShape[actIdx],
+                 weightShape[neuronIdx],
                  inputShape.getPadding(1), weightShape.getPadding(1),
                  outputShape.getPadding(1), actInfo.function, actInfo.params);
 }
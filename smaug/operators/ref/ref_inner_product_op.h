@@ -0,0 +1,84 @@
+#ifndef _OPERATORS_REF_REF_INNER_PRODUCT_OP_H_
+#define _OPERATORS_REF_REF_INNER_PRODUCT_OP_H_
+
+#include "smaug/operators/common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \ingroup AladdinKernels
+ * @{
+ *
+ * Reference implementations of an inner product, with the weights either in
+ * CN (`C = A x B`) or NC (`C = A x B_transpose`) layout. If bias is not NULL,
+ * it holds one value per output neuron that is added to every row of C.
+ */
+void ref_inner_product_ab_times_bc(float* a,
+                                   float* b,
+                                   float* c,
+                                   float* bias,
+                                   int a_height,
+                                   int a_width,
+                                   int b_width,
+                                   int a_pad,
+                                   int b_pad,
+                                   int c_pad,
+                                   activation_type act_function,
+                                   activation_param_t act_params);
+
+void ref_inner_product_ab_times_cb(float* a,
+                                   float* b,
+                                   float* c,
+                                   float* bias,
+                                   int a_height,
+                                   int b_width,
+                                   int b_height,
+                                   int a_pad,
+                                   int b_pad,
+                                   int c_pad,
+                                   activation_type act_function,
+                                   activation_param_t act_params);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+namespace smaug {
+namespace ref {
+
+/**
+ * A native implementation of the reference inner product kernels, which is
+ * used instead of them when SMAUG is neither simulated nor traced.
+ *
+ * This computes `C = A x B`, where A is a height x width matrix, and B is
+ * either width x numNeurons (CN) or, if weightsTransposed, numNeurons x width
+ * (NC). The product is cache blocked, the weights are packed into panels of
+ * vector-width columns, and a register-blocked micro-kernel computes a few
+ * rows of each panel at a time with GCC vector extensions. Every output
+ * element still accumulates its products in the same order as the kernels.
+ * The blocks of C are computed in parallel on the thread pool, if there is
+ * one.
+ */
+void matmulNative(bool weightsTransposed,
+                  float* a,
+                  float* b,
+                  float* c,
+                  float* bias,
+                  int height,
+                  int width,
+                  int numNeurons,
+                  int aPad,
+                  int bPad,
+                  int cPad,
+                  activation_type actFunction,
+                  activation_param_t actParams);
+
+}  // namespace ref
+}  // namespace smaug
+
+#endif
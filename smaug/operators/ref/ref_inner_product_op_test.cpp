@@ -4,6 +4,7 @@
 #include "smaug/core/smaug_test.h"
 #include "smaug/operators/reorder_op.h"
 #include "smaug/operators/inner_product_op.h"
+#include "smaug/operators/ref/ref_inner_product_op.h"
 
 using namespace smaug;
 
@@ -168,3 +169,64 @@ TEST_CASE_METHOD(SmaugTest, "Reference inner product operator", "[refop]") {
         }
     }
 }
+
+TEST_CASE_METHOD(SmaugTest,
+                 "Native reference inner product matches the kernels",
+                 "[refop]") {
+    // The sizes span several blocks in every dimension, with partial blocks,
+    // panels and micro-kernel rows at the edges.
+    const int height = 70, width = 300, numNeurons = 150;
+    auto matMulOp = new InnerProductOp<ReferenceBackend>("matmul", workspace());
+    Tensor* input = new Tensor(
+            "input", TensorShape({ height, width }, DataLayout::NC));
+    input->allocateStorage<float>();
+    std::vector<float> inputData;
+    for (int i = 0; i < height * width; i++)
+        inputData.push_back(((i * 7) % 13 - 6) * 0.25);
+    input->fillData(inputData.data(), inputData.size());
+    workspace()->addTensor(input);
+    matMulOp->setInput(input, 0);
+    matMulOp->setNumOutputs(numNeurons);
+    ActivationInfo actInfo;
+    actInfo.function = activation_type::RELU;
+    matMulOp->setActivation(actInfo);
+    matMulOp->createAllTensors();
+    allocateAllTensors<float>(matMulOp);
+    Tensor* weights = matMulOp->getInput(1);
+    std::vector<float> weightsData;
+    for (int i = 0; i < width * numNeurons; i++)
+        weightsData.push_back(((i * 5) % 11 - 5) * 0.5);
+    weights->fillData(weightsData.data(), weightsData.size());
+    Tensor* bias =
+            new Tensor("bias", TensorShape({ 1, numNeurons }, DataLayout::NC));
+    bias->allocateStorage<float>();
+    std::vector<float> biasData;
+    for (int i = 0; i < numNeurons; i++)
+        biasData.push_back(i % 9 - 4);
+    bias->fillData(biasData.data(), biasData.size());
+    workspace()->addTensor(bias);
+    matMulOp->setBias(bias);
+    Tensor* expected = new Tensor(
+            "expected", TensorShape({ height, numNeurons }, DataLayout::NC));
+    expected->allocateStorage<float>();
+    workspace()->addTensor(expected);
+
+    SECTION("Non-transposed weights") {
+        matMulOp->run();
+        ref_inner_product_ab_times_bc(
+                input->data<float>(), weights->data<float>(),
+                expected->data<float>(), bias->data<float>(), height, width,
+                numNeurons, 0, 0, 0, actInfo.function, actInfo.params);
+        verifyOutputs<float>(matMulOp->getOutput(0), expected);
+    }
+    SECTION("Transposed weights") {
+        Tensor* transposedWeights = transposeWeights(weights, workspace());
+        matMulOp->setInput(transposedWeights, 1);
+        matMulOp->run();
+        ref_inner_product_ab_times_cb(
+                input->data<float>(), transposedWeights->data<float>(),
+                expected->data<float>(), bias->data<float>(), height, width,
+                numNeurons, 0, 0, 0, actInfo.function, actInfo.params);
+        verifyOutputs<float>(matMulOp->getOutput(0), expected);
+    }
+}
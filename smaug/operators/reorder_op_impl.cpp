@@ -1,11 +1,244 @@
+#include <algorithm>
+#include <x86intrin.h>
+
+#include "smaug/core/globals.h"
 #include "smaug/core/tensor.h"
 #include "smaug/operators/reorder_op_impl.h"
+#include "smaug/utility/thread_pool.h"
 
 namespace smaug {
 
+namespace {
+
+// Matrices are transposed in tiles of kTileSize x kTileSize elements, so that
+// the rows read and the rows written by a tile both stay in the L1 cache. The
+// tiles are transposed in 8x8 blocks.
+const int kTileSize = 64;
+const int kBlockSize = 8;
+// Transposes of fewer elements than this are not worth splitting across the
+// thread pool.
+const int kMinParallelElems = 16384;
+
+/**
+ * Transposes a rows x cols block at in, with rows inStride elements apart,
+ * into out, with rows outStride elements apart.
+ */
+template <typename DType>
+void transposeBlock(const DType* in,
+                    int inStride,
+                    DType* out,
+                    int outStride,
+                    int rows,
+                    int cols) {
+    for (int c = 0; c < cols; c++) {
+        for (int r = 0; r < rows; r++)
+            out[c * outStride + r] = in[r * inStride + c];
+    }
+}
+
+/** Transposes an 8x8 block. This is overloaded for the vectorized types. */
+template <typename DType>
+void transpose8x8(const DType* in, int inStride, DType* out, int outStride) {
+    transposeBlock(in, inStride, out, outStride, kBlockSize, kBlockSize);
+}
+
+/**
+ * Transposes an 8x8 block of single-precision values in SSE registers. Each
+ * 4x4 quadrant is transposed in place, and the two off-diagonal quadrants
+ * swap places as they are stored.
+ */
+void transpose8x8(const float* in, int inStride, float* out, int outStride) {
+    __m128 left[8], right[8];
+    for (int i = 0; i < 8; i++) {
+        left[i] = _mm_loadu_ps(in + i * inStride);
+        right[i] = _mm_loadu_ps(in + i * inStride + 4);
+    }
+    _MM_TRANSPOSE4_PS(left[0], left[1], left[2], left[3]);
+    _MM_TRANSPOSE4_PS(right[0], right[1], right[2], right[3]);
+    _MM_TRANSPOSE4_PS(left[4], left[5], left[6], left[7]);
+    _MM_TRANSPOSE4_PS(right[4], right[5], right[6], right[7]);
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_ps(out + i * outStride, left[i]);
+        _mm_storeu_ps(out + i * outStride + 4, left[i + 4]);
+        _mm_storeu_ps(out + (i + 4) * outStride, right[i]);
+        _mm_storeu_ps(out + (i + 4) * outStride + 4, right[i + 4]);
+    }
+}
+
+/**
+ * Transposes an 8x8 block of half-precision values in SSE registers, by
+ * interleaving the 16-bit, then 32-bit and then 64-bit elements of pairs of
+ * rows.
+ */
+void transpose8x8(const float16* in,
+                  int inStride,
+                  float16* out,
+                  int outStride) {
+    __m128i rows[8];
+    for (int i = 0; i < 8; i++)
+        rows[i] = _mm_loadu_si128((const __m128i*)(in + i * inStride));
+    __m128i pairs[8], quads[8];
+    for (int i = 0; i < 8; i += 2) {
+        pairs[i] = _mm_unpacklo_epi16(rows[i], rows[i + 1]);
+        pairs[i + 1] = _mm_unpackhi_epi16(rows[i], rows[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        quads[i] = _mm_unpacklo_epi32(pairs[i], pairs[i + 2]);
+        quads[i + 1] = _mm_unpackhi_epi32(pairs[i], pairs[i + 2]);
+        quads[i + 2] = _mm_unpacklo_epi32(pairs[i + 1], pairs[i + 3]);
+        quads[i + 3] = _mm_unpackhi_epi32(pairs[i + 1], pairs[i + 3]);
+    }
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_si128((__m128i*)(out + 2 * i * outStride),
+                         _mm_unpacklo_epi64(quads[i], quads[i + 4]));
+        _mm_storeu_si128((__m128i*)(out + (2 * i + 1) * outStride),
+                         _mm_unpackhi_epi64(quads[i], quads[i + 4]));
+    }
+}
+
+/**
+ * Describes a batch of matrices to transpose. The matrices are indexed by two
+ * batch dimensions, so that one can be a dimension that could not be merged
+ * into the columns.
+ */
+struct TransposeParams {
+    int batches[2];
+    int inBatchStrides[2];
+    int outBatchStrides[2];
+    int rows;
+    int cols;
+    int inRowStride;
+    int outRowStride;
+};
+
+/**
+ * Transposes every matrix of the batch. Each task transposes one band of
+ * kTileSize rows of a matrix, one tile at a time, and the tasks are run on
+ * the thread pool if there is one.
+ */
+template <typename DType>
+void transposeMatrices(const DType* input,
+                       DType* output,
+                       const TransposeParams& p) {
+    int numBands = (p.rows + kTileSize - 1) / kTileSize;
+    int numTasks = p.batches[0] * p.batches[1] * numBands;
+    auto transposeBand = [&](int task) {
+        int band = task % numBands;
+        int batch1 = (task / numBands) % p.batches[1];
+        int batch0 = task / numBands / p.batches[1];
+        const DType* in = input + batch0 * p.inBatchStrides[0] +
+                          batch1 * p.inBatchStrides[1];
+        DType* out = output + batch0 * p.outBatchStrides[0] +
+                     batch1 * p.outBatchStrides[1];
+        if (p.rows < kBlockSize) {
+            // Too few rows for any 8x8 block, e.g. the channels of an RGB
+            // image. Each output row is short, so write them one by one.
+            transposeBlock(in, p.inRowStride, out, p.outRowStride, p.rows,
+                           p.cols);
+            return;
+        }
+        int r0 = band * kTileSize;
+        int rEnd = std::min(p.rows, r0 + kTileSize);
+        for (int c0 = 0; c0 < p.cols; c0 += kTileSize) {
+            int cEnd = std::min(p.cols, c0 + kTileSize);
+            for (int r = r0; r < rEnd; r += kBlockSize) {
+                // Full 8x8 blocks are transposed in registers, and whatever
+                // is left of the rows of the tile in one scalar block.
+                int rows = std::min(kBlockSize, rEnd - r);
+                int c = c0;
+                for (; rows == kBlockSize && c + kBlockSize <= cEnd;
+                     c += kBlockSize) {
+                    transpose8x8(in + r * p.inRowStride + c, p.inRowStride,
+                                 out + c * p.outRowStride + r, p.outRowStride);
+                }
+                if (c < cEnd) {
+                    transposeBlock(in + r * p.inRowStride + c, p.inRowStride,
+                                   out + c * p.outRowStride + r,
+                                   p.outRowStride, rows, cEnd - c);
+                }
+            }
+        }
+    };
+    int numElems = p.batches[0] * p.batches[1] * p.rows * p.cols;
+    if (threadPool && numTasks > 1 && numElems >= kMinParallelElems) {
+        threadPool->parallelFor(0, numTasks, transposeBand);
+    } else {
+        for (int task = 0; task < numTasks; task++)
+            transposeBand(task);
+    }
+}
+
+template <typename DType>
+void transposeMatrices(Tensor* input,
+                       Tensor* output,
+                       const TransposeParams& params) {
+    transposeMatrices<DType>(input->template data<DType>(),
+                             output->template data<DType>(), params);
+}
+
+void transposeMatrices(Tensor* input,
+                       Tensor* output,
+                       const TransposeParams& params) {
+    switch (input->getDataType()) {
+        case Float16:
+            transposeMatrices<float16>(input, output, params);
+            return;
+        case Float32:
+            transposeMatrices<float>(input, output, params);
+            return;
+        case Float64:
+            transposeMatrices<double>(input, output, params);
+            return;
+        case Int32:
+            transposeMatrices<int>(input, output, params);
+            return;
+        case Int64:
+            transposeMatrices<int64_t>(input, output, params);
+            return;
+        default:
+            assert(false && "Unknown data format!");
+    }
+}
+
+/**
+ * Returns true if the innermost dimension of both tensors is dense, which
+ * the blocked transposes need. Tensors with other strides use the scalar
+ * implementations.
+ */
+bool canTransposeBlocked(Tensor* input, Tensor* output) {
+    return input->getShape().getStride(-1) == 1 &&
+           output->getShape().getStride(-1) == 1;
+}
+
+}  // namespace
+
 void convertNchwToNhwc(Tensor* input, Tensor* output) {
     DataType datatype = input->getDataType();
     assert(input->ndims() == output->ndims() && input->ndims() == 4);
+    if (canTransposeBlocked(input, output)) {
+        // Each image is a C x HW matrix that is transposed into an HW x C
+        // one. If the rows of the input have alignment padding, H and W
+        // cannot be merged, and every row of the image is transposed apart.
+        const TensorShape& inputShape = input->getShape();
+        const TensorShape& outputShape = output->getShape();
+        int h = inputShape[2], w = inputShape[3];
+        bool mergeHW =
+                inputShape.getStride(2) == w &&
+                outputShape.getStride(1) == w * outputShape.getStride(2);
+        TransposeParams params;
+        params.batches[0] = inputShape[0];
+        params.batches[1] = mergeHW ? 1 : h;
+        params.inBatchStrides[0] = inputShape.getStride(0);
+        params.inBatchStrides[1] = inputShape.getStride(2);
+        params.outBatchStrides[0] = outputShape.getStride(0);
+        params.outBatchStrides[1] = outputShape.getStride(1);
+        params.rows = inputShape[1];
+        params.cols = mergeHW ? h * w : w;
+        params.inRowStride = inputShape.getStride(1);
+        params.outRowStride = outputShape.getStride(2);
+        transposeMatrices(input, output, params);
+        return;
+    }
     switch (datatype) {
         case Float16:
             convertNchwToNhwcImpl<float16>(input, output);
@@ -30,6 +263,28 @@ void convertNchwToNhwc(Tensor* input, Tensor* output) {
 void convertNhwcToNchw(Tensor* input, Tensor* output) {
     DataType datatype = input->getDataType();
     assert(input->ndims() == output->ndims() && input->ndims() == 4);
+    if (canTransposeBlocked(input, output)) {
+        // Each image is an HW x C matrix that is transposed into a C x HW
+        // one, one row of the image at a time if the output rows are padded.
+        const TensorShape& inputShape = input->getShape();
+        const TensorShape& outputShape = output->getShape();
+        int h = inputShape[1], w = inputShape[2];
+        bool mergeHW = outputShape.getStride(2) == w &&
+                       inputShape.getStride(1) == w * inputShape.getStride(2);
+        TransposeParams params;
+        params.batches[0] = inputShape[0];
+        params.batches[1] = mergeHW ? 1 : h;
+        params.inBatchStrides[0] = inputShape.getStride(0);
+        params.inBatchStrides[1] = inputShape.getStride(1);
+        params.outBatchStrides[0] = outputShape.getStride(0);
+        params.outBatchStrides[1] = outputShape.getStride(2);
+        params.rows = mergeHW ? h * w : w;
+        params.cols = inputShape[3];
+        params.inRowStride = inputShape.getStride(2);
+        params.outRowStride = outputShape.getStride(1);
+        transposeMatrices(input, output, params);
+        return;
+    }
     switch (datatype) {
         case Float16:
             convertNhwcToNchwImpl<float16>(input, output);
@@ -78,6 +333,23 @@ void flatten(Tensor* input, Tensor* output) {
 void transpose3D(Tensor* input, Tensor* output) {
     DataType datatype = input->getDataType();
     assert(input->ndims() == 3 && output->ndims() == 3);
+    if (canTransposeBlocked(input, output)) {
+        const TensorShape& inputShape = input->getShape();
+        const TensorShape& outputShape = output->getShape();
+        TransposeParams params;
+        params.batches[0] = inputShape[0];
+        params.batches[1] = 1;
+        params.inBatchStrides[0] = inputShape.getStride(0);
+        params.inBatchStrides[1] = 0;
+        params.outBatchStrides[0] = outputShape.getStride(0);
+        params.outBatchStrides[1] = 0;
+        params.rows = inputShape[1];
+        params.cols = inputShape[2];
+        params.inRowStride = inputShape.getStride(1);
+        params.outRowStride = outputShape.getStride(1);
+        transposeMatrices(input, output, params);
+        return;
+    }
     switch (datatype) {
         case Float16:
             transpose3DImpl<float16>(input, output);
@@ -102,6 +374,20 @@ void transpose3D(Tensor* input, Tensor* output) {
 void transpose2D(Tensor* input, Tensor* output) {
     DataType datatype = input->getDataType();
     assert(input->ndims() == 2 && output->ndims() == 2);
+    if (canTransposeBlocked(input, output)) {
+        const TensorShape& inputShape = input->getShape();
+        const TensorShape& outputShape = output->getShape();
+        TransposeParams params;
+        params.batches[0] = params.batches[1] = 1;
+        params.inBatchStrides[0] = params.inBatchStrides[1] = 0;
+        params.outBatchStrides[0] = params.outBatchStrides[1] = 0;
+        params.rows = inputShape[0];
+        params.cols = inputShape[1];
+        params.inRowStride = inputShape.getStride(0);
+        params.outRowStride = outputShape.getStride(0);
+        transposeMatrices(input, output, params);
+        return;
+    }
     switch (datatype) {
         case Float16:
             transpose2DImpl<float16>(input, output);
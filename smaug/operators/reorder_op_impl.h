@@ -101,6 +101,14 @@ void transpose2DImpl(Tensor* input, Tensor* output) {
     }
 }
 
+/**
+ * The templates above are the scalar reference implementations of the
+ * reorderings. The functions below transpose Tensors whose innermost
+ * dimension is dense in cache-blocked tiles instead, with 8x8 blocks
+ * transposed in SSE registers for float32 and float16 data, and split the
+ * work across the thread pool if there is one. Other Tensors fall back to the
+ * templates.
+ */
 void convertNchwToNhwc(Tensor* input, Tensor* output);
 
 void convertNhwcToNchw(Tensor* input, Tensor* output);
@@ -1,3 +1,6 @@
+#include <chrono>
+#include <functional>
+
 #include "catch.hpp"
 #include "smaug/core/backend.h"
 #include "smaug/core/tensor.h"
@@ -93,3 +96,123 @@ TEST_CASE_METHOD(SmaugTest, "Reorder from NHWC", "[refop]") {
         verifyOutputs(outputsTensor, inputValues);
     }
 }
+
+/**
+ * Runs a reordering with both the blocked kernels and the scalar reference
+ * templates, and checks that they agree on every element.
+ */
+template <typename DType>
+static void verifyBlockedReorder(
+        SmaugTest* test,
+        const TensorShape& inputShape,
+        const TensorShape& outputShape,
+        std::function<void(Tensor*, Tensor*)> blocked,
+        std::function<void(Tensor*, Tensor*)> scalar) {
+    Tensor* input = new Tensor("input", inputShape);
+    Tensor* output = new Tensor("output", outputShape);
+    Tensor* expected = new Tensor("expected", outputShape);
+    test->workspace()->addTensor(input);
+    test->workspace()->addTensor(output);
+    test->workspace()->addTensor(expected);
+    DType* inputData = input->allocateStorage<DType>();
+    for (int i = 0; i < inputShape.storageSize(); i++)
+        inputData[i] = i % 1021;
+    output->allocateStorage<DType>();
+    expected->allocateStorage<DType>();
+    blocked(input, output);
+    scalar(input, expected);
+    DType* outputData = output->data<DType>();
+    DType* expectedData = expected->data<DType>();
+    for (auto idx = output->startIndex(); !idx.end(); ++idx)
+        REQUIRE(outputData[idx] == expectedData[idx]);
+}
+
+TEST_CASE_METHOD(SmaugTest, "Blocked reorders", "[refop]") {
+    // The sizes cross the tile and block boundaries of the kernels.
+    SECTION("NCHW to NHWC") {
+        TensorShape inputShape({ 2, 70, 9, 13 }, DataLayout::NCHW, 8);
+        TensorShape outputShape({ 2, 9, 13, 70 }, DataLayout::NHWC, 8);
+        verifyBlockedReorder<float>(this, inputShape, outputShape,
+                                    convertNchwToNhwc,
+                                    convertNchwToNhwcImpl<float>);
+        verifyBlockedReorder<float16>(this, inputShape, outputShape,
+                                      convertNchwToNhwc,
+                                      convertNchwToNhwcImpl<float16>);
+        // Without alignment, H and W are transposed as one dimension.
+        TensorShape denseShape({ 2, 70, 9, 13 }, DataLayout::NCHW);
+        verifyBlockedReorder<float>(this, denseShape, outputShape,
+                                    convertNchwToNhwc,
+                                    convertNchwToNhwcImpl<float>);
+    }
+
+    SECTION("NHWC to NCHW") {
+        TensorShape inputShape({ 2, 9, 13, 70 }, DataLayout::NHWC, 8);
+        TensorShape outputShape({ 2, 70, 9, 13 }, DataLayout::NCHW, 8);
+        verifyBlockedReorder<float>(this, inputShape, outputShape,
+                                    convertNhwcToNchw,
+                                    convertNhwcToNchwImpl<float>);
+        verifyBlockedReorder<float16>(this, inputShape, outputShape,
+                                      convertNhwcToNchw,
+                                      convertNhwcToNchwImpl<float16>);
+        verifyBlockedReorder<int>(this, inputShape, outputShape,
+                                  convertNhwcToNchw,
+                                  convertNhwcToNchwImpl<int>);
+    }
+
+    SECTION("3D transpose") {
+        TensorShape inputShape({ 3, 67, 20 }, DataLayout::NCT, 8);
+        TensorShape outputShape({ 3, 20, 67 }, DataLayout::NTC, 8);
+        verifyBlockedReorder<float>(this, inputShape, outputShape,
+                                    transpose3D, transpose3DImpl<float>);
+        verifyBlockedReorder<float16>(this, inputShape, outputShape,
+                                      transpose3D, transpose3DImpl<float16>);
+    }
+
+    SECTION("2D transpose") {
+        TensorShape inputShape({ 131, 77 }, DataLayout::NC, 8);
+        TensorShape outputShape({ 77, 131 }, DataLayout::CN, 8);
+        verifyBlockedReorder<float>(this, inputShape, outputShape,
+                                    transpose2D, transpose2DImpl<float>);
+        verifyBlockedReorder<float16>(this, inputShape, outputShape,
+                                      transpose2D, transpose2DImpl<float16>);
+    }
+}
+
+/**
+ * Times the blocked NCHW to NHWC conversion against the scalar reference
+ * template. This is hidden, so it only runs when asked for by its tag, e.g.
+ * `reorder_op_test [benchmark]`.
+ */
+template <typename DType>
+static void benchmarkNchwToNhwc(SmaugTest* test, int n, int c, int h, int w) {
+    TensorShape inputShape({ n, c, h, w }, DataLayout::NCHW, 8);
+    TensorShape outputShape({ n, h, w, c }, DataLayout::NHWC, 8);
+    Tensor* input = new Tensor("input", inputShape);
+    Tensor* output = new Tensor("output", outputShape);
+    test->workspace()->addTensor(input);
+    test->workspace()->addTensor(output);
+    input->allocateStorage<DType>();
+    output->allocateStorage<DType>();
+    const int kIterations = 20;
+    auto time = [&](std::function<void(Tensor*, Tensor*)> reorder) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kIterations; i++)
+            reorder(input, output);
+        std::chrono::duration<double, std::micro> elapsed =
+                std::chrono::steady_clock::now() - start;
+        return elapsed.count() / kIterations;
+    };
+    double scalarTime = time(convertNchwToNhwcImpl<DType>);
+    double blockedTime = time(convertNchwToNhwc);
+    std::cout << DataType_Name(ToDataType<DType>::dataType) << " " << n << "x"
+              << c << "x" << h << "x" << w << ": scalar " << scalarTime
+              << " us, blocked " << blockedTime << " us ("
+              << scalarTime / blockedTime << "x)\n";
+}
+
+TEST_CASE_METHOD(SmaugTest, "Reorder benchmark", "[.][benchmark]") {
+    benchmarkNchwToNhwc<float>(this, 1, 3, 224, 224);
+    benchmarkNchwToNhwc<float>(this, 8, 64, 56, 56);
+    benchmarkNchwToNhwc<float16>(this, 1, 3, 224, 224);
+    benchmarkNchwToNhwc<float16>(this, 8, 64, 56, 56);
+}
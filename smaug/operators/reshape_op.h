@@ -49,17 +49,36 @@ class ReshapeOp : public Operator {
     }
 
     void createAllTensors() override {
-        Tensor* input = getInput(0);
         Tensor* output = new Tensor(
                 name, TensorShape(shape, layout, Backend::Alignment));
         workspace->addTensor(output);
         outputs.at(0) = output;
+        createTensorViews();
+    }
+
+    /**
+     * If the input and output store their elements the same way, the output
+     * is made a view of the input, so no data is copied.
+     */
+    void createTensorViews() override {
+        Tensor* input = getInput(0);
+        Tensor* output = getOutput(0);
+        const TensorShape& inputShape = input->getShape();
+        const TensorShape& outputShape = output->getShape();
+        if (!output->isView() && !output->containsData() &&
+            inputShape.storageSize() == outputShape.storageSize() &&
+            inputShape.getPadding(inputShape.ndims() - 1) ==
+                    outputShape.getPadding(outputShape.ndims() - 1)) {
+            output->setView(input);
+        }
     }
 
     void run() override {
         // Copy the input data.
         Tensor* input = getInput(0);
         Tensor* output = getOutput(0);
+        if (output->getViewBase() == input)
+            return;
         const TensorShape& inputShape = input->getShape();
         const TensorShape& outputShape = output->getShape();
         int inputNumDims = input->ndims();
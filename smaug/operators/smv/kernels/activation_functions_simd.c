@@ -1,3 +1,5 @@
+#include <float.h>
+
 #include "smaug/operators/common.h"
 #include "smaug/operators/smv/kernels/load_store_fp16_data.h"
 #include "smaug/operators/smv/kernels/activation_functions_simd.h"
@@ -47,11 +49,8 @@ void smv_softmax_nc_vec_fxp(float16* host_inputs,
     for (int i = 0; i < input_num; i++) {
         // Exponentiate.
         softmax_exp:
-        for (int j = 0; j < input_vec_size; j++) {
-            softmax_exp_vec:
-            for (int k = 0; k < VECTOR_SIZE; k++)
-                _results[i][j][k] = exp(_inputs[i][j][k]);
-        }
+        for (int j = 0; j < input_vec_size; j++)
+            _results[i][j] = exp_vec_unit(_inputs[i][j]);
 
         // Compute the normalization factor.
         float normaliz = 0.0;
@@ -79,6 +78,101 @@ void smv_softmax_nc_vec_fxp(float16* host_inputs,
             results, host_results, input_num * (input_size + input_pad), 0, 0);
 }
 
+/** \ingroup AladdinKernels
+ *
+ * Softmax for inputs whose rows are too large for the scratchpads, tiled along
+ * the class dimension.
+ *
+ * This uses the online formulation of softmax. Every row keeps a running
+ * maximum m and a running denominator d = sum(exp(x - m)) in running_stats
+ * (the maximums of the input_num rows, followed by their denominators), which
+ * must stay in the scratchpad across invocations. The kernel is invoked twice
+ * per tile:
+ *
+ * 1. With normalize == 0, the tile is folded into the running statistics. If
+ *    the tile has a larger maximum, the denominator is rescaled by
+ *    exp(m_old - m_new) first. first_tile resets the statistics.
+ * 2. Once every tile of the rows has been folded in, with normalize == 1, the
+ *    tile is normalized to exp(x - m) / d and sent back to the host.
+ */
+void smv_softmax_online_nc_vec_fxp(float16* host_inputs,
+                                   float16* host_results,
+                                   float* inputs,
+                                   float* results,
+                                   float* running_stats,
+                                   int input_num,
+                                   int input_size,
+                                   int input_pad,
+                                   int first_tile,
+                                   int normalize) {
+    // Load inputs.
+    host_load_fp16(
+            inputs, host_inputs, input_num * (input_size + input_pad), 0, 0);
+
+    VEC_ARRAY_2D(v8fp_t, _inputs, inputs, input_size + input_pad);
+    VEC_ARRAY_2D(v8fp_t, _results, results, input_size + input_pad);
+    ARRAY_2D(float, _running_stats, running_stats, input_num);
+    int input_vec_size = FRAC_CEIL(input_size, VECTOR_SIZE);
+    const v8sfx_t lanes = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    const v8fp_t zero = (v8fp_t){ 0 };
+
+    softmax_online_batch:
+    for (int i = 0; i < input_num; i++) {
+        if (normalize) {
+            float max_elem = _running_stats[0][i];
+            float normaliz = 1.0 / _running_stats[1][i];
+            softmax_online_normalize:
+            for (int j = 0; j < input_vec_size; j++) {
+                v8sfx_t valid = lanes < input_size - j * VECTOR_SIZE;
+                v8fp_t elems =
+                        exp_vec_unit(_inputs[i][j] - max_elem) * normaliz;
+                _results[i][j] = VEC256_MASK(elems, valid);
+            }
+            continue;
+        }
+
+        // Find the maximum of the tile. The padding of the last vector is
+        // excluded from the reduction.
+        const v8fp_t lowest = zero - FLT_MAX;
+        v8fp_t max_vec = lowest;
+        softmax_online_max:
+        for (int j = 0; j < input_vec_size; j++) {
+            v8sfx_t valid = lanes < input_size - j * VECTOR_SIZE;
+            v8fp_t elems = select_vec_unit(valid, _inputs[i][j], lowest);
+            max_vec = select_vec_unit(elems > max_vec, elems, max_vec);
+        }
+        float max_elem = max8(max_vec[0], max_vec[1], max_vec[2], max_vec[3],
+                              max_vec[4], max_vec[5], max_vec[6], max_vec[7]);
+        float normaliz = 0;
+        if (!first_tile) {
+            float prev_max = _running_stats[0][i];
+            max_elem = max2(max_elem, prev_max);
+            normaliz = _running_stats[1][i] *
+                       exp_vec_unit(zero + (prev_max - max_elem))[0];
+        }
+
+        // Accumulate the exponentials of the tile relative to the new maximum.
+        v8fp_t sum_vec = zero;
+        softmax_online_sum:
+        for (int j = 0; j < input_vec_size; j++) {
+            v8sfx_t valid = lanes < input_size - j * VECTOR_SIZE;
+            v8fp_t elems = exp_vec_unit(_inputs[i][j] - max_elem);
+            sum_vec += VEC256_MASK(elems, valid);
+        }
+        softmax_online_sum_reduce:
+        for (int k = 0; k < VECTOR_SIZE; k++)
+            normaliz += sum_vec[k];
+        _running_stats[0][i] = max_elem;
+        _running_stats[1][i] = normaliz;
+    }
+
+    // Store results to the host memory.
+    if (normalize) {
+        host_store_fp16(results, host_results,
+                        input_num * (input_size + input_pad), 0, 0);
+    }
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
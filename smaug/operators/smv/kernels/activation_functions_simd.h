@@ -52,17 +52,60 @@ static inline void lrelu_vec(v8fp_t* inputs,
     }
 }
 
+// Selects the elements of a where the mask is set (-1) and the elements of b
+// where it is clear (0).
+ALWAYS_INLINE
+static inline v8fp_t select_vec_unit(v8sfx_t mask, v8fp_t a, v8fp_t b) {
+    return (v8fp_t)(((v8sfx_t)a & mask) | ((v8sfx_t)b & ~mask));
+}
+
+// The exponential function.
+//
+// The input is reduced to x = n * ln(2) + r, where n is an integer and
+// |r| <= ln(2) / 2, so that exp(x) = 2^n * exp(r). exp(r) is approximated with
+// the minimax polynomial of Cephes' expf, and 2^n is built directly in the
+// exponent bits. 2^n is applied in two halves so that results in the denormal
+// range and up to FLT_MAX stay representable. Over all float inputs, the
+// maximum error against libm's expf is 1 ULP. Large inputs return inf, very
+// negative inputs return 0, and NaNs are propagated.
+ALWAYS_INLINE
+static inline v8fp_t exp_vec_unit(v8fp_t a) {
+    // Beyond these bounds the result is inf or 0 anyway, and clamping keeps n
+    // in range.
+    v8fp_t zero = (v8fp_t){ 0 };
+    v8fp_t x = select_vec_unit(a > 89.0f, zero + 89.0f, a);
+    x = select_vec_unit(x < -104.0f, zero - 104.0f, x);
+
+    // n = round(x / ln(2)). The conversion truncates towards zero, so round
+    // down the elements where that rounded up.
+    v8fp_t fx = x * 1.44269504088896341f + 0.5f;
+    v8sfx_t n = __builtin_convertvector(fx, v8sfx_t);
+    n += (v8sfx_t)(__builtin_convertvector(n, v8fp_t) > fx);
+    v8fp_t fn = __builtin_convertvector(n, v8fp_t);
+
+    // r = x - n * ln(2), with ln(2) split in two for extra precision.
+    v8fp_t r = x - fn * 0.693359375f + fn * 2.12194440e-4f;
+    v8fp_t r2 = r * r;
+    v8fp_t p = zero + 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r2 + r + 1.0f;
+
+    // Scale by 2^n = 2^(n / 2) * 2^(n - n / 2).
+    v8sfx_t n_half = n >> 1;
+    v8fp_t scale0 = (v8fp_t)((n_half + 127) << 23);
+    v8fp_t scale1 = (v8fp_t)((n - n_half + 127) << 23);
+    return p * scale0 * scale1;
+}
+
 // The exponential linear activation function
 ALWAYS_INLINE
 static inline v8fp_t elu_vec_unit(v8fp_t a, float alpha) {
-    elu_unit_loop:
-    for (int i = 0; i < VECTOR_SIZE; i++) {
-        float value = a[i];
-        if (value < 0.0) {
-            a[i] = alpha * (exp(value) - 1);
-        }
-    }
-    return a;
+    v8fp_t neg = alpha * (exp_vec_unit(a) - 1.0f);
+    return select_vec_unit(a < 0.0f, neg, a);
 }
 
 ALWAYS_INLINE
@@ -79,12 +122,7 @@ static inline void elu_vec(v8fp_t* inputs,
 // The scaled exponential linear activation function
 ALWAYS_INLINE
 static inline v8fp_t selu_vec_unit(v8fp_t a, float alpha, float lambda) {
-    a = elu_vec_unit(a, alpha);
-    selu_unit_loop:
-    for (int i = 0; i < VECTOR_SIZE; i++) {
-        a[i] = lambda * a[i];
-    }
-    return a;
+    return lambda * elu_vec_unit(a, alpha);
 }
 
 ALWAYS_INLINE
@@ -100,15 +138,12 @@ static inline void selu_vec(v8fp_t* inputs,
 }
 
 // The logistic activation function
+//
+// Computed as 1 / (1 + exp(-x)), which saturates to 0 and 1 without any
+// special cases. The maximum error against 1 / (1 + expf(-x)) is 4 ULP.
 ALWAYS_INLINE
 static inline v8fp_t sigmoid_vec_unit(v8fp_t a) {
-    int i;
-    float value;
-    sigmoid_unit_loop:
-    for (i = 0; i < VECTOR_SIZE; i++) {
-        a[i] = 1.0 / (1.0 + exp(-a[i]));
-    }
-    return a;
+    return 1.0f / (1.0f + exp_vec_unit(-a));
 }
 
 ALWAYS_INLINE
@@ -121,14 +156,28 @@ static inline void sigmoid_vec(v8fp_t* inputs,
     }
 }
 
-// The hyberbolic sine activation function
+// The hyberbolic tangent activation function
+//
+// For |x| >= 0.625, this uses tanh(|x|) = 1 - 2 / (exp(2|x|) + 1) and restores
+// the sign. Closer to zero, that form loses precision to cancellation, so an
+// odd minimax polynomial (from Cephes' tanhf) is used instead. The maximum
+// error against libm's tanhf is 2 ULP.
 ALWAYS_INLINE
 static inline v8fp_t tanh_vec_unit(v8fp_t a) {
-    v8fp_t one = { 1, 1, 1, 1, 1, 1, 1, 1 };
-    v8fp_t two = { 2, 2, 2, 2, 2, 2, 2, 2 };
-    v8fp_t two_a = two * a;
-    v8fp_t sig = sigmoid_vec_unit(two_a);
-    return two * sig - one;
+    v8sfx_t neg_mask = a < 0.0f;
+    v8fp_t abs_a = select_vec_unit(neg_mask, -a, a);
+    v8fp_t large = 1.0f - 2.0f / (exp_vec_unit(2.0f * abs_a) + 1.0f);
+    large = select_vec_unit(neg_mask, -large, large);
+
+    v8fp_t zero = (v8fp_t){ 0 };
+    v8fp_t a2 = a * a;
+    v8fp_t p = zero - 5.70498872745e-3f;
+    p = p * a2 + 2.06390887954e-2f;
+    p = p * a2 - 5.37397155531e-2f;
+    p = p * a2 + 1.33314422036e-1f;
+    p = p * a2 - 3.33332819422e-1f;
+    v8fp_t small = p * a2 * a + a;
+    return select_vec_unit(abs_a < 0.625f, small, large);
 }
 
 ALWAYS_INLINE
@@ -63,9 +63,9 @@ void smv_batch_norm_post_fc_nc_vec_fxp(float16* host_inputs,
         host_load_fp16(inputs, host_inputs, inputs_size, 0, 0);
     host_load_fp16(weights, host_weights, weights_size, 0, 0);
 
-    VEC_ARRAY_2D(v8fp_t, _inputs, inputs, inputs_size + inputs_pad);
+    VEC_ARRAY_2D(v8fp_t, _inputs, inputs, inputs_acts + inputs_pad);
     VEC_ARRAY_2D(v8fp_t, _weights, weights, weights_acts + inputs_pad);
-    VEC_ARRAY_2D(v8fp_t, _results, results, inputs_size + inputs_pad);
+    VEC_ARRAY_2D(v8fp_t, _results, results, inputs_acts + inputs_pad);
 
     bn_batch:
     for (int i = 0; i < inputs_nums; i++) {
@@ -0,0 +1,59 @@
+#ifndef _OPERATORS_SMV_KERNELS_BIAS_ADD_SIMD_H_
+#define _OPERATORS_SMV_KERNELS_BIAS_ADD_SIMD_H_
+
+#include "smaug/operators/common.h"
+#include "smaug/operators/smv/kernels/params.h"
+#include "smaug/operators/smv/kernels/load_store_fp16_data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \ingroup AladdinKernels
+ *
+ * Adds a per-channel bias to the results, where the channels are the innermost
+ * dimension.
+ *
+ * The bias is small, so instead of taking up scratchpad space, it is loaded
+ * from the host one cacheline at a time into a local buffer. The host buffer
+ * must therefore be readable up to the next cacheline boundary past the last
+ * channel.
+ *
+ * @param results Local results buffer.
+ * @param host_bias Host bias buffer, with one element per channel.
+ * @param num_pixels Number of pixels (i.e. rows of channels) in the results.
+ * @param num_channels Number of channels in the results.
+ * @param channels_pad Alignment padding size on the channel dimension.
+ */
+ALWAYS_INLINE
+static inline void bias_add_vec(float* results,
+                                float16* host_bias,
+                                int num_pixels,
+                                int num_channels,
+                                int channels_pad) {
+    const int chunk_size = CACHELINE_SIZE / sizeof(float16);
+    const int chunk_vecs = chunk_size / VECTOR_SIZE;
+    v8fp_t bias[CACHELINE_SIZE / sizeof(float16) / VECTOR_SIZE];
+    VEC_ARRAY_2D(v8fp_t, _results, results, num_channels + channels_pad);
+    int num_vecs = FRAC_CEIL(num_channels, VECTOR_SIZE);
+
+    bias_chunk:
+    for (int c = 0; c < num_vecs; c += chunk_vecs) {
+        int chan = c * VECTOR_SIZE;
+        host_load_fp16((float*)bias, host_bias,
+                       min2(chunk_size, num_channels - chan), 0, chan);
+        int vecs = min2(chunk_vecs, num_vecs - c);
+        bias_pixel:
+        for (int p = 0; p < num_pixels; p++) {
+            bias_vec:
+            for (int v = 0; v < vecs; v++)
+                _results[p][c + v] += bias[v];
+        }
+    }
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif
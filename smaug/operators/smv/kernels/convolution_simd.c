@@ -5,6 +5,7 @@
 #include "smaug/operators/smv/kernels/params.h"
 #include "smaug/operators/smv/kernels/load_store_fp16_data.h"
 #include "smaug/operators/smv/kernels/activation_functions_simd.h"
+#include "smaug/operators/smv/kernels/bias_add_simd.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,6 +19,8 @@ extern "C" {
  * @param host_inputs Host inputs buffer in NHWC.
  * @param host_weights Host weights buffer in NHWC.
  * @param host_results Host results buffer in NHWC.
+ * @param host_bias Host bias buffer for the output channels of the results, or
+ *        NULL if there is no bias.
  * @param inputs Local inputs buffer in NHWC.
  * @param weights Local weights buffer in NHWC.
  * @param results Local results buffer in NHWC.
@@ -46,6 +49,18 @@ extern "C" {
  * @param read_weights Load weights from the host. Set to false if the weights
  *        can be reused from the last invocation.
  * @param send_results Send the results to the host memory if this is true.
+ * @param host_next_inputs Host inputs buffer of the next invocation, which is
+ *        prefetched while this invocation computes.
+ * @param host_next_weights Host weights buffer of the next invocation, which is
+ *        prefetched while this invocation computes.
+ * @param next_inputs Local buffer to prefetch the next inputs into. It must
+ *        not overlap the inputs buffer.
+ * @param next_weights Local buffer to prefetch the next weights into. It must
+ *        not overlap the weights buffer.
+ * @param next_inputs_size Number of elements of the next inputs to prefetch,
+ *        or zero if they are not prefetched.
+ * @param next_weights_size Number of elements of the next weights to
+ *        prefetch, or zero if they are not prefetched.
  * @param act_function Activation function the operator runs.
  * @param act_params Parameters for the activation function.
  * @param sampling Simulation samplng settings.
@@ -53,6 +68,7 @@ extern "C" {
 void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
                              float16* host_weights,
                              float16* host_results,
+                             float16* host_bias,
                              float* inputs,
                              float* weights,
                              float* results,
@@ -71,6 +87,12 @@ void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
                              bool read_inputs,
                              bool read_weights,
                              bool send_results,
+                             float16* host_next_inputs,
+                             float16* host_next_weights,
+                             float* next_inputs,
+                             float* next_weights,
+                             int next_inputs_size,
+                             int next_weights_size,
                              activation_type act_function,
                              activation_param_t act_params,
                              SamplingInfo* sampling) {
@@ -126,6 +148,14 @@ void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
         host_load_fp16(inputs, host_inputs, inputs_size, 0, 0);
     if (read_weights)
         host_load_fp16(weights, host_weights, weights_size, 0, 0);
+    // Nothing below reads the prefetched tiles, so these transfers overlap the
+    // computation.
+    if (next_inputs_size > 0)
+        host_load_fp16(next_inputs, host_next_inputs, next_inputs_size, 0, 0);
+    if (next_weights_size > 0) {
+        host_load_fp16(
+                next_weights, host_next_weights, next_weights_size, 0, 0);
+    }
 
     // Set up the sample sizes and factors.
     int pe_block_sample = num_kernel_blocks + 1;
@@ -310,7 +340,13 @@ void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
             }
         }
     }
-    // Only run activation functions when the results are finished.
+    // Only add the bias and run activation functions when the results are
+    // finished.
+    if (host_bias && send_results) {
+        bias_add_vec(results, host_bias,
+                     results_dims[0] * result_rows * result_cols,
+                     result_height, results_pad);
+    }
     if (act_function != NO_ACTIVATION && send_results) {
         activation_fun_vec(
                 results, results, results_size, act_function, act_params);
@@ -9,6 +9,12 @@ extern "C" {
 /** \ingroup AladdinKernels
  *
  * SMV implementation of elementwise multiplication.
+ *
+ * The inputs are only loaded if read_inputs is true; otherwise they were
+ * prefetched by the last invocation. If next_inputs_size is not zero, the
+ * inputs of the next invocation are prefetched from host_next_inputs0/1 into
+ * next_inputs0/1, which must not overlap inputs0/1, while this invocation
+ * computes.
  */
 void smv_eltwise_mul_nc_vec_fxp(float16* host_inputs0,
                                 float16* host_inputs1,
@@ -16,10 +22,26 @@ void smv_eltwise_mul_nc_vec_fxp(float16* host_inputs0,
                                 float* inputs0,
                                 float* inputs1,
                                 float* results,
-                                int inputs_size) {
+                                int inputs_size,
+                                bool read_inputs,
+                                float16* host_next_inputs0,
+                                float16* host_next_inputs1,
+                                float* next_inputs0,
+                                float* next_inputs1,
+                                int next_inputs_size) {
     // Load inputs.
-    host_load_fp16(inputs0, host_inputs0, inputs_size, 0, 0);
-    host_load_fp16(inputs1, host_inputs1, inputs_size, 0, 0);
+    if (read_inputs) {
+        host_load_fp16(inputs0, host_inputs0, inputs_size, 0, 0);
+        host_load_fp16(inputs1, host_inputs1, inputs_size, 0, 0);
+    }
+    // Nothing below reads the prefetched inputs, so these transfers overlap
+    // the computation.
+    if (next_inputs_size > 0) {
+        host_load_fp16(
+                next_inputs0, host_next_inputs0, next_inputs_size, 0, 0);
+        host_load_fp16(
+                next_inputs1, host_next_inputs1, next_inputs_size, 0, 0);
+    }
 
     VEC_ARRAY_1D(v8fp_t, _inputs0, inputs0);
     VEC_ARRAY_1D(v8fp_t, _inputs1, inputs1);
@@ -5,6 +5,7 @@
 #include "smaug/operators/smv/kernels/params.h"
 #include "smaug/operators/smv/kernels/load_store_fp16_data.h"
 #include "smaug/operators/smv/kernels/activation_functions_simd.h"
+#include "smaug/operators/smv/kernels/bias_add_simd.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,12 +27,14 @@ extern "C" {
  *  assigned a row in in the transposed matrix. It continues across each row of
  *  b until the complete output pixel is finished (output stationary).
  *
- *  No biases are added.
+ *  If host_bias is not NULL, a per-neuron bias is added to the finished results.
  *
  * Args:
  * @param host_a Host buffer for a in NC.
  * @param host_b Host buffer for b in NC.
  * @param host_results Host results buffer in NC.
+ * @param host_bias Host bias buffer for the neurons of the results, or NULL if
+ *        there is no bias.
  * @param a Local buffer for a in NC.
  * @param b Local buffer for b in NC.
  * @param results Local results buffer in NC.
@@ -51,7 +54,21 @@ extern "C" {
  *        for knon-first b tiles.
  * @param read_inputs Load inputs from the host. Set to false if the input
  *        activations can be reused from the last invocation.
+ * @param read_weights Load b from the host. Set to false if b can be reused
+ *        from the last invocation.
  * @param send_results Send the results to the host memory if this is true.
+ * @param host_next_a Host buffer for a of the next invocation, which is
+ *        prefetched while this invocation computes.
+ * @param host_next_b Host buffer for b of the next invocation, which is
+ *        prefetched while this invocation computes.
+ * @param next_a Local buffer to prefetch the next a into. It must not overlap
+ *        a.
+ * @param next_b Local buffer to prefetch the next b into. It must not overlap
+ *        b.
+ * @param next_a_size Number of elements of the next a to prefetch, or zero if
+ *        it is not prefetched.
+ * @param next_b_size Number of elements of the next b to prefetch, or zero if
+ *        it is not prefetched.
  * @param act_function Activation function the operator runs.
  * @param act_params Parameters for the activation function.
  * @param sampling Simulation samplng settings.
@@ -59,6 +76,7 @@ extern "C" {
 void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
                                               float16* host_b,
                                               float16* host_results,
+                                              float16* host_bias,
                                               float* a,
                                               float* b,
                                               float* results,
@@ -72,7 +90,14 @@ void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
                                               int result_start,
                                               bool accumulate,
                                               bool read_inputs,
+                                              bool read_weights,
                                               bool send_results,
+                                              float16* host_next_a,
+                                              float16* host_next_b,
+                                              float* next_a,
+                                              float* next_b,
+                                              int next_a_size,
+                                              int next_b_size,
                                               activation_type act_function,
                                               activation_param_t act_params,
                                               SamplingInfo* sampling) {
@@ -99,7 +124,14 @@ void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
     // Load a and b if needed.
     if (read_inputs)
         host_load_fp16(a, host_a, a_size, 0, 0);
-    host_load_fp16(b, host_b, b_size, 0, 0);
+    if (read_weights)
+        host_load_fp16(b, host_b, b_size, 0, 0);
+    // Nothing below reads the prefetched tiles, so these transfers overlap the
+    // computation.
+    if (next_a_size > 0)
+        host_load_fp16(next_a, host_next_a, next_a_size, 0, 0);
+    if (next_b_size > 0)
+        host_load_fp16(next_b, host_next_b, next_b_size, 0, 0);
 
     // We sample on the FC kernel only if the highest sampling level is used.
     int b_col_sample = b_width_vec;
@@ -196,7 +228,12 @@ void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
             }
         }
     }
-    // Only run activation functions when the results are finished.
+    // Only add the bias and run activation functions when the results are
+    // finished.
+    if (host_bias && send_results) {
+        bias_add_vec(results, host_bias, results_height, results_width,
+                     results_pad);
+    }
     if (act_function != NO_ACTIVATION && send_results) {
         activation_fun_vec(
                 results, results, results_size, act_function, act_params);
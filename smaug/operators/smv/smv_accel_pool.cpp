@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 
 #include "smaug/operators/common.h"
@@ -7,10 +8,12 @@
 namespace smaug {
 
 SmvAcceleratorPool::SmvAcceleratorPool(int _size)
-        : size(_size), finishFlags(_size) {}
+        : size(_size), finishFlags(_size), busyUntil(_size, 0), hostTime(0),
+          lastAccelIdx(_size - 1) {}
 
 void SmvAcceleratorPool::addFinishFlag(
         int accelIdx, std::unique_ptr<volatile int> finishFlag) {
+    busyUntil[accelIdx] = std::max(busyUntil[accelIdx], hostTime) + 1;
     if (runningInSimulation) {
         finishFlags[accelIdx].push_back(std::move(finishFlag));
     }
@@ -33,14 +36,33 @@ void SmvAcceleratorPool::joinAll() {
     dout(1) << "Waiting for all accelerators to finish.\n";
     for (int i = 0; i < size; i++)
         join(i);
+    hostTime = std::max(hostTime,
+                        *std::max_element(busyUntil.begin(), busyUntil.end()));
     dout(1) << "All accelerators finished.\n";
 }
 
-int SmvAcceleratorPool::getNextAvailableAccelerator(int currAccelIdx) {
-    // Round-robin policy.
-    int pickedAccel = currAccelIdx + 1;
-    if (pickedAccel == size)
-        pickedAccel = 0;
+int SmvAcceleratorPool::getNextAvailableAccelerator(
+        const std::function<int(int)>& getResidentBytes) {
+    // If every accelerator is busy, the host waits for the first one to
+    // finish.
+    int readyTime = std::max(
+            hostTime, *std::min_element(busyUntil.begin(), busyUntil.end()));
+    // Of the idle accelerators, pick the one holding the most data. Visiting
+    // them in round-robin order breaks the ties the round-robin way.
+    int pickedAccel = -1;
+    int pickedBytes = -1;
+    for (int i = 1; i <= size; i++) {
+        int accelIdx = (lastAccelIdx + i) % size;
+        if (busyUntil[accelIdx] > readyTime)
+            continue;
+        int bytes = getResidentBytes ? getResidentBytes(accelIdx) : 0;
+        if (bytes > pickedBytes) {
+            pickedAccel = accelIdx;
+            pickedBytes = bytes;
+        }
+    }
+    hostTime = readyTime;
+    lastAccelIdx = pickedAccel;
     // If the picked accelerator has not finished, wait until it returns.
     join(pickedAccel);
     if (size > 1)
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <deque>
+#include <functional>
 #include <memory>
 
 namespace smaug {
@@ -12,19 +13,28 @@ namespace smaug {
  *
  * For operators that require work tiling, tiles can be distributed across
  * multiple accelerators to exploit parallelism. This class implements a
- * deterministic round-robin worker pool. Determinism is required because when
- * generating multiple dynamic traces, worker accelerator assignments must
- * match with simulation of the binary in gem5.
+ * deterministic worker pool. Determinism is required because when generating
+ * multiple dynamic traces, worker accelerator assignments must match with
+ * simulation of the binary in gem5.
+ *
+ * The pool picks accelerators by readiness and data affinity. To keep the
+ * decisions deterministic, readiness is not polled from the hardware. Instead,
+ * the pool models every accelerator as busy for one time unit per kernel
+ * invocation it was given, and the host as waiting whenever it has to join an
+ * accelerator. Of the accelerators that are idle in this model, the one that
+ * already holds the most data of the next work is picked. Remaining ties go to
+ * the accelerator next in round-robin order, so uniform work without affinity
+ * is still assigned round-robin.
  *
  * To use:
  *
  * ```c
  * SmvAcceleratorPool pool(size);
- * int currAccel = 0;
  * for (int i = 0; i < tiles; i++) {
+ *    int currAccel = pool.getNextAvailableAccelerator(
+ *            [&](int accelIdx) { return bytesOfTileHeldBy(i, accelIdx); });
  *    volatile int* finishFlag = invokeKernelNoBlock(currAccel, redCode, kernel, args...);
  *    pool.addFinishFlag(currAccel, std::make_unique(finishFlag));
- *    currAccel = pool.getNextAvailableAccelerator(currAccel);
  * }
  * pool.joinAll();
  * ```
@@ -40,17 +50,14 @@ class SmvAcceleratorPool {
     void joinAll();
 
     /**
-     * Get the next accelerator and wait if it's still busy. A round-robin
-     * scheduling policy is used for picking the accelerator. The simple static
-     * policy is used because the scheduling decisions need to be the same as
-     * when we generate the traces, whereas dynamic decisions that depend on
-     * runtime information may lead to mismatch between the traces and the
-     * simulation.
+     * Get the accelerator to run the next work on and wait if it's still busy.
      *
-     * TODO(xyzsam): the pool should be able to keep track of the current
-     * accelerator index on its own.
+     * @param getResidentBytes Returns the number of bytes of the next work's
+     * data that are already in the scratchpads of the given accelerator. If not
+     * provided, no accelerator is preferred for its data.
      */
-    int getNextAvailableAccelerator(int currAccelIdx);
+    int getNextAvailableAccelerator(
+            const std::function<int(int)>& getResidentBytes = nullptr);
 
    protected:
     /** Wait until this accelerator's finish flags turn complete. */
@@ -61,6 +68,15 @@ class SmvAcceleratorPool {
 
     /** Active finish flags for all the accelerators in the pool. */
     std::vector<std::deque<std::unique_ptr<volatile int>>> finishFlags;
+
+    /** The modeled time at which every accelerator finishes its work. */
+    std::vector<int> busyUntil;
+
+    /** The modeled time of the host. */
+    int hostTime;
+
+    /** The accelerator picked last. */
+    int lastAccelIdx;
 };
 
 }  // namespace smaug
@@ -0,0 +1,55 @@
+#include "catch.hpp"
+#include "smaug/core/smaug_test.h"
+#include "smaug/operators/smv/smv_accel_pool.h"
+
+using namespace smaug;
+
+// Dispatches the given number of kernel invocations to the accelerator.
+static void dispatch(SmvAcceleratorPool& pool, int accelIdx, int invocations) {
+    for (int i = 0; i < invocations; i++)
+        pool.addFinishFlag(accelIdx, nullptr);
+}
+
+TEST_CASE_METHOD(SmaugTest, "SMV accelerator pool", "[smvpool]") {
+    SECTION("Uniform work is assigned round-robin") {
+        SmvAcceleratorPool pool(3);
+        for (int expected : { 0, 1, 2, 0, 1, 2, 0 }) {
+            int accelIdx = pool.getNextAvailableAccelerator();
+            REQUIRE(accelIdx == expected);
+            dispatch(pool, accelIdx, 2);
+        }
+    }
+
+    SECTION("The accelerator that frees up first is picked") {
+        SmvAcceleratorPool pool(2);
+        REQUIRE(pool.getNextAvailableAccelerator() == 0);
+        dispatch(pool, 0, 4);
+        REQUIRE(pool.getNextAvailableAccelerator() == 1);
+        dispatch(pool, 1, 1);
+        // Accelerator 0 still has 3 invocations to go, so accelerator 1 is
+        // used again instead of waiting for accelerator 0.
+        REQUIRE(pool.getNextAvailableAccelerator() == 1);
+        dispatch(pool, 1, 1);
+        REQUIRE(pool.getNextAvailableAccelerator() == 1);
+        dispatch(pool, 1, 4);
+        REQUIRE(pool.getNextAvailableAccelerator() == 0);
+    }
+
+    SECTION("Idle accelerators holding the data are preferred") {
+        SmvAcceleratorPool pool(3);
+        // Accelerator 2 holds the most data of the next work.
+        std::vector<int> residentBytes = { 0, 128, 256 };
+        auto getResidentBytes = [&](int accelIdx) {
+            return residentBytes[accelIdx];
+        };
+        REQUIRE(pool.getNextAvailableAccelerator(getResidentBytes) == 2);
+        dispatch(pool, 2, 1);
+        // Accelerator 2 is now busy, so the next best one is picked.
+        REQUIRE(pool.getNextAvailableAccelerator(getResidentBytes) == 1);
+        dispatch(pool, 1, 1);
+        REQUIRE(pool.getNextAvailableAccelerator(getResidentBytes) == 0);
+        dispatch(pool, 0, 1);
+        // All of them finish at the same time.
+        REQUIRE(pool.getNextAvailableAccelerator(getResidentBytes) == 2);
+    }
+}
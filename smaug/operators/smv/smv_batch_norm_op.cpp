@@ -67,7 +67,11 @@ void SmvBatchNormOp::runNA(TiledTensor& inputs,
             // Otherwise, we start from the last place we left off from.
             int actStart = (iC == wC) ? 0 : actOffset;
             // Send the results back to host memory when we finish the weights.
-            bool sendOutputs = iC == wC || wC == weightActTiles - 1;
+            // The kernel converts the results to FP16 in place when it stores
+            // them, so partial results must not be sent while the same input
+            // tile is still being processed by the next weight tile.
+            bool sendOutputs = inputActTiles == weightActTiles ||
+                               wC == weightActTiles - 1;
 
             invokeKernel(smv::kBatchNormHw, smv_batch_norm_post_fc_nc_vec_fxp,
                          inputTile->data<float16>(),
@@ -123,13 +127,13 @@ void SmvBatchNormOp::runNHWC(TiledTensor& inputs,
                 smv::kBatchNormHw + i, "host_results", getOutputsMemType());
     }
     SmvAcceleratorPool accelPool(numAcceleratorsAvailable);
-    int currAccelIdx = 0;
     for (int N = 0; N < inputNumTiles; N++) {
         for (int H = 0; H < inputRowTiles; H++) {
             for (int W = 0; W < inputColTiles; W++) {
                 // This keeps track of the channel offset of the inputs.
                 int ifmapOffset = 0;
                 for (int C = 0; C < inputChanTiles; C++) {
+                    int currAccelIdx = accelPool.getNextAvailableAccelerator();
                     int inputTileIdx = inputIdx(N, H, W, C);
                     int outputTileIdx = outputIdx(N, H, W, C);
                     dout(1) << "Input: " << inputTileIdx << ", Weight: 0"
@@ -164,8 +168,6 @@ void SmvBatchNormOp::runNHWC(TiledTensor& inputs,
                     accelPool.addFinishFlag(
                             currAccelIdx, std::move(finishFlag));
                     ifmapOffset += inputShape[3];
-                    currAccelIdx =
-                            accelPool.getNextAvailableAccelerator(currAccelIdx);
                 }
             }
         }
@@ -205,14 +207,18 @@ void SmvBatchNormOp::run() {
         tiledTensors[1].copyDataToAllTiles();
     }
 
-    if (isPostConv) {
-        assert(inputShape.getLayout() == DataLayout::NHWC);
-        assert(outputShape.getLayout() == DataLayout::NHWC);
-        runNHWC(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
-    } else {
-        assert(inputShape.getLayout() == DataLayout::NC);
-        assert(outputShape.getLayout() == DataLayout::NC);
-        runNA(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    {
+        auto profile = ScopedProfile(
+                profile::kKernelDispatch, profile::kPhase);
+        if (isPostConv) {
+            assert(inputShape.getLayout() == DataLayout::NHWC);
+            assert(outputShape.getLayout() == DataLayout::NHWC);
+            runNHWC(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+        } else {
+            assert(inputShape.getLayout() == DataLayout::NC);
+            assert(outputShape.getLayout() == DataLayout::NC);
+            runNA(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+        }
     }
 
     {
@@ -113,3 +113,10 @@ TEST_CASE_METHOD(SmvBatchNormOpTest,
     SECTION("No tiling required") { doFusionTest({ 1, 1024 }); }
     SECTION("DimNC required") { doFusionTest({ 1, 32768 }); }
 }
+
+TEST_CASE_METHOD(SmvBatchNormOpTest,
+                 "SMV Post-FC Batch Norm with batched inputs",
+                 "[smvpool]") {
+    SECTION("No tiling required") { doTest({ 4, 1024 }); }
+    SECTION("DimN and weight tiling") { doTest({ 8, 8192 }); }
+}
@@ -4,6 +4,7 @@
 #include "smaug/operators/common.h"
 #include "smaug/operators/smv/smv_batch_norm_op.h"
 #include "smaug/operators/smv/smv_batch_norm_tiling.h"
+#include "smaug/operators/smv/smv_tiling_cache.h"
 #include "smaug/utility/debug_stream.h"
 
 namespace smaug {
@@ -267,8 +268,12 @@ std::array<TiledTensor, 3> TilingOptimizer::doTiling(SmvBatchNormOp* op) {
     auto weights = concatTensors(
             { mean, variance, gamma, beta }, 0, op->getWorkspace());
     auto outputs = op->getOutput(SmvBatchNormOp::Outputs);
-    TilingConfig tileConfig =
-            TilingOptimizer::computeBasicTileShapes(inputs, weights, outputs);
+    TilingConfig tileConfig = findOrComputeTilingConfig(
+            getTilingPlanKey(op, { inputs, weights, outputs }),
+            [&]() {
+                return TilingOptimizer::computeBasicTileShapes(
+                        inputs, weights, outputs);
+            });
     TiledTensor tiledInputs =
             generateTiledTensor(inputs, tileConfig.inputs, op);
     // Copy data for the weight tiles since the data is read-only.
@@ -4,6 +4,7 @@
 #include "smaug/operators/smv/smv_convolution_tiling.h"
 #include "smaug/operators/smv/smv_kernels.h"
 #include "smaug/operators/smv/smv_accel_pool.h"
+#include "smaug/operators/smv/smv_spad_buffers.h"
 #include "smaug/utility/debug_stream.h"
 
 namespace smaug {
@@ -37,8 +38,17 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
     unsigned accelId = useSystolicArrayWhenAvailable ? smv::kSystolicArrayHw
                                                      : smv::kConvolutionHw;
     SmvAcceleratorPool accelPool(numAcceleratorsAvailable);
-    std::vector<int> lastReadInputTileIdx(numAcceleratorsAvailable, -1);
-    std::vector<int> lastReadWeightTileIdx(numAcceleratorsAvailable, -1);
+    // With double buffering, every invocation prefetches the tiles of the
+    // next invocation on the same accelerator into the other buffers of its
+    // spads. The systolic array has its own scratchpads, which are not
+    // double-buffered.
+    int numBuffers = useSystolicArrayWhenAvailable
+                             ? 1
+                             : SmvSpadBuffers::getNumBuffers();
+    std::vector<SmvSpadBuffers> inputBuffers(
+            numAcceleratorsAvailable, SmvSpadBuffers(smv::spad0, numBuffers));
+    std::vector<SmvSpadBuffers> weightBuffers(
+            numAcceleratorsAvailable, SmvSpadBuffers(smv::spad1, numBuffers));
     for (int i = 0; i < numAcceleratorsAvailable; i++) {
         setArrayMemTypeIfSimulating(
                 accelId + i, "host_inputs", getInputsMemType());
@@ -46,8 +56,77 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                 accelId + i, "host_weights", getWeightsMemType());
         setArrayMemTypeIfSimulating(
                 accelId + i, "host_results", getOutputsMemType());
+        setArrayMemTypeIfSimulating(
+                accelId + i, "host_next_inputs", getInputsMemType());
+        setArrayMemTypeIfSimulating(
+                accelId + i, "host_next_weights", getWeightsMemType());
+        if (bias) {
+            setArrayMemTypeIfSimulating(
+                    accelId + i, "host_bias", getWeightsMemType());
+        }
+    }
+    // The starting output channel of every channelwise output tile, which
+    // locates the bias of the tile.
+    float16* biasData = bias ? bias->data<float16>() : nullptr;
+    std::vector<int> outputChanOffsets(outputChanTiles, 0);
+    for (int C = 1; C < outputChanTiles; C++) {
+        Tensor* prevTile = outputs[outputIdx(0, 0, 0, C - 1)];
+        outputChanOffsets[C] = outputChanOffsets[C - 1] + prevTile->getShape()[3];
     }
-    int currAccelIdx = 0;
+    // The tiling optimizer will make sure that the weight tiles have the same
+    // channel dimension as the input tiles (so that inputChanTiles =
+    // weightChanTiles), except one case where the input is not tiled
+    // channelwise (inputChanTiles = 1) and the weights are independently
+    // tiled channelwise. In that case, we will need multiple kernel
+    // invocations to finish the weight channelwise tiles, with the same input
+    // channel tile, producing results for the same output channels. These are
+    // the (iC, wC) channelwise tiles that every output tile goes through.
+    std::vector<std::pair<int, int>> chanTiles;
+    if (inputChanTiles == weightChanTiles) {
+        for (int C = 0; C < weightChanTiles; C++)
+            chanTiles.emplace_back(C, C);
+    } else if (inputChanTiles == 1) {
+        for (int wC = 0; wC < weightChanTiles; wC++)
+            chanTiles.emplace_back(0, wC);
+    } else {
+        assert(false && "The input/weight tiles can have different "
+                        "number of channels only when the inputs "
+                        "don't need channelwise tiling.");
+    }
+    // This is the number of invocations we need to finish a weight tile. In
+    // common scenarios, only one invocation is needed. If we need to iterate
+    // the output channels, outputChanTiles invocatons are needed to finish the
+    // weight tile (see needOutputIteration below).
+    int numOutputInvocations =
+            weightOfmapTiles < outputChanTiles ? outputChanTiles : 1;
+    // Finds the input and weight tiles of the invocation that follows the
+    // invocation on the t-th channelwise tiles of output channel invocation oC
+    // of the (N, H, W) work, on the same accelerator. The next (N, H, W) work
+    // may run on another accelerator, so it is only followed if there is just
+    // one. Returns false if there is no such invocation.
+    auto findNextTiles = [&](int N, int H, int W, int oC, int t,
+                             int* nextInputTileIdx, int* nextWeightTileIdx) {
+        if (t + 1 < chanTiles.size()) {
+            t++;
+        } else if (oC + 1 < numOutputInvocations) {
+            t = 0;
+        } else if (numAcceleratorsAvailable == 1) {
+            t = 0;
+            if (++W == weightOfmapTiles) {
+                W = 0;
+                if (++H == outputRowTiles) {
+                    H = 0;
+                    if (++N == inputIfmapTiles)
+                        return false;
+                }
+            }
+        } else {
+            return false;
+        }
+        *nextInputTileIdx = inputIdx(N, H, 0, chanTiles[t].first);
+        *nextWeightTileIdx = weightIdx(W, 0, 0, chanTiles[t].second);
+        return true;
+    };
     for (int N = 0; N < inputIfmapTiles; N++) {
         for (int H = 0; H < outputRowTiles; H++) {
             int currentTileTopPad = topPad;
@@ -76,12 +155,6 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
             // kernel from which the weight tile will be effective.
             bool needOutputIteration = weightOfmapTiles < outputChanTiles;
             int kernStart = 0;
-            // This is the number of invocations we need to finish the weight
-            // tile. In common scenarios, only one invocation is needed. If we
-            // need to iterate the output channels, outputChanTiles invocatons
-            // are needed to finish the weight tile.
-            int numOutputInvocations =
-                    needOutputIteration ? outputChanTiles : 1;
             assert(numOutputInvocations > 1
                            ? weightOfmapTiles == 1
                            : weightOfmapTiles == outputChanTiles);
@@ -101,8 +174,29 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                 // thus exhibiting data dependency, whereas the former could run
                 // in parallel technically, but we will need to reload too much
                 // weights for that and therefore I choose not to.
+                //
+                // Prefer the accelerator that already holds the first input
+                // and weight tiles of this work.
+                int firstInputTileIdx = inputIdx(N, H, 0, 0);
+                int firstWeightTileIdx = weightIdx(W, 0, 0, 0);
+                int currAccelIdx = accelPool.getNextAvailableAccelerator(
+                        [&](int accelIdx) {
+                            int bytes = 0;
+                            if (inputBuffers[accelIdx].holdsTile(
+                                        firstInputTileIdx)) {
+                                bytes += inputs[firstInputTileIdx]
+                                                 ->getShape()
+                                                 .storageSize();
+                            }
+                            if (weightBuffers[accelIdx].holdsTile(
+                                        firstWeightTileIdx)) {
+                                bytes += weights[firstWeightTileIdx]
+                                                 ->getShape()
+                                                 .storageSize();
+                            }
+                            return bytes * (int)sizeof(float16);
+                        });
                 for (int oC = 0; oC < numOutputInvocations; oC++) {
-                    int iC = 0, wC = 0;
                     // This keeps track of the channel offset of the input.
                     int ifmapOffset = 0;
                     int outputTileIdx = outputIdx(N, H, 0, W + oC);
@@ -112,17 +206,17 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                             accelId + currAccelIdx, "host_results",
                             outputTile->data<float16>(),
                             outputShape.storageSize() * sizeof(float16));
+                    float16* outputBias = nullptr;
+                    if (bias) {
+                        outputBias = biasData + outputChanOffsets[W + oC];
+                        mapArrayToAccel(accelId + currAccelIdx, "host_bias",
+                                        outputBias,
+                                        outputShape[3] * sizeof(float16));
+                    }
 
-                    // The tiling optimizer will make sure that the weight tiles
-                    // have the same channel dimension as the input tiles (so
-                    // that inputChanTiles = weightChanTiles), except one case
-                    // where the input is not tiled channelwise (inputChanTiles
-                    // = 1) and the weights are independently tiled channelwise.
-                    // In that case, we will need multiple kernel invocations to
-                    // finish the weight channelwise tiles, with the same input
-                    // channel tile, producing results for the same output
-                    // channels.
-                    while (iC < inputChanTiles && wC < weightChanTiles) {
+                    for (int t = 0; t < chanTiles.size(); t++) {
+                        int iC = chanTiles[t].first;
+                        int wC = chanTiles[t].second;
                         int inputTileIdx = inputIdx(N, H, 0, iC);
                         int weightTileIdx = weightIdx(W, 0, 0, wC);
                         dout(1) << "Input: " << inputTileIdx
@@ -161,27 +255,58 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                         // weight channelwise tiles.
                         bool accumulate = wC > 0;
                         // If this is a new input/weight tile, then we need to
-                        // read it.
-                        bool readInputs = false;
-                        if (inputTileIdx !=
-                            lastReadInputTileIdx[currAccelIdx]) {
-                            readInputs = true;
-                            lastReadInputTileIdx[currAccelIdx] = inputTileIdx;
-                        }
-                        bool readWeights = false;
-                        if (weightTileIdx !=
-                            lastReadWeightTileIdx[currAccelIdx]) {
-                            readWeights = true;
-                            lastReadWeightTileIdx[currAccelIdx] = weightTileIdx;
-                        }
+                        // read it, unless it was prefetched.
+                        bool readInputs, readWeights;
+                        float* inputSpad =
+                                inputBuffers[currAccelIdx].getBufferForTile(
+                                        inputTileIdx, &readInputs);
+                        float* weightSpad =
+                                weightBuffers[currAccelIdx].getBufferForTile(
+                                        weightTileIdx, &readWeights);
                         // If we reach the last invocation for the weight
                         // channelwise tiles, the results are finished and need
                         // to be sent back to the host.
                         bool sendResults = wC == weightChanTiles - 1;
 
+                        float16* nextInputs = nullptr;
+                        float16* nextWeights = nullptr;
+                        float* nextInputSpad = nullptr;
+                        float* nextWeightSpad = nullptr;
+                        int nextInputSize = 0, nextWeightSize = 0;
+                        int nextInputTileIdx, nextWeightTileIdx;
+                        if (findNextTiles(N, H, W, oC, t, &nextInputTileIdx,
+                                          &nextWeightTileIdx)) {
+                            nextInputSpad =
+                                    inputBuffers[currAccelIdx].prefetchTile(
+                                            nextInputTileIdx);
+                            nextWeightSpad =
+                                    weightBuffers[currAccelIdx].prefetchTile(
+                                            nextWeightTileIdx);
+                        }
+                        if (nextInputSpad) {
+                            Tensor* tile =
+                                    inputs.getTileWithData(nextInputTileIdx);
+                            nextInputs = tile->data<float16>();
+                            nextInputSize = tile->getShape().storageSize();
+                            mapArrayToAccel(accelId + currAccelIdx,
+                                            "host_next_inputs", nextInputs,
+                                            nextInputSize * sizeof(float16));
+                        }
+                        if (nextWeightSpad) {
+                            Tensor* tile =
+                                    weights.getTileWithData(nextWeightTileIdx);
+                            nextWeights = tile->data<float16>();
+                            nextWeightSize = tile->getShape().storageSize();
+                            mapArrayToAccel(accelId + currAccelIdx,
+                                            "host_next_weights", nextWeights,
+                                            nextWeightSize * sizeof(float16));
+                        }
+
                         std::unique_ptr<volatile int> finishFlag;
                         if (useSystolicArrayWhenAvailable) {
                             // Invoke the systolic array if specified.
+                            assert(!bias && "The systolic array does not "
+                                            "support biases!");
                             finishFlag = invokeSystolicArrayKernel(
                                     accelId + currAccelIdx,
                                     inputTile->data<float16>(),
@@ -201,38 +326,28 @@ void SmvConvolutionOp::runNHWC(TiledTensor& inputs,
                                     smv_conv3d_nhwc_vec_fxp,
                                     inputTile->data<float16>(),
                                     weightsTile->data<float16>(),
-                                    outputTile->data<float16>(), smv::spad0,
-                                    smv::spad1, smv::spad2, inputDims,
-                                    weightsDims, outputDims,
+                                    outputTile->data<float16>(), outputBias,
+                                    inputSpad, weightSpad, smv::spad2,
+                                    inputDims, weightsDims, outputDims,
                                     inputShape.getPadding(3),
                                     weightsShape.getPadding(3),
                                     outputShape.getPadding(3), inputHaloPad,
                                     getRowStride(), getColStride(), ifmapStart,
                                     kernStart, accumulate, readInputs,
-                                    readWeights, sendResults, actInfo.function,
-                                    actInfo.params, &sampling);
+                                    readWeights, sendResults, nextInputs,
+                                    nextWeights, nextInputSpad, nextWeightSpad,
+                                    nextInputSize, nextWeightSize,
+                                    actInfo.function, actInfo.params,
+                                    &sampling);
                         }
                         accelPool.addFinishFlag(
                                 currAccelIdx, std::move(finishFlag));
 
                         ifmapOffset += weightsTile->getShape()[3];
-                        if (inputChanTiles == weightChanTiles) {
-                            iC++;
-                            wC++;
-                        } else if (inputChanTiles == 1) {
-                            wC++;
-                        } else {
-                            assert(false &&
-                                   "The input/weight tiles can have different "
-                                   "number of channels only when the inputs "
-                                   "don't need channelwise tiling.");
-                        }
                     }
                     if (needOutputIteration)
                         kernStart += outputShape[3];
                 }
-                currAccelIdx =
-                        accelPool.getNextAvailableAccelerator(currAccelIdx);
             }
         }
     }
@@ -296,14 +411,28 @@ std::unique_ptr<volatile int> SmvConvolutionOp::invokeSystolicArrayKernel(
 void SmvConvolutionOp::tile() {
     // This function will tile (if necessary) the input/weight/output tensors
     // of the convolution operator into smaller tensor tiles so that each tile
-    // can fit in the corresponding scratchpad of the accelerator.
-    // TODO: A lot of networks have back to back convolutional layers, it would
-    // be much more efficient not to retile in between them. That can be
-    // achieved by directly sending the output tiles to the next convolutional
-    // layer instead of merging them into a single output tensor first. It's
-    // sort of operator fusing that two back-to-back convolution operators are
-    // tiled only once.
+    // can fit in the corresponding scratchpad of the accelerator. When back to
+    // back convolutions end up with the same tiling for the tensor between
+    // them, the scheduler hands the output tiles of the first one directly to
+    // the second one (see useTiledInput()).
     tiledTensors = smaug::smv::conv::TilingOptimizer::doTiling(this);
+    untileOutputs = true;
+}
+
+TiledTensor* SmvConvolutionOp::getTiledOutput(int index) {
+    if (index != Outputs || !tiledTensors[2].containsData())
+        return nullptr;
+    return &tiledTensors[2];
+}
+
+bool SmvConvolutionOp::useTiledInput(int index, TiledTensor* tiles) {
+    if (index != Inputs || !tiledTensors[0].hasSameTiling(*tiles))
+        return false;
+    // The producer writes its results into the tiles before this operator
+    // runs, so there is nothing to copy from the input tensor.
+    tiledTensors[0] = *tiles;
+    tiledTensors[0].setDataFilled();
+    return true;
 }
 
 void SmvConvolutionOp::run() {
@@ -325,12 +454,17 @@ void SmvConvolutionOp::run() {
         tiledTensors[1].copyDataToAllTiles();
     }
 
-    runNHWC(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    {
+        auto profile = ScopedProfile(
+                profile::kKernelDispatch, profile::kPhase);
+        runNHWC(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    }
 
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorFinalStart, stats::kTensorFinalEnd);
-        tiledTensors[2].untile();
+        if (untileOutputs)
+            tiledTensors[2].untile();
     }
 }
 
@@ -29,6 +29,9 @@ class SmvConvolutionOp : public ConvolutionOp<SmvBackend> {
     using ConvolutionOp<SmvBackend>::ConvolutionOp;
     void tile() override;
     void run() override;
+    TiledTensor* getTiledOutput(int index) override;
+    bool useTiledInput(int index, TiledTensor* tiles) override;
+    void skipOutputUntile(int index) override { untileOutputs = false; }
     friend class smv::conv::TilingOptimizer;
 
   protected:
@@ -60,6 +63,11 @@ class SmvConvolutionOp : public ConvolutionOp<SmvBackend> {
            ActivationInfo* actInfo);
 
    std::array<TiledTensor, 3> tiledTensors;
+   /**
+    * False if all the consumers of the output read the output tiles directly,
+    * so they are not gathered into the output tensor.
+    */
+   bool untileOutputs = true;
 };
 
 }  // namespace smaug
@@ -1,6 +1,9 @@
+#include <algorithm>
+
 #include "catch.hpp"
 #include "smaug/core/backend.h"
 #include "smaug/core/tensor.h"
+#include "smaug/core/scheduler.h"
 #include "smaug/core/smaug_test.h"
 #include "smaug/operators/smv/smv_test_common.h"
 #include "smaug/operators/smv/smv_convolution_op.h"
@@ -58,6 +61,40 @@ class SmvConvolutionOpTest : public SmaugTest {
         verifyOutputs<float16>(outputs, refOutputs);
     }
 
+    // Runs the convolution with double-buffered spads, which halves the
+    // tiles, and compares the outputs against the single-buffered ones.
+    void doDoubleBufferTest(std::vector<int> inputDims,
+                            std::vector<int> kernelDims) {
+        auto convOp = new SmvConvolutionOp("conv", workspace());
+        convOp->setStride(1, 1);
+        convOp->setPadding(SamePadding);
+        TensorShape inputShape(inputDims, NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("input", inputShape);
+        inputs->allocateStorage<float16>();
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->setWeightDims(kernelDims[1], kernelDims[2], kernelDims[0]);
+        createAndFillTensorsWithData<float16>(convOp, fillTensorWithRandomData);
+        convOp->tile();
+        convOp->run();
+
+        useDoubleBufferedSpads = true;
+        auto doubleBufferedConvOp =
+                new SmvConvolutionOp("conv_double_buffered", workspace());
+        doubleBufferedConvOp->setStride(1, 1);
+        doubleBufferedConvOp->setPadding(SamePadding);
+        doubleBufferedConvOp->setInput(inputs, 0);
+        doubleBufferedConvOp->setInput(convOp->getInput(1), 1);
+        doubleBufferedConvOp->setWeightDims(
+                kernelDims[1], kernelDims[2], kernelDims[0]);
+        doubleBufferedConvOp->createAllTensors();
+        allocateAllTensors<float16>(doubleBufferedConvOp);
+        doubleBufferedConvOp->tile();
+        doubleBufferedConvOp->run();
+        verifyOutputs<float16>(
+                doubleBufferedConvOp->getOutput(0), convOp->getOutput(0));
+    }
+
     void doFusionTest(
             std::vector<int> inputDims,
             std::vector<int> kernelDims,
@@ -340,3 +377,95 @@ TEST_CASE_METHOD(SmvConvolutionOpTest, "Stride size tests", "[smvconv]") {
         }
     }
 }
+
+TEST_CASE_METHOD(SmvConvolutionOpTest,
+                 "SMV back to back convolutions",
+                 "[smvconv]") {
+    auto conv0 = new SmvConvolutionOp("conv0", workspace());
+    auto conv1 = new SmvConvolutionOp("conv1", workspace());
+    // Runs conv0 and conv1 through the scheduler, and returns true if conv1
+    // read the output tiles of conv0 directly.
+    auto doTest = [&](std::vector<int> inputDims,
+                      std::vector<int> kernel0Dims,
+                      std::vector<int> kernel1Dims) {
+        TensorShape inputShape(inputDims, NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("input", inputShape);
+        inputs->allocateStorage<float16>();
+        workspace()->addTensor(inputs);
+        conv0->setInput(inputs, 0);
+        conv0->setWeightDims(kernel0Dims[1], kernel0Dims[2], kernel0Dims[0]);
+        createAndFillTensorsWithData<float16>(conv0, fillTensorWithRandomData);
+        conv1->setInput(conv0->getOutput(0), 0);
+        conv1->setWeightDims(kernel1Dims[1], kernel1Dims[2], kernel1Dims[0]);
+        conv1->createAllTensors();
+        conv1->getInput(1)->allocateStorage<float16>();
+        fillTensorWithRandomData(conv1->getInput(1));
+        conv1->getOutput(0)->allocateStorage<float16>();
+        for (auto convOp : { conv0, conv1 }) {
+            convOp->tile();
+            convOp->run();
+        }
+        // Running the operators separately goes through the output tensor of
+        // conv0.
+        Tensor* expected = convertFp16ToFp32Tensor(conv1->getOutput(0),
+                                                   workspace());
+
+        network()->addOperator(conv0);
+        network()->addOperator(conv1);
+        network()->addEdge(conv0, conv1, { 0, 0 });
+        Tensor* output0 = conv0->getOutput(0);
+        float16* output0Data = output0->data<float16>();
+        int output0Size = output0->getShape().storageSize();
+        std::fill(output0Data, output0Data + output0Size, 0);
+        Scheduler scheduler(network(), workspace());
+        scheduler.runNetwork();
+        verifyOutputs<float>(
+                convertFp16ToFp32Tensor(conv1->getOutput(0), workspace()),
+                expected);
+        return std::all_of(output0Data, output0Data + output0Size,
+                           [](float16 value) { return value == 0; });
+    };
+    for (auto convOp : { conv0, conv1 }) {
+        convOp->setStride(1, 1);
+        convOp->setPadding(SamePadding);
+    }
+
+    SECTION("Outputs and inputs are tiled the same way") {
+        // The output of conv0 and the input of conv1 both have 4
+        // channelwise tiles.
+        REQUIRE(doTest({ 1, 16, 16, 32 }, { 256, 1, 1, 32 }, { 32, 1, 1, 256 }));
+    }
+    SECTION("Outputs and inputs are tiled differently") {
+        // The output of conv0 is tiled channelwise, whereas the input of conv1
+        // is tiled rowwise.
+        REQUIRE(!doTest({ 1, 32, 32, 8 }, { 64, 3, 3, 8 }, { 8, 3, 3, 64 }));
+    }
+}
+
+TEST_CASE_METHOD(SmvConvolutionOpTest,
+                 "SMV Tiled Convolution with double-buffered spads",
+                 "[smvconv]") {
+    SECTION("No tiling required") {
+        doDoubleBufferTest({ 1, 8, 8, 8 }, { 8, 3, 3, 8 });
+    }
+    SECTION("DimN tiled convolution") {
+        doDoubleBufferTest({ 1, 8, 8, 32 }, { 128, 3, 3, 32 });
+    }
+    SECTION("DimNH tiled convolution") {
+        doDoubleBufferTest({ 1, 32, 32, 32 }, { 8, 3, 3, 32 });
+    }
+    SECTION("DimNC tiled convolution") {
+        SECTION("Input tile and weight tile have the same channel dimension.") {
+            doDoubleBufferTest({ 1, 16, 16, 256 }, { 8, 5, 5, 256 });
+        }
+        SECTION("Inputs are not tiled channelwise") {
+            doDoubleBufferTest({ 1, 8, 8, 256 }, { 8, 3, 3, 256 });
+        }
+        SECTION("Outputs need DimNC tiling") {
+            doDoubleBufferTest({ 1, 32, 32, 8 }, { 256, 1, 1, 8 });
+        }
+    }
+    SECTION("DimNCH tiled convolution") {
+        doDoubleBufferTest({ 1, 32, 32, 192 }, { 32, 4, 4, 192 });
+    }
+}
@@ -1,9 +1,12 @@
 #include <algorithm>
 
 #include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
 #include "smaug/operators/common.h"
 #include "smaug/operators/smv/smv_convolution_op.h"
 #include "smaug/operators/smv/smv_convolution_tiling.h"
+#include "smaug/operators/smv/smv_spad_buffers.h"
+#include "smaug/operators/smv/smv_tiling_cache.h"
 #include "smaug/utility/debug_stream.h"
 
 namespace smaug {
@@ -54,11 +57,14 @@ std::array<TilingDims, 3> TilingOptimizer::determineBestTilingDims(
     return { bestInputTilingDims, bestWeightTilingDims, bestOutputTilingDims };
 }
 
-TilingConfig TilingOptimizer::computeBasicTileShapes(SmvConvolutionOp* op) {
+TilingConfig TilingOptimizer::computeBasicTileShapes(
+        SmvConvolutionOp* op, const TilingCostModel* costModel) {
     Tensor* inputs = op->getInput(op->Inputs);
     Tensor* weights = op->getInput(op->Kernels);
     Tensor* outputs = op->getOutput(op->Outputs);
-    int maxTileSize = SmvBackend::SpadSize() / inputs->getDataTypeSize();
+    // With double buffering, a tile may only take one buffer of the spads.
+    int maxTileSize =
+            SmvSpadBuffers::getBufferSize() / inputs->getDataTypeSize();
     std::array<TilingDims, 3> strategies =
             determineBestTilingDims(inputs, weights, outputs, maxTileSize);
     TilingDims inputTilingDims = strategies[0];
@@ -232,18 +238,123 @@ TilingConfig TilingOptimizer::computeBasicTileShapes(SmvConvolutionOp* op) {
             << "\n";
     for (auto& config : fullConfigs)
         dout(2) << "    " << config << "\n";
-    auto maxIt = std::max_element(
-            fullConfigs.begin(),
-            fullConfigs.end(),
-            [](const TilingConfig& c1, const TilingConfig& c2) {
-                return c1.getTotalSize() < c2.getTotalSize();
-            });
-    assert(maxIt != fullConfigs.end() && "Failed to get best tiling config!");
+    SpadUtilizationCostModel spadUtilizationModel;
+    DataMovementCostModel dataMovementModel(op);
+    if (!costModel) {
+        if (minimizeTilingDataMovement)
+            costModel = &dataMovementModel;
+        else
+            costModel = &spadUtilizationModel;
+    }
+    auto bestIt = fullConfigs.begin() + costModel->findCheapest(fullConfigs);
     // Fill in the tiling dims.
-    (*maxIt).inputTilingDims = inputTilingDims;
-    (*maxIt).weightTilingDims = weightTilingDims;
-    (*maxIt).outputTilingDims = outputTilingDims;
-    return *maxIt;
+    bestIt->inputTilingDims = inputTilingDims;
+    bestIt->weightTilingDims = weightTilingDims;
+    bestIt->outputTilingDims = outputTilingDims;
+    return *bestIt;
+}
+
+TilingCost DataMovementCostModel::estimate(const TilingConfig& config) const {
+    const TensorShape& inputsShape = op->getInput(op->Inputs)->getShape();
+    const TensorShape& weightsShape = op->getInput(op->Kernels)->getShape();
+    const TensorShape& outputsShape = op->getOutput(op->Outputs)->getShape();
+    int elementSize = op->getInput(op->Inputs)->getDataTypeSize();
+    int inputIfmapTiles = FRAC_CEIL(inputsShape[0], config.inputs[0]);
+    int outputRowTiles = FRAC_CEIL(outputsShape[1], config.outputs[1]);
+    int inputChanTiles = FRAC_CEIL(inputsShape[3], config.inputs[3]);
+    int weightOfmapTiles = FRAC_CEIL(weightsShape[0], config.weights[0]);
+    int weightChanTiles = FRAC_CEIL(weightsShape[3], config.weights[3]);
+    int outputChanTiles = FRAC_CEIL(outputsShape[3], config.outputs[3]);
+    // Returns the bytes of the tile at the given tile indices, where all but
+    // the last tile along a dimension have the basic tile shape.
+    auto getTileBytes = [&](const TensorShape& shape,
+                            const TensorShape& tileShape,
+                            std::vector<int> tileIndices) {
+        for (int i = 0; i < shape.ndims(); i++) {
+            tileIndices[i] = std::min(
+                    tileShape[i], shape[i] - tileIndices[i] * tileShape[i]);
+        }
+        TensorShape tile(
+                tileIndices, shape.getLayout(), shape.getAlignment());
+        return (int64_t)tile.storageSize() * elementSize;
+    };
+
+    // This follows the loop nest of SmvConvolutionOp::runNHWC on a single
+    // accelerator, which only reads an input or weight tile when it differs
+    // from the last one it has read.
+    TilingCost cost;
+    bool needOutputIteration = weightOfmapTiles < outputChanTiles;
+    int numOutputInvocations = needOutputIteration ? outputChanTiles : 1;
+    int lastReadInputTile = -1;
+    int lastReadWeightTile = -1;
+    for (int N = 0; N < inputIfmapTiles; N++) {
+        for (int H = 0; H < outputRowTiles; H++) {
+            for (int W = 0; W < weightOfmapTiles; W++) {
+                for (int oC = 0; oC < numOutputInvocations; oC++) {
+                    int iC = 0, wC = 0;
+                    while (iC < inputChanTiles && wC < weightChanTiles) {
+                        // Input tiles along the rows have the same shape, as
+                        // they overlap by the filter halo.
+                        int inputTile =
+                                (N * outputRowTiles + H) * inputChanTiles + iC;
+                        int weightTile = W * weightChanTiles + wC;
+                        if (inputTile != lastReadInputTile) {
+                            cost.inputBytes += getTileBytes(
+                                    inputsShape, config.inputs, { N, 0, 0, iC });
+                            lastReadInputTile = inputTile;
+                        }
+                        if (weightTile != lastReadWeightTile) {
+                            cost.weightBytes +=
+                                    getTileBytes(weightsShape, config.weights,
+                                                 { W, 0, 0, wC });
+                            lastReadWeightTile = weightTile;
+                        }
+                        if (wC == weightChanTiles - 1) {
+                            cost.outputBytes +=
+                                    getTileBytes(outputsShape, config.outputs,
+                                                 { N, H, 0, W + oC });
+                        }
+                        cost.numInvocations++;
+                        if (inputChanTiles == weightChanTiles)
+                            iC++;
+                        wC++;
+                    }
+                }
+            }
+        }
+    }
+    return cost;
+}
+
+bool DataMovementCostModel::isCheaper(const TilingConfig& config0,
+                                      const TilingConfig& config1) const {
+    return isCheaper(config0, estimate(config0), config1, estimate(config1));
+}
+
+int DataMovementCostModel::findCheapest(
+        const std::vector<TilingConfig>& configs) const {
+    assert(!configs.empty() && "Failed to get best tiling config!");
+    std::vector<TilingCost> costs;
+    costs.reserve(configs.size());
+    for (const auto& config : configs)
+        costs.push_back(estimate(config));
+    int best = 0;
+    for (int i = 1; i < configs.size(); i++) {
+        if (isCheaper(configs[i], costs[i], configs[best], costs[best]))
+            best = i;
+    }
+    return best;
+}
+
+bool DataMovementCostModel::isCheaper(const TilingConfig& config0,
+                                      const TilingCost& cost0,
+                                      const TilingConfig& config1,
+                                      const TilingCost& cost1) {
+    if (cost0.getDmaBytes() != cost1.getDmaBytes())
+        return cost0.getDmaBytes() < cost1.getDmaBytes();
+    if (cost0.numInvocations != cost1.numInvocations)
+        return cost0.numInvocations < cost1.numInvocations;
+    return config0.getTotalSize() > config1.getTotalSize();
 }
 
 TiledTensor TilingOptimizer::generateRowwiseOutputTiledTensor(
@@ -346,7 +457,13 @@ std::array<TiledTensor, 3> TilingOptimizer::doTiling(SmvConvolutionOp* op) {
     auto input = op->getInput(SmvConvolutionOp::Inputs);
     auto kernels = op->getInput(SmvConvolutionOp::Kernels);
     auto output = op->getOutput(SmvConvolutionOp::Outputs);
-    TilingConfig tileConfig = TilingOptimizer::computeBasicTileShapes(op);
+    TilingConfig tileConfig = findOrComputeTilingConfig(
+            getTilingPlanKey(op,
+                             { input, kernels, output },
+                             { op->getRowStride(), op->getColStride(),
+                               op->getPadding(),
+                               minimizeTilingDataMovement }),
+            [op]() { return TilingOptimizer::computeBasicTileShapes(op); });
     TiledTensor tiledInputs =
             generateTiledTensorWithStrideAndPadding(input,
                                                     tileConfig.inputs,
@@ -5,6 +5,7 @@
 #include "smaug/core/tensor.h"
 #include "smaug/operators/smv/smv_tiling_common.h"
 #include "smaug/operators/smv/smv_tiling_base.h"
+#include "smaug/operators/smv/smv_tiling_cost.h"
 
 namespace smaug {
 
@@ -28,8 +29,11 @@ class TilingOptimizer : public TilingOptimizerBase {
      * enumerate all possible basic tile shapes for inputs, weights, and
      * outputs. A **basic** shape is the shape that all but potentially the
      * last tile along a set of dimensions will use. This triplet of tile
-     * shapes defines a TilingConfig. The TilingConfig that maximizes the total
-     * combined size of input, weights, and output tiles is chosen as the best.
+     * shapes defines a TilingConfig. The cheapest TilingConfig according to
+     * the cost model is chosen as the best. By default, that is the one that
+     * maximizes the total combined size of input, weights, and output tiles;
+     * if minimizeTilingDataMovement is set, it is the one that moves the
+     * fewest bytes (see DataMovementCostModel).
      *
      * To limit the number of possibilities, we only enumerate each dimension
      * in certain increments. For example, input channels are only enumerated
@@ -42,9 +46,12 @@ class TilingOptimizer : public TilingOptimizerBase {
      *
      * @param op The SMV convolution operator. All tensors must have been
      * created with createAllTensors() prior to calling this function.
+     * @param costModel The cost model that ranks the TilingConfigs. If null,
+     * the default one is used.
      * @returns The TilingConfig that describes the best tiling shapes.
      */
-    static TilingConfig computeBasicTileShapes(SmvConvolutionOp* op);
+    static TilingConfig computeBasicTileShapes(
+            SmvConvolutionOp* op, const TilingCostModel* costModel = nullptr);
 
     /**
      * A specialized output tiling function when the output is tiled rowwise.
@@ -77,6 +84,42 @@ class TilingOptimizer : public TilingOptimizerBase {
                                                              int maxTileSize);
 };
 
+/**
+ * An analytic cost model of the data movement of SMV convolution.
+ *
+ * It replays the loop nest of SmvConvolutionOp::runNHWC over the tiles of a
+ * TilingConfig, counting the bytes of the input and weight tiles loaded into
+ * the scratchpads, of the finished output tiles, and the kernel invocations.
+ * Like the operator, an input or weight tile is only loaded when it differs
+ * from the last one loaded, so a config that makes the weights be reloaded
+ * for every input tile costs more than one with smaller but reused tiles.
+ *
+ * Configs that move fewer bytes are cheaper. Ties are broken by fewer kernel
+ * invocations, then by the scratchpad utilization.
+ */
+class DataMovementCostModel : public TilingCostModel {
+   public:
+    DataMovementCostModel(SmvConvolutionOp* _op) : op(_op) {}
+
+    /** Estimates the cost of running the convolution with a TilingConfig. */
+    TilingCost estimate(const TilingConfig& config) const;
+
+    bool isCheaper(const TilingConfig& config0,
+                   const TilingConfig& config1) const override;
+
+    /** Estimates every config only once, and returns the cheapest one. */
+    int findCheapest(const std::vector<TilingConfig>& configs) const override;
+
+   protected:
+    /** Compares two configs given their estimated costs. */
+    static bool isCheaper(const TilingConfig& config0,
+                          const TilingCost& cost0,
+                          const TilingConfig& config1,
+                          const TilingCost& cost1);
+
+    SmvConvolutionOp* op;
+};
+
 }  // namespace conv
 }  // namespace smv
 }  // namespace smaug
@@ -846,3 +846,71 @@ TEST_CASE_METHOD(SmaugTest, "Stride size tests", "[smvtiling]") {
         }
     }
 }
+
+TEST_CASE_METHOD(SmaugTest, "Data movement cost model", "[smvtiling]") {
+    using namespace smaug::smv;
+    using namespace smaug::smv::conv;
+    auto convOp = new SmvConvolutionOp("conv", workspace());
+    convOp->setStride(1, 1);
+    convOp->setPadding(SamePadding);
+    DataMovementCostModel dataMovementModel(convOp);
+    SpadUtilizationCostModel spadUtilizationModel;
+
+    SECTION("No tiling needed") {
+        TensorShape inputShape(
+                { 1, 32, 32, 8 }, DataLayout::NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->setWeightDims(5, 5, 8);
+        convOp->createAllTensors();
+        allocateAllTensors<float16>(convOp);
+        TilingConfig config = TilingOptimizer::computeBasicTileShapes(
+                convOp, &dataMovementModel);
+        TilingCost cost = dataMovementModel.estimate(config);
+        // Every tensor is moved exactly once.
+        REQUIRE(cost.inputBytes == 32 * 32 * 8 * sizeof(float16));
+        REQUIRE(cost.weightBytes == 8 * 5 * 5 * 8 * sizeof(float16));
+        REQUIRE(cost.outputBytes == 32 * 32 * 8 * sizeof(float16));
+        REQUIRE(cost.numInvocations == 1);
+    }
+
+    SECTION("Weights are reloaded for every rowwise input tile") {
+        TensorShape inputShape(
+                { 1, 64, 64, 32 }, DataLayout::NHWC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        convOp->setInput(inputs, 0);
+        convOp->setWeightDims(3, 3, 128);
+        convOp->createAllTensors();
+        allocateAllTensors<float16>(convOp);
+
+        // By default, the largest tiles are chosen.
+        TilingConfig defaultConfig =
+                TilingOptimizer::computeBasicTileShapes(convOp);
+        TilingConfig largestConfig = TilingOptimizer::computeBasicTileShapes(
+                convOp, &spadUtilizationModel);
+        REQUIRE(defaultConfig.inputs == largestConfig.inputs);
+        REQUIRE(defaultConfig.weights == largestConfig.weights);
+        REQUIRE(largestConfig.inputs.dims() == std::vector<int>{ 1, 6, 64, 32 });
+        REQUIRE(largestConfig.weights.dims() ==
+                std::vector<int>{ 48, 3, 3, 32 });
+
+        // With three weight tiles for each of the 13 rowwise tiles, the
+        // weights are reloaded 13 times. Fewer but taller input tiles move
+        // fewer bytes overall, even though the weight tiles are smaller.
+        TilingConfig config = TilingOptimizer::computeBasicTileShapes(
+                convOp, &dataMovementModel);
+        REQUIRE(config.inputs.dims() == std::vector<int>{ 1, 8, 64, 32 });
+        REQUIRE(config.weights.dims() == std::vector<int>{ 32, 3, 3, 32 });
+        REQUIRE(config.outputs.dims() == std::vector<int>{ 1, 7, 64, 32 });
+        TilingCost largestCost = dataMovementModel.estimate(largestConfig);
+        TilingCost cost = dataMovementModel.estimate(config);
+        REQUIRE(largestCost.weightBytes == 13 * 128 * 3 * 3 * 32 * 2);
+        REQUIRE(cost.weightBytes == 10 * 128 * 3 * 3 * 32 * 2);
+        REQUIRE(cost.outputBytes == largestCost.outputBytes);
+        REQUIRE(cost.getDmaBytes() < largestCost.getDmaBytes());
+        REQUIRE(dataMovementModel.isCheaper(config, largestConfig));
+        REQUIRE(spadUtilizationModel.isCheaper(largestConfig, config));
+    }
+}
@@ -4,6 +4,7 @@
 #include "smaug/operators/smv/smv_eltwise_add_op.h"
 #include "smaug/operators/smv/smv_unary_op_common.h"
 #include "smaug/operators/smv/smv_kernels.h"
+#include "smaug/operators/smv/smv_spad_buffers.h"
 #include "smaug/utility/debug_stream.h"
 
 namespace smaug {
@@ -20,6 +21,14 @@ void SmvEltwiseAddOp::runX(TiledTensor& inputs0,
             smv::kEltwiseOpHw, "host_inputs1", getInputsMemType());
     setArrayMemTypeIfSimulating(
             smv::kEltwiseOpHw, "host_results", getOutputsMemType());
+    setArrayMemTypeIfSimulating(
+            smv::kEltwiseOpHw, "host_next_inputs0", getInputsMemType());
+    setArrayMemTypeIfSimulating(
+            smv::kEltwiseOpHw, "host_next_inputs1", getInputsMemType());
+    // With double buffering, every invocation prefetches the input tiles of
+    // the next one into the other buffers of the scratchpads.
+    SmvSpadBuffers input0Buffers(smv::spad0);
+    SmvSpadBuffers input1Buffers(smv::spad1);
     for (int i = 0; i < inputs0.size(); i++) {
         dout(1) << "Input0: " << i << ", input1: " << i << ", output: " << i
                 << "\n";
@@ -37,11 +46,37 @@ void SmvEltwiseAddOp::runX(TiledTensor& inputs0,
         mapArrayToAccel(smv::kEltwiseOpHw, "host_results",
                         outputTile->data<float16>(),
                         outputShape.storageSize() * sizeof(float16));
+        bool readInputs;
+        float* input0Spad = input0Buffers.getBufferForTile(i, &readInputs);
+        float* input1Spad = input1Buffers.getBufferForTile(i, &readInputs);
+
+        float16* nextInput0 = nullptr;
+        float16* nextInput1 = nullptr;
+        float* nextInput0Spad = nullptr;
+        float* nextInput1Spad = nullptr;
+        int nextInputSize = 0;
+        if (i + 1 < inputs0.size()) {
+            nextInput0Spad = input0Buffers.prefetchTile(i + 1);
+            nextInput1Spad = input1Buffers.prefetchTile(i + 1);
+        }
+        if (nextInput0Spad) {
+            Tensor* nextInput0Tile = inputs0.getTileWithData(i + 1);
+            Tensor* nextInput1Tile = inputs1.getTileWithData(i + 1);
+            nextInput0 = nextInput0Tile->data<float16>();
+            nextInput1 = nextInput1Tile->data<float16>();
+            nextInputSize = nextInput0Tile->getShape().storageSize();
+            mapArrayToAccel(smv::kEltwiseOpHw, "host_next_inputs0", nextInput0,
+                            nextInputSize * sizeof(float16));
+            mapArrayToAccel(smv::kEltwiseOpHw, "host_next_inputs1", nextInput1,
+                            nextInputSize * sizeof(float16));
+        }
 
         invokeKernel(smv::kEltwiseOpHw, smv_eltwise_add_nc_vec_fxp,
                      input0Tile->data<float16>(), input1Tile->data<float16>(),
-                     outputTile->data<float16>(), smv::spad0, smv::spad1,
-                     smv::spad2, inputShape.storageSize());
+                     outputTile->data<float16>(), input0Spad, input1Spad,
+                     smv::spad2, inputShape.storageSize(), readInputs,
+                     nextInput0, nextInput1, nextInput0Spad, nextInput1Spad,
+                     nextInputSize);
     }
 }
 
@@ -51,9 +86,9 @@ void SmvEltwiseAddOp::tile() {
     auto inputs0 = getInput(Input0);
     auto inputs1 = getInput(Input1);
     auto outputs = getOutput(Outputs);
-    int maxTileSize =
-            std::min(SmvBackend::SpadSize() / inputs0->getDataTypeSize(),
-                     inputs0->getShape().storageSize());
+    int maxTileSize = std::min(
+            SmvSpadBuffers::getBufferSize() / inputs0->getDataTypeSize(),
+            inputs0->getShape().storageSize());
     TensorShape tileShape(
             { 1, maxTileSize }, DataLayout::NC, SmvBackend::Alignment);
     tiledTensors[0] = generateTiledTensorPerBatchNC(
@@ -80,7 +115,11 @@ void SmvEltwiseAddOp::run() {
         tiledTensors[1].copyDataToAllTiles();
     }
 
-    runX(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    {
+        auto profile = ScopedProfile(
+                profile::kKernelDispatch, profile::kPhase);
+        runX(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    }
 
     {
         auto stats = gem5::ScopedStats(
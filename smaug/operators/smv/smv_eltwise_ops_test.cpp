@@ -124,6 +124,41 @@ class SmvEltwiseOpsTest : public SmaugTest {
             verifyOutputs<float16>(outputs, refOutputs);
     }
 
+    Operator* createAddOrMulOp(const std::string& name, OpType opType) {
+        if (opType == EltwiseAdd)
+            return new SmvEltwiseAddOp(name, workspace());
+        return new SmvEltwiseMulOp(name, workspace());
+    }
+
+    // Runs the operator with double-buffered spads, which halves the tiles,
+    // and compares the outputs against the single-buffered ones.
+    void doDoubleBufferTest(const std::vector<int>& dims, OpType opType) {
+        DataLayout layout = dims.size() == 4 ? NHWC : NC;
+        TensorShape inputShape(dims, layout, SmvBackend::Alignment);
+        Tensor* inputs0 = new Tensor("input0", inputShape);
+        Tensor* inputs1 = new Tensor("input1", inputShape);
+        inputs0->allocateStorage<float16>();
+        inputs1->allocateStorage<float16>();
+        workspace()->addTensor(inputs0);
+        workspace()->addTensor(inputs1);
+        fillTensorWithRandomData(inputs0);
+        fillTensorWithRandomData(inputs1);
+        Operator* eltOps[2];
+        for (int i = 0; i < 2; i++) {
+            useDoubleBufferedSpads = i == 1;
+            eltOps[i] = createAddOrMulOp(
+                    i == 0 ? "eltwise" : "eltwise_double_buffered", opType);
+            eltOps[i]->setInput(inputs0, 0);
+            eltOps[i]->setInput(inputs1, 1);
+            eltOps[i]->createAllTensors();
+            eltOps[i]->getOutput(0)->allocateStorage<float16>();
+            eltOps[i]->tile();
+            eltOps[i]->run();
+        }
+        verifyOutputs<float16>(
+                eltOps[1]->getOutput(0), eltOps[0]->getOutput(0));
+    }
+
     void doTest(const std::vector<int>& dims) {
         doSingleTest(dims, EltwiseAdd);
         doSingleTest(dims, EltwiseMul);
@@ -148,3 +183,20 @@ TEST_CASE_METHOD(SmvEltwiseOpsTest, "SMV Tiled 2D Eltwise Ops", "[smveltops]") {
     SECTION("DimNC tiling") { doTest({ 1, 32768 }); }
 }
 
+
+TEST_CASE_METHOD(SmvEltwiseOpsTest,
+                 "SMV Eltwise Ops with double-buffered spads",
+                 "[smveltops]") {
+    SECTION("No tiling required") {
+        doDoubleBufferTest({ 1, 1024 }, EltwiseAdd);
+        doDoubleBufferTest({ 1, 1024 }, EltwiseMul);
+    }
+    SECTION("DimNC tiling") {
+        doDoubleBufferTest({ 1, 32768 }, EltwiseAdd);
+        doDoubleBufferTest({ 1, 32768 }, EltwiseMul);
+    }
+    SECTION("DimNH tiling") {
+        doDoubleBufferTest({ 1, 64, 64, 32 }, EltwiseAdd);
+        doDoubleBufferTest({ 1, 64, 64, 32 }, EltwiseMul);
+    }
+}
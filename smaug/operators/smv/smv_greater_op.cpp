@@ -79,7 +79,11 @@ void SmvGreaterOp::run() {
         tiledTensors[1].copyDataToAllTiles();
     }
 
-    runX(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    {
+        auto profile = ScopedProfile(
+                profile::kKernelDispatch, profile::kPhase);
+        runX(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    }
 
     {
         auto stats = gem5::ScopedStats(
@@ -160,7 +164,11 @@ void SmvGreaterEqualOp::run() {
         tiledTensors[1].copyDataToAllTiles();
     }
 
-    runX(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    {
+        auto profile = ScopedProfile(
+                profile::kKernelDispatch, profile::kPhase);
+        runX(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    }
 
     {
         auto stats = gem5::ScopedStats(
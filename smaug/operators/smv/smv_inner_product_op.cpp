@@ -4,6 +4,7 @@
 #include "smaug/operators/smv/smv_inner_product_tiling.h"
 #include "smaug/operators/smv/smv_kernels.h"
 #include "smaug/operators/smv/smv_accel_pool.h"
+#include "smaug/operators/smv/smv_spad_buffers.h"
 #include "smaug/utility/debug_stream.h"
 
 namespace smaug {
@@ -44,10 +45,43 @@ void SmvInnerProductOp::runNWA(TiledTensor& inputs,
                 smv::kInnerProductHw + i, "host_b", getWeightsMemType());
         setArrayMemTypeIfSimulating(
                 smv::kInnerProductHw + i, "host_results", getOutputsMemType());
+        setArrayMemTypeIfSimulating(
+                smv::kInnerProductHw + i, "host_next_a", getInputsMemType());
+        setArrayMemTypeIfSimulating(
+                smv::kInnerProductHw + i, "host_next_b", getWeightsMemType());
+        if (bias) {
+            setArrayMemTypeIfSimulating(
+                    smv::kInnerProductHw + i, "host_bias", getWeightsMemType());
+        }
+    }
+    float16* biasData = bias ? bias->data<float16>() : nullptr;
+    // The activation-wise tiles of the inputs and weights that every (N, W)
+    // iteration goes through. There is one condition on which the input tile
+    // has different number of activations from the weight tile: the inputs
+    // don't need tiling on activations while the weights do. In that case, we
+    // send the input tile once and keep the input tile stationary in the
+    // scrachpad, finishing the weight activation-wise tiles with multiple
+    // invocations.
+    std::vector<std::pair<int, int>> actTiles;
+    if (inputActTiles == weightActTiles) {
+        for (int C = 0; C < weightActTiles; C++)
+            actTiles.emplace_back(C, C);
+    } else if (inputActTiles == 1) {
+        for (int wC = 0; wC < weightActTiles; wC++)
+            actTiles.emplace_back(0, wC);
+    } else {
+        assert(false && "The input/weight tiles can have different "
+                        "number of channels only when the inputs "
+                        "don't need activation-wise tiling.");
     }
     SmvAcceleratorPool accelPool(numAcceleratorsAvailable);
-    std::vector<int> lastReadInputTileIdx(numAcceleratorsAvailable, -1);
-    int currAccelIdx = 0;
+    // With double buffering, every invocation prefetches the tiles of the
+    // next invocation on the same accelerator into the other buffers of its
+    // spads.
+    std::vector<SmvSpadBuffers> inputBuffers(
+            numAcceleratorsAvailable, SmvSpadBuffers(smv::spad0));
+    std::vector<SmvSpadBuffers> weightBuffers(
+            numAcceleratorsAvailable, SmvSpadBuffers(smv::spad1));
     for (int N = 0; N < inputNumTiles; N++) {
         // Usually we are constrained by weights whereas outputs can fit in the
         // scratchpad. This keeps track of finished neurons and will be used by
@@ -59,24 +93,38 @@ void SmvInnerProductOp::runNWA(TiledTensor& inputs,
             // loop nests beyond this level will need to run in serial, because
             // the input/weight channelwise tiles iteration accumulate results
             // to the same output tile.
+            //
+            // The weights are read in every invocation, so prefer the
+            // accelerator that already holds the first input tile.
+            int firstInputTileIdx = inputIdx(N, 0);
+            int currAccelIdx = accelPool.getNextAvailableAccelerator(
+                    [&](int accelIdx) {
+                        if (!inputBuffers[accelIdx].holdsTile(
+                                    firstInputTileIdx))
+                            return 0;
+                        return inputs[firstInputTileIdx]
+                                       ->getShape()
+                                       .storageSize() *
+                               (int)sizeof(float16);
+                    });
             int outputTileIdx = outputIdx(N, 0);
             Tensor* outputTile = outputs[outputTileIdx];
             const TensorShape& outputShape = outputTile->getShape();
             mapArrayToAccel(smv::kInnerProductHw + currAccelIdx, "host_results",
                             outputTile->data<float16>(),
                             outputShape.storageSize() * sizeof(float16));
-            int iC = 0, wC = 0;
+            if (bias) {
+                mapArrayToAccel(smv::kInnerProductHw + currAccelIdx,
+                                "host_bias", biasData,
+                                outputShape[1] * sizeof(float16));
+            }
             // This keeps track of the activation offset of the inputs.
             int actOffset = 0;
-            while (iC < inputActTiles && wC < weightActTiles) {
+            for (int t = 0; t < actTiles.size(); t++) {
+                int iC = actTiles[t].first;
+                int wC = actTiles[t].second;
                 int inputTileIdx = inputIdx(N, iC);
                 int weightTileIdx = weightIdx(W, wC);
-                // There is one condition on which the input tile has different
-                // number of activations from the weight tile: the inputs don't
-                // need tiling on activations while the weights do. In that
-                // case, we send the input tile once and keep the input tile
-                // stationary in the scrachpad, finishing the weight
-                // activation-wise tiles with multiple invocations.
                 dout(1) << "Input: " << inputTileIdx
                         << ", weights: " << weightTileIdx
                         << ", output: " << outputTileIdx << "\n";
@@ -102,45 +150,85 @@ void SmvInnerProductOp::runNWA(TiledTensor& inputs,
                 // to true for non-first weight tiles to avoid resetting the
                 // result buffer.
                 bool accumulate = wC > 0;
-                // If this is a new input tile, then we need to read it.
-                bool readInputs = false;
-                if (inputTileIdx != lastReadInputTileIdx[currAccelIdx]) {
-                    readInputs = true;
-                    lastReadInputTileIdx[currAccelIdx] = inputTileIdx;
-                }
+                // A tile needs to be read unless it is already in a buffer,
+                // either because it stayed stationary or because it was
+                // prefetched.
+                bool readInputs, readWeights;
+                float* inputSpad = inputBuffers[currAccelIdx].getBufferForTile(
+                        inputTileIdx, &readInputs);
+                float* weightSpad =
+                        weightBuffers[currAccelIdx].getBufferForTile(
+                                weightTileIdx, &readWeights);
                 // We only need to send the results back to host memory in the
                 // very last invocation.
                 bool sendOutputs = (N == inputNumTiles - 1) &&
                                    (W == weightNeuronTiles - 1) &&
                                    (wC == weightActTiles - 1);
 
+                // Find the tiles of the next invocation on this accelerator.
+                // The next (N, W) iteration may run on another accelerator, so
+                // its tiles are only prefetched if there is just one.
+                int nextInputTileIdx = -1, nextWeightTileIdx = -1;
+                if (t + 1 < actTiles.size()) {
+                    nextInputTileIdx = inputIdx(N, actTiles[t + 1].first);
+                    nextWeightTileIdx = weightIdx(W, actTiles[t + 1].second);
+                } else if (numAcceleratorsAvailable == 1) {
+                    if (W + 1 < weightNeuronTiles) {
+                        nextInputTileIdx = inputIdx(N, actTiles[0].first);
+                        nextWeightTileIdx =
+                                weightIdx(W + 1, actTiles[0].second);
+                    } else if (N + 1 < inputNumTiles) {
+                        nextInputTileIdx = inputIdx(N + 1, actTiles[0].first);
+                        nextWeightTileIdx = weightIdx(0, actTiles[0].second);
+                    }
+                }
+                float16* nextInputs = nullptr;
+                float16* nextWeights = nullptr;
+                float* nextInputSpad = nullptr;
+                float* nextWeightSpad = nullptr;
+                int nextInputSize = 0, nextWeightSize = 0;
+                if (nextInputTileIdx != -1) {
+                    nextInputSpad = inputBuffers[currAccelIdx].prefetchTile(
+                            nextInputTileIdx);
+                    nextWeightSpad = weightBuffers[currAccelIdx].prefetchTile(
+                            nextWeightTileIdx);
+                }
+                if (nextInputSpad) {
+                    Tensor* tile = inputs.getTileWithData(nextInputTileIdx);
+                    nextInputs = tile->data<float16>();
+                    nextInputSize = tile->getShape().storageSize();
+                    mapArrayToAccel(smv::kInnerProductHw + currAccelIdx,
+                                    "host_next_a", nextInputs,
+                                    nextInputSize * sizeof(float16));
+                }
+                if (nextWeightSpad) {
+                    Tensor* tile = weights.getTileWithData(nextWeightTileIdx);
+                    nextWeights = tile->data<float16>();
+                    nextWeightSize = tile->getShape().storageSize();
+                    mapArrayToAccel(smv::kInnerProductHw + currAccelIdx,
+                                    "host_next_b", nextWeights,
+                                    nextWeightSize * sizeof(float16));
+                }
+
                 std::unique_ptr<volatile int> finishFlag = invokeKernelNoBlock(
                         currAccelIdx, smv::kInnerProductHw + currAccelIdx,
                         smv_matrix_multiply_transpose_nc_vec_fxp,
                         inputTile->data<float16>(),
                         weightsTile->data<float16>(),
-                        outputTile->data<float16>(), smv::spad0, smv::spad1,
-                        smv::spad2, inputDims, weightsDims, outputDims,
-                        inputShape.getPadding(1), weightsShape.getPadding(1),
-                        outputShape.getPadding(1), actStart, finishedNeurons,
-                        accumulate, readInputs, sendOutputs, actInfo.function,
-                        actInfo.params, &sampling);
+                        outputTile->data<float16>(), biasData, inputSpad,
+                        weightSpad, smv::spad2, inputDims, weightsDims,
+                        outputDims, inputShape.getPadding(1),
+                        weightsShape.getPadding(1), outputShape.getPadding(1),
+                        actStart, finishedNeurons, accumulate, readInputs,
+                        readWeights, sendOutputs, nextInputs, nextWeights,
+                        nextInputSpad, nextWeightSpad, nextInputSize,
+                        nextWeightSize, actInfo.function, actInfo.params,
+                        &sampling);
                 accelPool.addFinishFlag(currAccelIdx, std::move(finishFlag));
 
                 actOffset += weightsTile->getShape()[1];
-                if (inputActTiles == weightActTiles) {
-                    iC++;
-                    wC++;
-                } else if (inputActTiles == 1) {
-                    wC++;
-                } else {
-                    assert(false && "The input/weight tiles can have different "
-                                    "number of channels only when the inputs "
-                                    "don't need activation-wise tiling.");
-                }
             }
             finishedNeurons += weights[weightIdx(W, 0)]->getShape()[0];
-            currAccelIdx = accelPool.getNextAvailableAccelerator(currAccelIdx);
         }
     }
     // Before we leave, make sure all the accelerators have finished.
@@ -173,7 +261,11 @@ void SmvInnerProductOp::run() {
         tiledTensors[1].copyDataToAllTiles();
     }
 
-    runNWA(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    {
+        auto profile = ScopedProfile(
+                profile::kKernelDispatch, profile::kPhase);
+        runNWA(tiledTensors[0], tiledTensors[1], tiledTensors[2]);
+    }
 
     {
         auto stats = gem5::ScopedStats(
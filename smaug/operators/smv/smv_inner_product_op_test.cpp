@@ -53,6 +53,35 @@ class SmvInnerProductOpTest : public SmaugTest {
         verifyOutputs<float16>(outputs, refOutputs);
     }
 
+    // Runs the inner product with double-buffered spads, which halves the
+    // tiles, and compares the outputs against the single-buffered ones.
+    void doDoubleBufferTest(std::vector<int> inputDims, int numNeurons) {
+        auto fcOp = new SmvInnerProductOp("fc", workspace());
+        TensorShape inputShape(
+                inputDims, DataLayout::NC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("input", inputShape);
+        workspace()->addTensor(inputs);
+        fcOp->setInput(inputs, 0);
+        fcOp->setNumOutputs(numNeurons);
+        inputs->allocateStorage<float16>();
+        createAndFillTensorsWithData<float16>(fcOp, fillTensorWithRandomData);
+        fcOp->tile();
+        fcOp->run();
+
+        useDoubleBufferedSpads = true;
+        auto doubleBufferedFcOp =
+                new SmvInnerProductOp("fc_double_buffered", workspace());
+        doubleBufferedFcOp->setInput(inputs, 0);
+        doubleBufferedFcOp->setInput(fcOp->getInput(1), 1);
+        doubleBufferedFcOp->setNumOutputs(numNeurons);
+        doubleBufferedFcOp->createAllTensors();
+        allocateAllTensors<float16>(doubleBufferedFcOp);
+        doubleBufferedFcOp->tile();
+        doubleBufferedFcOp->run();
+        verifyOutputs<float16>(
+                doubleBufferedFcOp->getOutput(0), fcOp->getOutput(0));
+    }
+
     void doFusionTest(
             std::vector<int> inputDims,
             int numNeurons,
@@ -117,3 +146,23 @@ TEST_CASE_METHOD(SmvInnerProductOpTest,
         doFusionTest({ 1, 32768 }, 256);
     }
 }
+
+TEST_CASE_METHOD(SmvInnerProductOpTest,
+                 "SMV tiled inner product with double-buffered spads",
+                 "[smvfc]") {
+    SECTION("No tiling required") { doDoubleBufferTest({ 1, 256 }, 32); }
+
+    SECTION("DimN tiling for weights, None for inputs") {
+        doDoubleBufferTest({ 1, 256 }, 128);
+    }
+
+    SECTION("DimNC tiling for weights, None for inputs") {
+        doDoubleBufferTest({ 1, 4096 }, 128);
+    }
+
+    SECTION("DimNC tiling for weights and inputs") {
+        doDoubleBufferTest({ 1, 32768 }, 256);
+    }
+
+    SECTION("Batched inputs") { doDoubleBufferTest({ 4, 1024 }, 64); }
+}
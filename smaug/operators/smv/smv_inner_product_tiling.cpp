@@ -4,6 +4,8 @@
 #include "smaug/operators/common.h"
 #include "smaug/operators/smv/smv_inner_product_op.h"
 #include "smaug/operators/smv/smv_inner_product_tiling.h"
+#include "smaug/operators/smv/smv_spad_buffers.h"
+#include "smaug/operators/smv/smv_tiling_cache.h"
 #include "smaug/utility/debug_stream.h"
 
 namespace smaug {
@@ -36,7 +38,9 @@ TilingConfig TilingOptimizer::computeBasicTileShapes(SmvInnerProductOp* op) {
     Tensor* inputs = op->getInput(op->Inputs);
     Tensor* weights = op->getInput(op->Weights);
     Tensor* outputs = op->getOutput(op->Outputs);
-    int maxTileSize = SmvBackend::SpadSize() / inputs->getDataTypeSize();
+    // With double buffering, a tile may only take one buffer of the spads.
+    int maxTileSize =
+            SmvSpadBuffers::getBufferSize() / inputs->getDataTypeSize();
     std::array<TilingDims, 3> strategies =
             determineBestTilingDims(inputs, weights, outputs, maxTileSize);
     TilingDims inputTilingDims = strategies[0];
@@ -199,7 +203,9 @@ std::array<TiledTensor, 3> TilingOptimizer::doTiling(SmvInnerProductOp* op) {
     auto input = op->getInput(SmvInnerProductOp::Inputs);
     auto kernels = op->getInput(SmvInnerProductOp::Weights);
     auto output = op->getOutput(SmvInnerProductOp::Outputs);
-    TilingConfig tileConfig = TilingOptimizer::computeBasicTileShapes(op);
+    TilingConfig tileConfig = findOrComputeTilingConfig(
+            getTilingPlanKey(op, { input, kernels, output }),
+            [op]() { return TilingOptimizer::computeBasicTileShapes(op); });
     TiledTensor tiledInputs =
             generateTiledTensor(input, tileConfig.inputs, op, /* copy_data*/ false);
     // Copy data for the weight tiles since the data is read-only.
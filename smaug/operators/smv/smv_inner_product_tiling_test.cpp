@@ -161,4 +161,22 @@ TEST_CASE_METHOD(SmaugTest, "Basic tiling tests", "[smvtiling]") {
             verifyTensorWithFixedData(outputTiles[0], 0);
         }
     }
+
+    SECTION("DimN tiling for weights with double-buffered spads") {
+        // The weights would be tiled into 2 neuron-wise tiles, but a tile may
+        // only take half of the spad.
+        useDoubleBufferedSpads = true;
+        TensorShape inputShape(
+                { 1, 256 }, DataLayout::NC, SmvBackend::Alignment);
+        Tensor* inputs = new Tensor("inputs", inputShape);
+        workspace()->addTensor(inputs);
+        fcOp->setInput(inputs, 0);
+        fcOp->setNumOutputs(128);
+        fcOp->createAllTensors();
+        allocateAllTensors<float16>(fcOp);
+        TilingConfig config = TilingOptimizer::computeBasicTileShapes(fcOp);
+        REQUIRE(config.inputs == inputShape);
+        REQUIRE(config.weights.dims() == std::vector<int>{ 32, 256 });
+        REQUIRE(config.outputs.dims() == std::vector<int>{ 1, 128 });
+    }
 }
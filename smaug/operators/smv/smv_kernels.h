@@ -10,6 +10,7 @@ extern "C" {
 void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
                              float16* host_weights,
                              float16* host_results,
+                             float16* host_bias,
                              float* inputs,
                              float* weights,
                              float* results,
@@ -28,6 +29,12 @@ void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
                              bool read_inputs,
                              bool read_weights,
                              bool send_results,
+                             float16* host_next_inputs,
+                             float16* host_next_weights,
+                             float* next_inputs,
+                             float* next_weights,
+                             int next_inputs_size,
+                             int next_weights_size,
                              activation_type act_function,
                              activation_param_t act_params,
                              SamplingInfo* sampling);
@@ -35,6 +42,7 @@ void smv_conv3d_nhwc_vec_fxp(float16* host_inputs,
 void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
                                               float16* host_b,
                                               float16* host_results,
+                                              float16* host_bias,
                                               float* a,
                                               float* b,
                                               float* results,
@@ -48,7 +56,14 @@ void smv_matrix_multiply_transpose_nc_vec_fxp(float16* host_a,
                                               int result_start,
                                               bool accumulate,
                                               bool read_inputs,
+                                              bool read_weights,
                                               bool send_results,
+                                              float16* host_next_a,
+                                              float16* host_next_b,
+                                              float* next_a,
+                                              float* next_b,
+                                              int next_a_size,
+                                              int next_b_size,
                                               activation_type act_function,
                                               activation_param_t act_params,
                                               SamplingInfo* sampling);
@@ -142,13 +157,30 @@ void smv_softmax_nc_vec_fxp(float16* host_inputs,
                             int input_size,
                             int input_pad);
 
+void smv_softmax_online_nc_vec_fxp(float16* host_inputs,
+                                   float16* host_results,
+                                   float* inputs,
+                                   float* results,
+                                   float* running_stats,
+                                   int input_num,
+                                   int input_size,
+                                   int input_pad,
+                                   int first_tile,
+                                   int normalize);
+
 void smv_eltwise_add_nc_vec_fxp(float16* host_inputs0,
                                 float16* host_inputs1,
                                 float16* host_results,
                                 float* inputs0,
                                 float* inputs1,
                                 float* results,
-                                int inputs_size);
+                                int inputs_size,
+                                bool read_inputs,
+                                float16* host_next_inputs0,
+                                float16* host_next_inputs1,
+                                float* next_inputs0,
+                                float* next_inputs1,
+                                int next_inputs_size);
 
 void smv_eltwise_mul_nc_vec_fxp(float16* host_inputs0,
                                 float16* host_inputs1,
@@ -156,7 +188,13 @@ void smv_eltwise_mul_nc_vec_fxp(float16* host_inputs0,
                                 float* inputs0,
                                 float* inputs1,
                                 float* results,
-                                int inputs_size);
+                                int inputs_size,
+                                bool read_inputs,
+                                float16* host_next_inputs0,
+                                float16* host_next_inputs1,
+                                float* next_inputs0,
+                                float* next_inputs1,
+                                int next_inputs_size);
 
 void smv_less_nc_vec_fxp(float16* host_inputs0,
                          float16* host_inputs1,
@@ -120,7 +120,11 @@ void SmvPoolingOp::run() {
         tiledTensors[0].copyDataToAllTiles();
     }
 
-    runNHWC(tiledTensors[0], tiledTensors[1]);
+    {
+        auto profile = ScopedProfile(
+                profile::kKernelDispatch, profile::kPhase);
+        runNHWC(tiledTensors[0], tiledTensors[1]);
+    }
 
     {
         auto stats = gem5::ScopedStats(
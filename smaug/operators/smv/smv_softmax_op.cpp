@@ -8,30 +8,25 @@ void SmvSoftmaxOp::tile() {
     auto inputs = getInput(0);
     auto outputs = getOutput(0);
     const TensorShape& shape = inputs->getShape();
-    if (shape.getStorageDim(1) >
-        SmvBackend::SpadSize() / inputs->getDataTypeSize()) {
-        assert(false && "For softmax, a single tile must fit in the local "
-                        "scratchpad size!");
+    int maxSpadElems = SmvBackend::SpadSize() / inputs->getDataTypeSize();
+    TensorShape tileShape;
+    if (shape.getStorageDim(1) <= maxSpadElems) {
+        // We only need to tile on the N dimension.
+        int maxInputs =
+                std::min(maxSpadElems / shape.getStorageDim(1), shape[0]);
+        tileShape = TensorShape(
+                { maxInputs, shape[1] }, DataLayout::NC, SmvBackend::Alignment);
+    } else {
+        // A single input doesn't fit in the scratchpad, so we also tile on the
+        // class dimension and compute the softmax online (see runNC()).
+        tileShape = TensorShape(
+                { 1, maxSpadElems }, DataLayout::NC, SmvBackend::Alignment);
     }
-    // We can only tile on the N dimension.
-    int maxInputs =
-            std::min(SmvBackend::SpadSize() / inputs->getDataTypeSize() /
-                             shape.getStorageDim(1),
-                     shape[0]);
-    TensorShape tileShape(
-            { maxInputs, shape[1] }, DataLayout::NC, SmvBackend::Alignment);
     tiledTensors[0] = generateTiledTensor(inputs, tileShape, this);
     tiledTensors[1] = generateTiledTensor(outputs, tileShape, this);
 }
 
-void SmvSoftmaxOp::run() {
-    TiledTensor& inputs = tiledTensors[0];
-    TiledTensor& outputs = tiledTensors[1];
-    assert(inputs.size() == outputs.size());
-    setArrayMemTypeIfSimulating(
-            smv::kEltwiseOpHw, "host_inputs", getInputsMemType());
-    setArrayMemTypeIfSimulating(
-            smv::kEltwiseOpHw, "host_results", getOutputsMemType());
+void SmvSoftmaxOp::runN(TiledTensor& inputs, TiledTensor& outputs) {
     for (int i = 0; i < inputs.size(); i++) {
         dout(1) << "Input: " << i << ", output: " << i << "\n";
         Tensor* inputTile = inputs.getTileWithData(i);
@@ -49,6 +44,59 @@ void SmvSoftmaxOp::run() {
                      smv::spad0, smv::spad1, inputShape[0], inputShape[1],
                      inputShape.getPadding(1));
     }
+}
+
+void SmvSoftmaxOp::runNC(TiledTensor& inputs, TiledTensor& outputs) {
+    int inputNumTiles = inputs.getShape()[0];
+    int inputClassTiles = inputs.getShape()[1];
+    auto inputIdx = inputs.startIndex();
+    for (int N = 0; N < inputNumTiles; N++) {
+        // The first pass folds every class tile into the running maximum and
+        // denominator, which stay in spad2 between the invocations. The
+        // second pass normalizes the tiles with the final statistics.
+        for (int normalize = 0; normalize < 2; normalize++) {
+            for (int C = 0; C < inputClassTiles; C++) {
+                int tileIdx = inputIdx(N, C);
+                dout(1) << "Input: " << tileIdx << ", output: " << tileIdx
+                        << (normalize ? ", normalizing\n" : "\n");
+                Tensor* inputTile = inputs.getTileWithData(tileIdx);
+                Tensor* outputTile = outputs[tileIdx];
+                const TensorShape& inputShape = inputTile->getShape();
+                const TensorShape& outputShape = outputTile->getShape();
+                mapArrayToAccel(smv::kEltwiseOpHw, "host_inputs",
+                                inputTile->data<float16>(),
+                                inputShape.storageSize() * sizeof(float16));
+                mapArrayToAccel(smv::kEltwiseOpHw, "host_results",
+                                outputTile->data<float16>(),
+                                outputShape.storageSize() * sizeof(float16));
+                invokeKernel(smv::kEltwiseOpHw, smv_softmax_online_nc_vec_fxp,
+                             inputTile->data<float16>(),
+                             outputTile->data<float16>(), smv::spad0,
+                             smv::spad1, smv::spad2, inputShape[0],
+                             inputShape[1], inputShape.getPadding(1), C == 0,
+                             normalize);
+            }
+        }
+    }
+}
+
+void SmvSoftmaxOp::run() {
+    TiledTensor& inputs = tiledTensors[0];
+    TiledTensor& outputs = tiledTensors[1];
+    assert(inputs.size() == outputs.size());
+    setArrayMemTypeIfSimulating(
+            smv::kEltwiseOpHw, "host_inputs", getInputsMemType());
+    setArrayMemTypeIfSimulating(
+            smv::kEltwiseOpHw, "host_results", getOutputsMemType());
+    {
+        // Preparing the tiles is interleaved with the kernel invocations.
+        auto profile = ScopedProfile(
+                profile::kKernelDispatch, profile::kPhase);
+        if (inputs.getShape()[1] == 1)
+            runN(inputs, outputs);
+        else
+            runNC(inputs, outputs);
+    }
     {
         auto stats = gem5::ScopedStats(
                 stats::kTensorFinalStart, stats::kTensorFinalEnd);
@@ -7,7 +7,14 @@
 
 namespace smaug {
 
-/** Softmax operator on SMV. */
+/**
+ * Softmax operator on SMV.
+ *
+ * Inputs are tiled on the N dimension when a whole input fits in the
+ * scratchpad. Larger inputs, such as the output layers of language models with
+ * large vocabularies, are also tiled on the class dimension, and the softmax is
+ * computed online over the tiles.
+ */
 class SmvSoftmaxOp : public SoftmaxOp<SmvBackend> {
    public:
     using SoftmaxOp<SmvBackend>::SoftmaxOp;
@@ -15,6 +22,11 @@ class SmvSoftmaxOp : public SoftmaxOp<SmvBackend> {
     void run() override;
 
    protected:
+    /** Runs the softmax on tiles that contain whole inputs. */
+    void runN(TiledTensor& inputs, TiledTensor& outputs);
+    /** Runs the online softmax on tiles along the class dimension. */
+    void runNC(TiledTensor& inputs, TiledTensor& outputs);
+
     std::array<TiledTensor, 2> tiledTensors;
 };
 
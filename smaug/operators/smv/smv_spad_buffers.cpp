@@ -0,0 +1,53 @@
+#include "smaug/core/backend.h"
+#include "smaug/core/globals.h"
+#include "smaug/operators/smv/smv_spad_buffers.h"
+
+namespace smaug {
+
+SmvSpadBuffers::SmvSpadBuffers(float* _spad, int numBuffers)
+        : spad(_spad), tiles(numBuffers, -1), currBuffer(numBuffers - 1) {}
+
+int SmvSpadBuffers::getNumBuffers() { return useDoubleBufferedSpads ? 2 : 1; }
+
+int SmvSpadBuffers::getBufferSize() {
+    return SmvBackend::SpadSize() / getNumBuffers();
+}
+
+bool SmvSpadBuffers::holdsTile(int tileIdx) const {
+    return findTile(tileIdx) != -1;
+}
+
+float* SmvSpadBuffers::getBufferForTile(int tileIdx, bool* load) {
+    int buffer = findTile(tileIdx);
+    *load = buffer == -1;
+    if (*load) {
+        buffer = (currBuffer + 1) % tiles.size();
+        tiles[buffer] = tileIdx;
+    }
+    currBuffer = buffer;
+    return getBuffer(buffer);
+}
+
+float* SmvSpadBuffers::prefetchTile(int tileIdx) {
+    if (tiles.size() == 1 || findTile(tileIdx) != -1)
+        return nullptr;
+    int buffer = (currBuffer + 1) % tiles.size();
+    tiles[buffer] = tileIdx;
+    return getBuffer(buffer);
+}
+
+float* SmvSpadBuffers::getBuffer(int buffer) const {
+    // A buffer holds getBufferSize() bytes of float16 data, i.e. half as many
+    // elements, which the scratchpads store as float32.
+    return spad + buffer * (getBufferSize() / 2);
+}
+
+int SmvSpadBuffers::findTile(int tileIdx) const {
+    for (int i = 0; i < tiles.size(); i++) {
+        if (tiles[i] == tileIdx)
+            return i;
+    }
+    return -1;
+}
+
+}  // namespace smaug
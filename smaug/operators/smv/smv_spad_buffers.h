@@ -0,0 +1,81 @@
+#ifndef _OPERATORS_SMV_SMV_SPAD_BUFFERS_H_
+#define _OPERATORS_SMV_SMV_SPAD_BUFFERS_H_
+
+#include <vector>
+
+namespace smaug {
+
+/**
+ * Tracks the tiles held in the buffers of one scratchpad of an accelerator.
+ *
+ * Without double buffering, a scratchpad is a single buffer, and a tile needs
+ * to be loaded unless it is the tile loaded last. With double buffering
+ * (useDoubleBufferedSpads), the scratchpad is split into two buffers of
+ * getBufferSize(), which the tiling optimizers plan the tiles for. While an
+ * invocation computes on the tile in one buffer, it prefetches the tile of
+ * the next invocation into the other one, so that the transfer overlaps the
+ * computation and the next invocation does not load anything.
+ *
+ * To use:
+ *
+ * ```c
+ * SmvSpadBuffers inputBuffers(smv::spad0);
+ * for (int i = 0; i < tiles; i++) {
+ *    bool readInputs;
+ *    float* spad = inputBuffers.getBufferForTile(i, &readInputs);
+ *    float* nextSpad = nullptr;
+ *    if (i + 1 < tiles)
+ *        nextSpad = inputBuffers.prefetchTile(i + 1);
+ *    invokeKernel(..., spad, readInputs, nextSpad, ...);
+ * }
+ * ```
+ */
+class SmvSpadBuffers {
+   public:
+    SmvSpadBuffers(float* _spad, int numBuffers = getNumBuffers());
+
+    /** The number of buffers the double-buffered scratchpads are split into. */
+    static int getNumBuffers();
+
+    /**
+     * The size of one buffer, in bytes of float16 data like
+     * SmvBackend::SpadSize(). This bounds the tile sizes of the
+     * double-buffered operators.
+     */
+    static int getBufferSize();
+
+    /** Returns true if one of the buffers holds the tile. */
+    bool holdsTile(int tileIdx) const;
+
+    /**
+     * Returns the buffer that the current invocation computes on the given
+     * tile in. If no buffer holds the tile, it is assigned the buffer not used
+     * by the last invocation, and load is set to true.
+     */
+    float* getBufferForTile(int tileIdx, bool* load);
+
+    /**
+     * Assigns the tile to the buffer that the current invocation does not
+     * compute in, so that the invocation prefetches it. Returns nullptr if a
+     * buffer already holds the tile, or if there is no other buffer.
+     */
+    float* prefetchTile(int tileIdx);
+
+   protected:
+    /** Returns the buffer at the given index. */
+    float* getBuffer(int buffer) const;
+
+    /** Returns the buffer that holds the tile, or -1 if none does. */
+    int findTile(int tileIdx) const;
+
+    /** The scratchpad the buffers are carved out of. */
+    float* spad;
+    /** The tile held in every buffer, or -1 if there is none. */
+    std::vector<int> tiles;
+    /** The buffer the current invocation computes in. */
+    int currBuffer;
+};
+
+}  // namespace smaug
+
+#endif
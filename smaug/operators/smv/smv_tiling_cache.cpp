@@ -0,0 +1,147 @@
+#include <fstream>
+#include <sstream>
+
+#include "smaug/core/backend.h"
+#include "smaug/operators/smv/smv_spad_buffers.h"
+#include "smaug/operators/smv/smv_tiling_cache.h"
+#include "smaug/utility/debug_stream.h"
+
+namespace smaug {
+namespace smv {
+
+// Writes the shape as "layout alignment ndims dim...".
+static void writeShape(std::ostream& os, const TensorShape& shape) {
+    os << (int)shape.getLayout() << " " << shape.getAlignment() << " "
+       << shape.ndims();
+    for (int dim : shape.dims())
+        os << " " << dim;
+}
+
+static bool readShape(std::istream& is, TensorShape* shape) {
+    int layout, alignment, ndims;
+    if (!(is >> layout >> alignment >> ndims) || !DataLayout_IsValid(layout))
+        return false;
+    std::vector<int> dims(ndims);
+    for (int& dim : dims) {
+        if (!(is >> dim))
+            return false;
+    }
+    *shape = ndims == 0 ? TensorShape()
+                        : TensorShape(dims, (DataLayout)layout, alignment);
+    return true;
+}
+
+static bool readTilingDims(std::istream& is, TilingDims* dims) {
+    int value;
+    if (!(is >> value) || value < None || value > Invalid)
+        return false;
+    *dims = (TilingDims)value;
+    return true;
+}
+
+TilingPlanCache& TilingPlanCache::get() {
+    static TilingPlanCache cache;
+    return cache;
+}
+
+bool TilingPlanCache::find(const std::string& key, TilingConfig* config) {
+    auto it = plans.find(key);
+    if (it == plans.end()) {
+        numMisses++;
+        return false;
+    }
+    numHits++;
+    *config = it->second;
+    dout(2) << "  Reusing the cached tiling config: " << *config << "\n";
+    return true;
+}
+
+void TilingPlanCache::insert(const std::string& key,
+                             const TilingConfig& config) {
+    plans[key] = config;
+}
+
+void TilingPlanCache::clear() {
+    plans.clear();
+    numHits = 0;
+    numMisses = 0;
+}
+
+bool TilingPlanCache::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    // Every plan is a line with the key and the config separated by a tab.
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        size_t tab = line.find('\t');
+        if (tab == std::string::npos) {
+            clear();
+            return false;
+        }
+        std::istringstream config(line.substr(tab + 1));
+        TilingConfig plan;
+        if (!readTilingDims(config, &plan.inputTilingDims) ||
+            !readTilingDims(config, &plan.weightTilingDims) ||
+            !readTilingDims(config, &plan.outputTilingDims) ||
+            !readShape(config, &plan.inputs) ||
+            !readShape(config, &plan.weights) ||
+            !readShape(config, &plan.outputs)) {
+            clear();
+            return false;
+        }
+        plans[line.substr(0, tab)] = plan;
+    }
+    return true;
+}
+
+bool TilingPlanCache::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    file << "# SMAUG tiling plans\n";
+    for (auto& entry : plans) {
+        const TilingConfig& plan = entry.second;
+        // Only dense shapes are written, since the strides are not saved.
+        if (!plan.inputs.isContiguous() || !plan.weights.isContiguous() ||
+            !plan.outputs.isContiguous())
+            continue;
+        file << entry.first << "\t" << (int)plan.inputTilingDims << " "
+             << (int)plan.weightTilingDims << " "
+             << (int)plan.outputTilingDims << " ";
+        writeShape(file, plan.inputs);
+        file << " ";
+        writeShape(file, plan.weights);
+        file << " ";
+        writeShape(file, plan.outputs);
+        file << "\n";
+    }
+    return file.good();
+}
+
+std::string getTilingPlanKey(const Operator* op,
+                             const std::vector<Tensor*>& tensors,
+                             const std::vector<int>& params) {
+    std::ostringstream key;
+    key << "SMV spad:" << SmvBackend::SpadSize() << "/"
+        << SmvSpadBuffers::getNumBuffers() << " "
+        << OpType_Name(op->getOpType()) << " params:";
+    for (int param : params)
+        key << param << ",";
+    for (Tensor* tensor : tensors) {
+        const TensorShape& shape = tensor->getShape();
+        key << " " << DataType_Name(tensor->getDataType()) << ":";
+        writeShape(key, shape);
+        // Tensor views are not laid out contiguously, so their strides also
+        // determine the tile sizes.
+        if (!shape.isContiguous()) {
+            key << " strides";
+            for (int stride : shape.strides())
+                key << " " << stride;
+        }
+    }
+    return key.str();
+}
+
+}  // namespace smv
+}  // namespace smaug
@@ -0,0 +1,98 @@
+#ifndef _OPERATORS_SMV_SMV_TILING_CACHE_H_
+#define _OPERATORS_SMV_SMV_TILING_CACHE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "smaug/core/operator.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/smv/smv_tiling_common.h"
+
+namespace smaug {
+namespace smv {
+
+/**
+ * TilingPlanCache remembers the TilingConfig chosen for every operator
+ * signature.
+ *
+ * Searching for the best TilingConfig is deterministic: it only depends on
+ * the operator type, the shapes and data types of its tensors, its
+ * parameters (e.g. strides and padding) and the scratchpad size and
+ * buffers (see SmvSpadBuffers). The TilingOptimizers therefore look up a key
+ * made of these in the cache before enumerating the tiling configs, so
+ * identical layers only search once. The cache can be saved to a file and
+ * loaded by a later run to skip the search altogether.
+ */
+class TilingPlanCache {
+   public:
+    /** Returns the cache shared by all the SMV TilingOptimizers. */
+    static TilingPlanCache& get();
+
+    /**
+     * Looks up the TilingConfig of the given key.
+     *
+     * @return True if the key is in the cache, in which case config is set.
+     */
+    bool find(const std::string& key, TilingConfig* config);
+
+    void insert(const std::string& key, const TilingConfig& config);
+
+    /** Removes all the plans and resets the statistics. */
+    void clear();
+
+    int size() const { return plans.size(); }
+    int getNumHits() const { return numHits; }
+    int getNumMisses() const { return numMisses; }
+
+    /**
+     * Adds the plans saved in the given file to the cache. If the file is
+     * malformed, the cache is cleared, so that no partially loaded plans are
+     * used.
+     *
+     * @return False if the file cannot be read or is malformed.
+     */
+    bool load(const std::string& path);
+
+    /** Writes all the plans to the given file. */
+    bool save(const std::string& path) const;
+
+   protected:
+    TilingPlanCache() : numHits(0), numMisses(0) {}
+
+    std::map<std::string, TilingConfig> plans;
+    int numHits;
+    int numMisses;
+};
+
+/**
+ * Returns the key of the TilingConfig of an operator on SMV.
+ *
+ * @param op The operator being tiled.
+ * @param tensors The tensors the TilingConfig is computed from.
+ * @param params The operator parameters the TilingConfig depends on.
+ */
+std::string getTilingPlanKey(const Operator* op,
+                             const std::vector<Tensor*>& tensors,
+                             const std::vector<int>& params = {});
+
+/**
+ * Returns the cached TilingConfig of the given key, or computes it with
+ * computeFunc and caches it.
+ */
+template <typename ComputeFunc>
+TilingConfig findOrComputeTilingConfig(const std::string& key,
+                                       ComputeFunc computeFunc) {
+    TilingPlanCache& cache = TilingPlanCache::get();
+    TilingConfig config;
+    if (!cache.find(key, &config)) {
+        config = computeFunc();
+        cache.insert(key, config);
+    }
+    return config;
+}
+
+}  // namespace smv
+}  // namespace smaug
+
+#endif
@@ -0,0 +1,141 @@
+#include <cstdio>
+#include <fstream>
+
+#include "catch.hpp"
+#include "smaug/core/backend.h"
+#include "smaug/core/smaug_test.h"
+#include "smaug/core/tensor.h"
+#include "smaug/operators/smv/smv_convolution_op.h"
+#include "smaug/operators/smv/smv_convolution_tiling.h"
+#include "smaug/operators/smv/smv_pooling_op.h"
+#include "smaug/operators/smv/smv_pooling_tiling.h"
+#include "smaug/operators/smv/smv_tiling_cache.h"
+
+using namespace smaug;
+using namespace smaug::smv;
+
+static SmvConvolutionOp* createConvOp(const std::string& name,
+                                      Workspace* workspace) {
+    auto convOp = new SmvConvolutionOp(name, workspace);
+    convOp->setStride(1, 1);
+    convOp->setPadding(SamePadding);
+    TensorShape inputShape(
+            { 1, 32, 64, 16 }, DataLayout::NHWC, SmvBackend::Alignment);
+    Tensor* inputs = new Tensor(name + "/inputs", inputShape);
+    workspace->addTensor(inputs);
+    convOp->setInput(inputs, 0);
+    convOp->setWeightDims(3, 3, 8);
+    convOp->createAllTensors();
+    return convOp;
+}
+
+static void verifySameTiles(const std::array<TiledTensor, 3>& tiles0,
+                            const std::array<TiledTensor, 3>& tiles1) {
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(tiles0[i].size() == tiles1[i].size());
+        for (int j = 0; j < tiles0[i].size(); j++) {
+            REQUIRE(tiles0[i][j]->getShape().dims() ==
+                    tiles1[i][j]->getShape().dims());
+        }
+    }
+}
+
+static void verifySameConfig(const TilingConfig& config0,
+                             const TilingConfig& config1) {
+    REQUIRE(config0.inputs == config1.inputs);
+    REQUIRE(config0.weights == config1.weights);
+    REQUIRE(config0.outputs == config1.outputs);
+    REQUIRE(config0.inputs.getAlignment() == config1.inputs.getAlignment());
+    REQUIRE(config0.inputTilingDims == config1.inputTilingDims);
+    REQUIRE(config0.weightTilingDims == config1.weightTilingDims);
+    REQUIRE(config0.outputTilingDims == config1.outputTilingDims);
+}
+
+TEST_CASE_METHOD(SmaugTest, "Tiling plan cache", "[smvtiling]") {
+    TilingPlanCache& cache = TilingPlanCache::get();
+    cache.clear();
+
+    SECTION("Identical layers share the same plan") {
+        auto convOp0 = createConvOp("conv0", workspace());
+        auto convOp1 = createConvOp("conv1", workspace());
+        allocateAllTensors<float16>(convOp0);
+        allocateAllTensors<float16>(convOp1);
+        auto tiles0 = conv::TilingOptimizer::doTiling(convOp0);
+        REQUIRE(cache.getNumMisses() == 1);
+        REQUIRE(cache.getNumHits() == 0);
+        auto tiles1 = conv::TilingOptimizer::doTiling(convOp1);
+        REQUIRE(cache.getNumMisses() == 1);
+        REQUIRE(cache.getNumHits() == 1);
+        REQUIRE(cache.size() == 1);
+        verifySameTiles(tiles0, tiles1);
+
+        // A different stride is a different plan.
+        auto convOp2 = createConvOp("conv2", workspace());
+        convOp2->setStride(2, 2);
+        REQUIRE(getTilingPlanKey(convOp0,
+                                 { convOp0->getInput(0), convOp0->getInput(1),
+                                   convOp0->getOutput(0) },
+                                 { 1, 1, SamePadding, false }) !=
+                getTilingPlanKey(convOp2,
+                                 { convOp2->getInput(0), convOp2->getInput(1),
+                                   convOp2->getOutput(0) },
+                                 { 2, 2, SamePadding, false }));
+    }
+
+    SECTION("Plans are saved and loaded") {
+        auto convOp = createConvOp("conv", workspace());
+        allocateAllTensors<float16>(convOp);
+        conv::TilingOptimizer::doTiling(convOp);
+        auto poolOp = new SmvMaxPoolingOp("pool", workspace());
+        poolOp->setPoolingSize(2, 2);
+        poolOp->setPoolingStride(2, 2);
+        poolOp->setInput(convOp->getOutput(0), 0);
+        poolOp->createAllTensors();
+        poolOp->getOutput(0)->allocateStorage<float16>();
+        pool::TilingOptimizer::doTiling(poolOp);
+        REQUIRE(cache.size() == 2);
+
+        std::string path = "smv_tiling_cache_test.txt";
+        REQUIRE(cache.save(path));
+        std::vector<std::string> keys = {
+            getTilingPlanKey(convOp,
+                             { convOp->getInput(0), convOp->getInput(1),
+                               convOp->getOutput(0) },
+                             { 1, 1, SamePadding, false }),
+            getTilingPlanKey(poolOp,
+                             { poolOp->getInput(0), poolOp->getOutput(0) },
+                             { 2, 2, 2, 2 })
+        };
+        std::vector<TilingConfig> configs(2);
+        for (int i = 0; i < 2; i++)
+            REQUIRE(cache.find(keys[i], &configs[i]));
+
+        cache.clear();
+        REQUIRE(cache.load(path));
+        std::remove(path.c_str());
+        REQUIRE(cache.size() == 2);
+        for (int i = 0; i < 2; i++) {
+            TilingConfig loaded;
+            REQUIRE(cache.find(keys[i], &loaded));
+            verifySameConfig(loaded, configs[i]);
+        }
+        REQUIRE(cache.getNumMisses() == 0);
+    }
+
+    SECTION("Malformed files clear the cache") {
+        auto convOp = createConvOp("conv", workspace());
+        allocateAllTensors<float16>(convOp);
+        conv::TilingOptimizer::doTiling(convOp);
+        std::string path = "smv_tiling_cache_test.txt";
+        REQUIRE(cache.save(path));
+        {
+            std::ofstream file(path, std::ios::out | std::ios::app);
+            file << "key\t0 0 0 not a shape\n";
+        }
+        REQUIRE(!cache.load(path));
+        std::remove(path.c_str());
+        REQUIRE(cache.size() == 0);
+    }
+
+    cache.clear();
+}
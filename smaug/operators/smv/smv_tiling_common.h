@@ -31,7 +31,9 @@ struct TilingConfig {
     TilingConfig(TensorShape _inputs = TensorShape(),
                  TensorShape _weights = TensorShape(),
                  TensorShape _outputs = TensorShape())
-            : inputs(_inputs), weights(_weights), outputs(_outputs) {}
+            : inputs(_inputs), weights(_weights), outputs(_outputs),
+              inputTilingDims(None), weightTilingDims(None),
+              outputTilingDims(None) {}
 
     int getTotalSize() const {
         return inputs.storageSize() + weights.storageSize() +
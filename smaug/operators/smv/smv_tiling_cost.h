@@ -0,0 +1,77 @@
+#ifndef _OPERATORS_SMV_SMV_TILING_COST_H_
+#define _OPERATORS_SMV_SMV_TILING_COST_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "smaug/operators/smv/smv_tiling_common.h"
+
+namespace smaug {
+namespace smv {
+
+/**
+ * The estimated cost of running an operator with a TilingConfig.
+ */
+struct TilingCost {
+    TilingCost() : inputBytes(0), weightBytes(0), outputBytes(0),
+                   numInvocations(0) {}
+
+    int64_t getDmaBytes() const {
+        return inputBytes + weightBytes + outputBytes;
+    }
+
+    /** Bytes of input tiles loaded into the scratchpads. */
+    int64_t inputBytes;
+    /** Bytes of weight tiles loaded into the scratchpads. */
+    int64_t weightBytes;
+    /** Bytes of output tiles sent back from the scratchpads. */
+    int64_t outputBytes;
+    /** The number of kernel invocations. */
+    int numInvocations;
+};
+
+/**
+ * A TilingCostModel ranks the candidate TilingConfigs of an operator, so that
+ * the TilingOptimizers can choose the best one.
+ */
+class TilingCostModel {
+   public:
+    virtual ~TilingCostModel() {}
+
+    /** Returns true if config0 is expected to run faster than config1. */
+    virtual bool isCheaper(const TilingConfig& config0,
+                           const TilingConfig& config1) const = 0;
+
+    /**
+     * Returns the index of the cheapest config. Of equally cheap configs, the
+     * first one is returned.
+     */
+    virtual int findCheapest(const std::vector<TilingConfig>& configs) const {
+        auto bestIt = std::min_element(
+                configs.begin(), configs.end(),
+                [&](const TilingConfig& c0, const TilingConfig& c1) {
+                    return isCheaper(c0, c1);
+                });
+        assert(bestIt != configs.end() && "Failed to get best tiling config!");
+        return bestIt - configs.begin();
+    }
+};
+
+/**
+ * The default cost model, which prefers the TilingConfig that fills up the
+ * scratchpads the most.
+ */
+class SpadUtilizationCostModel : public TilingCostModel {
+   public:
+    bool isCheaper(const TilingConfig& config0,
+                   const TilingConfig& config1) const override {
+        return config0.getTotalSize() > config1.getTotalSize();
+    }
+};
+
+}  // namespace smv
+}  // namespace smaug
+
+#endif
@@ -104,7 +104,11 @@ void run(UnaryOp<SmvBackend>* op, std::array<TiledTensor, 2>& tiledTensors) {
         tiledTensors[0].copyDataToAllTiles();
     }
 
-    runX(op, tiledTensors[0], tiledTensors[1]);
+    {
+        auto profile = ScopedProfile(
+                profile::kKernelDispatch, profile::kPhase);
+        runX(op, tiledTensors[0], tiledTensors[1]);
+    }
 
     {
         auto stats = gem5::ScopedStats(
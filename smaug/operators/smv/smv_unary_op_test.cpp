@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
 #include "catch.hpp"
 #include "smaug/core/backend.h"
 #include "smaug/core/tensor.h"
@@ -8,6 +13,7 @@
 #include "smaug/operators/smv/smv_tanh_op.h"
 #include "smaug/operators/smv/smv_sigmoid_op.h"
 #include "smaug/operators/smv/smv_softmax_op.h"
+#include "smaug/operators/smv/kernels/activation_functions_simd.h"
 
 using namespace smaug;
 
@@ -83,7 +89,7 @@ class SmvUnaryOpTest : public SmaugTest {
             seluOp->setLambda(1.0507);
             unaryOp = seluOp;
         } else if (opType == OpType::Tanh) {
-            unaryOp = new SmvSeluOp("tanh", workspace());
+            unaryOp = new SmvTanhOp("tanh", workspace());
         } else if (opType == OpType::Sigmoid) {
             unaryOp = new SmvSigmoidOp("sigmoid", workspace());
         } else if (opType == OpType::Softmax) {
@@ -167,3 +173,79 @@ TEST_CASE_METHOD(SmvUnaryOpTest, "SMV Tiled 2D Activations", "[smvunary]") {
     }
 }
 
+// Returns the distance between two floats in units in the last place.
+static int64_t ulpDistance(float a, float b) {
+    if (std::isnan(a) || std::isnan(b))
+        return std::isnan(a) && std::isnan(b) ? 0 : INT32_MAX;
+    int32_t aBits, bBits;
+    memcpy(&aBits, &a, sizeof(float));
+    memcpy(&bBits, &b, sizeof(float));
+    // Map the sign-magnitude representation onto a monotonic integer line.
+    int64_t aOrd = aBits < 0 ? (int64_t)INT32_MIN - aBits : aBits;
+    int64_t bOrd = bBits < 0 ? (int64_t)INT32_MIN - bBits : bBits;
+    return std::abs(aOrd - bOrd);
+}
+
+// Checks a vectorized function against libm over [min, max), and returns the
+// maximum error in ULP.
+template <typename VecFunc, typename RefFunc>
+static int64_t checkVecFunction(
+        VecFunc vecFunc, RefFunc refFunc, float min, float max, float step) {
+    int64_t maxUlp = 0;
+    for (float x = min; x < max; x += step * VECTOR_SIZE) {
+        v8fp_t inputs;
+        for (int i = 0; i < VECTOR_SIZE; i++)
+            inputs[i] = x + i * step;
+        v8fp_t results = vecFunc(inputs);
+        for (int i = 0; i < VECTOR_SIZE; i++) {
+            maxUlp = std::max(maxUlp,
+                              ulpDistance(results[i], refFunc(inputs[i])));
+        }
+    }
+    return maxUlp;
+}
+
+TEST_CASE("SMV vectorized exp/sigmoid/tanh", "[smvunary]") {
+    auto sigmoid = [](float x) { return 1.0f / (1.0f + expf(-x)); };
+    SECTION("Exp") {
+        REQUIRE(checkVecFunction(exp_vec_unit, expf, -110, 90, 1e-3) <= 1);
+        REQUIRE(checkVecFunction(exp_vec_unit, expf, -1, 1, 1e-6) <= 1);
+    }
+    SECTION("Sigmoid") {
+        REQUIRE(checkVecFunction(sigmoid_vec_unit, sigmoid, -110, 110, 1e-3) <=
+                4);
+        REQUIRE(checkVecFunction(sigmoid_vec_unit, sigmoid, -1, 1, 1e-6) <= 4);
+    }
+    SECTION("Tanh") {
+        REQUIRE(checkVecFunction(tanh_vec_unit, tanhf, -20, 20, 1e-4) <= 2);
+        REQUIRE(checkVecFunction(tanh_vec_unit, tanhf, -1, 1, 1e-6) <= 2);
+    }
+    SECTION("Special values") {
+        float inf = std::numeric_limits<float>::infinity();
+        float nan = std::numeric_limits<float>::quiet_NaN();
+        v8fp_t inputs = { inf, -inf, nan, 0, -0.0f, 1000, -1000, 1e-30f };
+        v8fp_t exps = exp_vec_unit(inputs);
+        v8fp_t sigmoids = sigmoid_vec_unit(inputs);
+        v8fp_t tanhs = tanh_vec_unit(inputs);
+        for (int i = 0; i < VECTOR_SIZE; i++) {
+            REQUIRE(ulpDistance(exps[i], expf(inputs[i])) == 0);
+            REQUIRE(ulpDistance(sigmoids[i], sigmoid(inputs[i])) == 0);
+            REQUIRE(ulpDistance(tanhs[i], tanhf(inputs[i])) == 0);
+        }
+    }
+}
+
+TEST_CASE_METHOD(SmvUnaryOpTest, "SMV Online Softmax", "[smvunary]") {
+    // A single input doesn't fit in the scratchpad, so every input is tiled
+    // along the classes.
+    SECTION("Class tiles have the same shape") {
+        doTest(OpType::Softmax, { 1, 32768 });
+        doTest(OpType::Softmax, { 2, 49152 });
+    }
+    SECTION("Last class tile has a different shape") {
+        doTest(OpType::Softmax, { 3, 20000 });
+    }
+    SECTION("Last class tile has padding") {
+        doTest(OpType::Softmax, { 2, 33002 });
+    }
+}
@@ -60,8 +60,10 @@ class SplitOp : public Operator {
     }
 
     void createAllTensors() override {
-        std::vector<int> dims = getInput(0)->getShape().dims();
-        DataLayout layout = getInput(0)->getShape().getLayout();
+        Tensor* input = getInput(0);
+        const TensorShape& inputShape = input->getShape();
+        std::vector<int> dims = inputShape.dims();
+        DataLayout layout = inputShape.getLayout();
         for (int i = 0; i < splits.size(); i++) {
             dims[splitAxis] = splits[i];
             TensorShape shape(dims, layout, Backend::Alignment);
@@ -69,6 +71,29 @@ class SplitOp : public Operator {
             workspace->addTensor(output);
             outputs.at(i) = output;
         }
+        createTensorViews();
+    }
+
+    /**
+     * If every output is a contiguous region of the input, the outputs are
+     * made views of the input, so no data is copied.
+     */
+    void createTensorViews() override {
+        Tensor* input = getInput(0);
+        const TensorShape& inputShape = input->getShape();
+        if (!isSplitContiguous(inputShape))
+            return;
+        int lastDim = inputShape.ndims() - 1;
+        int offset = 0;
+        for (int i = 0; i < getOutputs().size(); i++) {
+            Tensor* output = getOutput(i);
+            const TensorShape& shape = output->getShape();
+            if (!output->isView() && !output->containsData() &&
+                shape.getPadding(lastDim) == inputShape.getPadding(lastDim)) {
+                output->setView(input, offset);
+            }
+            offset += shape.storageSize();
+        }
     }
 
     void run() override {
@@ -77,6 +102,10 @@ class SplitOp : public Operator {
         std::vector<int> srcOrigin(ndims, 0);
         for (int i = 0; i < getOutputs().size(); i++) {
             Tensor* output = getOutput(i);
+            if (output->getViewBase() == input) {
+                srcOrigin[splitAxis] += output->dim(splitAxis);
+                continue;
+            }
             copyTensorRegion(output,
                              input,
                              std::vector<int>(ndims, 0),
@@ -87,6 +116,21 @@ class SplitOp : public Operator {
     }
 
    protected:
+    /**
+     * Returns true if splitting a Tensor of the given shape yields contiguous
+     * regions of it: all the dimensions outside of the split axis must be 1,
+     * and the split axis must not be the innermost, padded dimension.
+     */
+    bool isSplitContiguous(const TensorShape& shape) const {
+        if (splitAxis >= shape.ndims() - 1)
+            return false;
+        for (int i = 0; i < splitAxis; i++) {
+            if (shape[i] != 1)
+                return false;
+        }
+        return true;
+    }
+
     int splitAxis;
     std::vector<int> splits;
 };
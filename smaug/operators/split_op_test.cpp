@@ -111,6 +111,10 @@ TEST_CASE_METHOD(SmaugTest, "Split a 2D tensor", "[refop]") {
         };
         REQUIRE(output0->getShape().dims() == std::vector<int>{ 1, 4 });
         REQUIRE(output1->getShape().dims() == std::vector<int>{ 3, 4 });
+        // Splitting the outermost dimension creates views of the input.
+        REQUIRE(output0->getViewBase() == input);
+        REQUIRE(output1->getViewBase() == input);
+        REQUIRE(output1->data<float>() == input->data<float>() + 4);
         verifyOutputs(output0, expectedValues0);
         verifyOutputs(output1, expectedValues1);
     }
@@ -134,6 +138,8 @@ TEST_CASE_METHOD(SmaugTest, "Split a 2D tensor", "[refop]") {
         };
         REQUIRE(output0->getShape().dims() == std::vector<int>{ 4, 3 });
         REQUIRE(output1->getShape().dims() == std::vector<int>{ 4, 1 });
+        REQUIRE(!output0->isView());
+        REQUIRE(!output1->isView());
         verifyOutputs(output0, expectedValues0);
         verifyOutputs(output1, expectedValues1);
     }
@@ -8,6 +8,7 @@ from smaug.core import types_pb2
 from smaug.core import tensor_pb2
 from smaug.python import global_vars
 from smaug.python.node import Node
+from smaug.python.param_container import write_param_container
 from smaug.python.tensor import Tensor
 
 class Graph:
@@ -182,21 +183,27 @@ class Graph:
       graph_proto.nodes.append(node.to_proto(tensor_data_array))
     return graph_proto, tensor_data_array
 
-  def write_graph(self, name=None):
+  def write_graph(self, name=None, param_container=False):
     """Serialize the graph to a protobuf file.
 
     Args:
       name: Name of the output protobuf file. If not specified, use the graph's
             name instead.
+      param_container: If True, write the parameters into a memory-mappable
+            parameter container (`<name>_params.bin`) instead of a protobuf
+            (`<name>_params.pb`).
     """
     graph_proto, tensor_data_array = self.to_proto()
     if name is None:
       name = self._name
     topo_name = name + "_topo.pbtxt"
-    params_name = name + "_params.pb"
-    with open(topo_name, "w") as f_topo, open(params_name, "wb") as f_params:
+    with open(topo_name, "w") as f_topo:
       f_topo.write(text_format.MessageToString(graph_proto))
-      f_params.write(tensor_data_array.SerializeToString())
+    if param_container:
+      write_param_container(tensor_data_array, name + "_params.bin")
+    else:
+      with open(name + "_params.pb", "wb") as f_params:
+        f_params.write(tensor_data_array.SerializeToString())
 
   def print_summary(self):
     """Print the summary of the graph.
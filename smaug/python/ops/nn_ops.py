@@ -28,6 +28,33 @@ def convolution(
     activation_params: kwargs for the activation function (optional).
     name: Operator name (optional).
   """
+  return _convolution_common(
+      input_tensor, filter_tensor, stride, padding, activation,
+      activation_params, types_pb2.Convolution3d, name)
+
+def depthwise_convolution(
+    input_tensor, filter_tensor, stride, padding, activation=None,
+    activation_params=None, name="depthwise_conv"):
+  """Compute a depthwise convolution given 4D `input_tensor` and
+  `filter_tensor`.
+
+  Every input channel is convolved with its own 2D filter, so the output has
+  the same number of channels as the input.
+
+  Args:
+    input_tensor: A 4D `Tensor`.
+    filter_tensor: A 4D `Tensor` with one filter per input channel, e.g. shaped
+      [1, channels, rows, cols] in NCHW.
+    stride/padding/activation/activation_params: See `convolution`.
+    name: Operator name (optional).
+  """
+  return _convolution_common(
+      input_tensor, filter_tensor, stride, padding, activation,
+      activation_params, types_pb2.ConvolutionDepthwise, name)
+
+def _convolution_common(
+    input_tensor, filter_tensor, stride, padding, activation,
+    activation_params, op, name):
   def compute_output_dim(input_dim, weight_dim, stride, padding):
     pad = 0
     if to_padding_type(padding) == types_pb2.SamePadding:
@@ -35,8 +62,7 @@ def convolution(
     return (input_dim - weight_dim + pad) // stride + 1
 
   input_tensor, filter_tensor = array_ops.check_and_add_layout_transform(
-      name=name, op=types_pb2.Convolution3d,
-      input_tensors=[input_tensor, filter_tensor])
+      name=name, op=op, input_tensors=[input_tensor, filter_tensor])
 
   row_idx = 2 if input_tensor.shape.layout == types_pb2.NCHW else 1
   col_idx = 3 if input_tensor.shape.layout == types_pb2.NCHW else 2
@@ -49,16 +75,18 @@ def convolution(
   output_cols = compute_output_dim(input_tensor.shape.dims[col_idx],
                                    filter_tensor.shape.dims[col_idx], stride[1],
                                    padding)
+  if op == types_pb2.ConvolutionDepthwise:
+    output_chans = input_tensor.shape.dims[chan_idx]
+  else:
+    output_chans = filter_tensor.shape.dims[0]
   output_layout = input_tensor.shape.layout
   if output_layout == types_pb2.NCHW:
     output_tensor_dims = [
-        input_tensor.shape.dims[0], filter_tensor.shape.dims[0], output_rows,
-        output_cols
+        input_tensor.shape.dims[0], output_chans, output_rows, output_cols
     ]
   elif output_layout == types_pb2.NHWC:
     output_tensor_dims = [
-        input_tensor.shape.dims[0], output_rows, output_cols,
-        filter_tensor.shape.dims[0]
+        input_tensor.shape.dims[0], output_rows, output_cols, output_chans
     ]
   else:
     assert False, "Unsupported output layout!"
@@ -69,8 +97,7 @@ def convolution(
     params.act_params.CopyFrom(
         activation_ops.to_proto(activation, activation_params))
   return common.add_node(
-      name=name, op=types_pb2.Convolution3d,
-      input_tensors=[input_tensor, filter_tensor],
+      name=name, op=op, input_tensors=[input_tensor, filter_tensor],
       output_tensors_dims=[output_tensor_dims],
       output_tensor_layout=output_layout, params=params)[0]
 
@@ -125,11 +152,27 @@ def max_pool(input_tensor, pool_size, stride, name="max_pool"):
     stride: A list of two integers: [row_stride, col_stride].
     name: Operator name (optional).
   """
+  return _pooling_common(
+      input_tensor, pool_size, stride, types_pb2.MaxPooling, name)
+
+def avg_pool(input_tensor, pool_size, stride, name="avg_pool"):
+  """Compute average pooling.
+
+  Args:
+    input_tensor: A 4D `Tensor`.
+    pool_size: A list of two integers: [pool_rows, pool_cols].
+    stride: A list of two integers: [row_stride, col_stride].
+    name: Operator name (optional).
+  """
+  return _pooling_common(
+      input_tensor, pool_size, stride, types_pb2.AveragePooling, name)
+
+def _pooling_common(input_tensor, pool_size, stride, op, name):
   def compute_output_dim(input_dim, pool_size, stride):
     return (input_dim - pool_size) // stride + 1
 
   input_tensor = array_ops.check_and_add_layout_transform(
-      name=name, op=types_pb2.MaxPooling, input_tensors=[input_tensor])[0]
+      name=name, op=op, input_tensors=[input_tensor])[0]
 
   row_idx = 2 if input_tensor.shape.layout == types_pb2.NCHW else 1
   col_idx = 3 if input_tensor.shape.layout == types_pb2.NCHW else 2
@@ -152,7 +195,7 @@ def max_pool(input_tensor, pool_size, stride, name="max_pool"):
   params.pool_params.stride.extend(stride)
   params.pool_params.pool_size.extend(pool_size)
   return common.add_node(
-      name=name, op=types_pb2.MaxPooling, input_tensors=[input_tensor],
+      name=name, op=op, input_tensors=[input_tensor],
       output_tensors_dims=[output_tensor_dims],
       output_tensor_layout=output_layout, params=params)[0]
 
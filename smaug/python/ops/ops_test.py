@@ -951,5 +951,49 @@ class RefResidualGraphTest(unittest.TestCase, ResidualGraphTest):
     node = self.get_node("mul1")
     self.assertEqual(node.parents, ["add1", "add2"])
 
+class DepthwiseConvAvgPoolTest(unittest.TestCase):
+  """Test the depthwise convolution and average pooling operators."""
+
+  def build_graph(self, backend):
+    np_dtype = test_backend_dtypes[backend]
+    with Graph(name="test_depthwise_graph", backend=backend) as graph:
+      input_tensor = Tensor(
+          data_layout=types_pb2.NCHW,
+          tensor_data=np.random.rand(1, 32, 28, 28).astype(np_dtype))
+      filter_tensor = Tensor(
+          data_layout=types_pb2.NCHW,
+          tensor_data=np.random.rand(1, 32, 3, 3).astype(np_dtype))
+      out = data_op.input_data(input_tensor, "input")
+      out = nn_ops.depthwise_convolution(
+          out, filter_tensor, stride=[2, 2], padding="same", name="dw_conv")
+      out = nn_ops.avg_pool(out, pool_size=[2, 2], stride=[2, 2], name="pool")
+    return graph.to_proto()[0]
+
+  def test_depthwise_convolution_op(self):
+    for backend in ["Reference", "SMV"]:
+      expected_layout = global_vars.backend_layouts[backend][
+          types_pb2.ConvolutionDepthwise].output_layoutset.layouts
+      node = get_node_proto(self.build_graph(backend), "dw_conv")
+      self.assertEqual(node.op, types_pb2.ConvolutionDepthwise)
+      self.assertEqual(node.params.conv_params.padding, types_pb2.SamePadding)
+      self.assertEqual(node.params.conv_params.stride, [2, 2])
+      # The channels of the inputs are kept.
+      output = node.output_tensors[0]
+      self.assertEqual(output.shape.layout, expected_layout)
+      OperatorTest.assertEqualDims(
+          self, output.shape.dims, output.shape.layout, [1, 32, 14, 14],
+          types_pb2.NCHW)
+
+  def test_avg_pool_op(self):
+    for backend in ["Reference", "SMV"]:
+      node = get_node_proto(self.build_graph(backend), "pool")
+      self.assertEqual(node.op, types_pb2.AveragePooling)
+      self.assertEqual(node.params.pool_params.stride, [2, 2])
+      self.assertEqual(node.params.pool_params.pool_size, [2, 2])
+      output = node.output_tensors[0]
+      OperatorTest.assertEqualDims(
+          self, output.shape.dims, output.shape.layout, [1, 32, 7, 7],
+          types_pb2.NCHW)
+
 if __name__ == "__main__":
   unittest.main()
@@ -42,8 +42,9 @@ class LSTM:
     outputs_expand = []
     for o in outputs:
       # output is shaped [batch, depth], expand it with the time dimension.
-      outputs_expand.append(expand_dims(o, 1, name=self.name + "expand_dims"))
-    return concat(outputs_expand, 1, name=self.name + "concat")
+      outputs_expand.append(
+          array_ops.expand_dims(o, 1, name=self.name + "expand_dims"))
+    return array_ops.concat(outputs_expand, 1, name=self.name + "concat")
 
   def __call__(self, input_tensor, concat_output=False):
     """Invoke this cell repeatedly until finishing inputs.
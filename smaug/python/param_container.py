@@ -0,0 +1,94 @@
+"""Writes model parameters into a memory-mappable parameter container.
+
+A parameter container stores the raw payload of every tensor, aligned to 64
+bytes, after an index of the tensors. SMAUG maps it into memory and uses the
+tensors in place, instead of parsing and copying a `TensorDataArray`. See
+smaug/core/param_container.h for the file format.
+"""
+
+import argparse
+import struct
+import numpy as np
+
+from smaug.core import types_pb2
+from smaug.core import tensor_pb2
+
+MAGIC = b"SMAUGPRM"
+VERSION = 1
+PAYLOAD_ALIGNMENT = 64
+
+# The fields of `TensorData` along with the type of their payloads. Half
+# precision data is packed into pairs within int32 values, so its raw bytes are
+# already the fp16 values.
+_data_fields = [
+    ("half_data", types_pb2.Float16, np.int32),
+    ("float_data", types_pb2.Float32, np.float32),
+    ("double_data", types_pb2.Float64, np.float64),
+    ("int_data", types_pb2.Int32, np.int32),
+    ("int64_data", types_pb2.Int64, np.int64),
+    ("bool_data", types_pb2.Bool, np.bool_),
+]
+
+def _get_payload(tensor_data):
+  """Return a tuple of (data type, payload bytes) of a `TensorData`.
+
+  None is returned if the `TensorData` contains no data.
+  """
+  for field, data_type, np_type in _data_fields:
+    values = getattr(tensor_data, field)
+    if len(values) > 0:
+      dtype = np.dtype(np_type).newbyteorder("<")
+      return data_type, np.array(values, dtype=dtype).tobytes()
+  return None
+
+def _padding(offset):
+  return (PAYLOAD_ALIGNMENT - offset % PAYLOAD_ALIGNMENT) % PAYLOAD_ALIGNMENT
+
+def write_param_container(tensor_data_array, filename):
+  """Write the tensors in a `TensorDataArray` into a parameter container.
+
+  Args:
+    tensor_data_array: The `TensorDataArray` to write.
+    filename: Name of the output file.
+  """
+  names = []
+  payloads = []
+  for tensor_data in tensor_data_array.data_array:
+    payload = _get_payload(tensor_data)
+    if payload is not None:
+      names.append(tensor_data.name.encode())
+      payloads.append(payload)
+
+  # The header and the index come first, followed by the aligned payloads.
+  index_size = len(MAGIC) + 8 + sum(len(name) + 24 for name in names)
+  offset = index_size + _padding(index_size)
+  header = [MAGIC, struct.pack("<II", VERSION, len(names))]
+  offsets = []
+  for name, (data_type, payload) in zip(names, payloads):
+    header.append(struct.pack("<I", len(name)) + name)
+    header.append(struct.pack("<IQQ", data_type, offset, len(payload)))
+    offsets.append(offset)
+    offset += len(payload)
+    offset += _padding(offset)
+
+  with open(filename, "wb") as f:
+    f.write(b"".join(header))
+    for offset, (_, payload) in zip(offsets, payloads):
+      f.write(b"\0" * (offset - f.tell()))
+      f.write(payload)
+
+def convert(params_file, container_file):
+  """Convert a serialized `TensorDataArray` into a parameter container."""
+  tensor_data_array = tensor_pb2.TensorDataArray()
+  with open(params_file, "rb") as f:
+    tensor_data_array.ParseFromString(f.read())
+  write_param_container(tensor_data_array, container_file)
+
+if __name__ == "__main__":
+  parser = argparse.ArgumentParser(
+      description="Convert a model parameters protobuf into a parameter "
+      "container.")
+  parser.add_argument("params_file", help="The model parameters protobuf.")
+  parser.add_argument("container_file", help="The output parameter container.")
+  args = parser.parse_args()
+  convert(args.params_file, args.container_file)
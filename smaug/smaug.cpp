@@ -1,14 +1,20 @@
+#include <algorithm>
+#include <dirent.h>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
 #include "core/backend.h"
+#include "core/batched_inference.h"
 #include "core/globals.h"
 #include "core/scheduler.h"
 #include "core/network_builder.h"
 #include "operators/common.h"
+#include "operators/smv/smv_tiling_cache.h"
 #include "utility/debug_stream.h"
+#include "utility/profiler.h"
 #include "utility/utils.h"
 #include "utility/thread_pool.h"
 
@@ -16,11 +22,81 @@ namespace po = boost::program_options;
 
 using namespace smaug;
 
+// Serializes the tensor into a TensorProto file.
+static bool writeTensorProto(Tensor* tensor, const std::string& path) {
+    std::fstream outfile(
+            path, std::ios::out | std::ios::trunc | std::ios::binary);
+    TensorProto* tensorProto = tensor->asTensorProto();
+    bool success = tensorProto->SerializeToOstream(&outfile);
+    if (!success) {
+        std::cerr << "Failed to serialize the output tensor and write it to "
+                     "the given C++ ostream! Did you run out of disk space?\n";
+    }
+    delete tensorProto;
+    return success;
+}
+
+// Runs the network once for every serialized TensorProto in inputDir, in the
+// order of their file names, and reports the latencies and the throughput.
+static int runBatchedInference(Network* network,
+                               Workspace* workspace,
+                               bool concurrentScheduling,
+                               const std::string& inputDir,
+                               const std::string& outputDir) {
+    std::vector<std::string> files;
+    DIR* dir = opendir(inputDir.c_str());
+    if (!dir) {
+        std::cerr << "Cannot open the input directory " << inputDir << "!\n";
+        return 1;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        std::string file = entry->d_name;
+        if (file.size() > 3 && file.substr(file.size() - 3) == ".pb")
+            files.push_back(file);
+    }
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+
+    BatchedInference inference(network, workspace, concurrentScheduling);
+    if (inference.getInputs().empty()) {
+        std::cerr << "The network has no inputs!\n";
+        return 1;
+    }
+    for (const std::string& file : files) {
+        TensorProto request;
+        std::ifstream infile(inputDir + "/" + file, std::ios::binary);
+        if (!request.ParseFromIstream(&infile)) {
+            std::cerr << "Failed to parse the request " << file << "!\n";
+            return 1;
+        }
+        Tensor* input = inference.findInput(request.name());
+        if (!input) {
+            std::cerr << "The network has no input for the request " << file
+                      << " (" << request.name() << ")!\n";
+            return 1;
+        }
+        if (!inference.setInput(input, request))
+            return 1;
+        Tensor* output = inference.run();
+        std::cout << "Request " << file << ": "
+                  << inference.getLatencies().back() * 1e3 << " ms\n";
+        if (!outputDir.empty() &&
+            !writeTensorProto(output, outputDir + "/" + file))
+            return 1;
+    }
+    inference.printStats(std::cout);
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     std::string modelTopo;
     std::string modelParams;
     int debugLevel = -1;
     std::string lastOutputFile;
+    std::string inputDir;
+    std::string outputDir;
+    std::string tilingCacheFile;
+    std::string profileFile;
     bool dumpGraph = false;
     runningInSimulation = false;
     SamplingInfo sampling;
@@ -28,7 +104,13 @@ int main(int argc, char* argv[]) {
     sampling.num_sample_iterations = 1;
     numAcceleratorsAvailable = 1;
     int numThreads = -1;
+    bool concurrentScheduling = false;
     useSystolicArrayWhenAvailable = false;
+    useMemoryPlanner = false;
+    useBatchNormFolding = false;
+    useLayoutPropagation = false;
+    minimizeTilingDataMovement = false;
+    useDoubleBufferedSpads = false;
     po::options_description options(
             "SMAUG Usage:  ./smaug model_topo.pbtxt model_params.pb [options]");
     // clang-format off
@@ -67,9 +149,57 @@ int main(int argc, char* argv[]) {
         ("num-threads",
          po::value(&numThreads)->implicit_value(1),
          "Number of threads in the thread pool.")
+        ("concurrent-scheduling",
+         po::value(&concurrentScheduling)->implicit_value(true),
+         "Run independent operators of the network concurrently on the "
+         "thread pool. Only supported in native runs of backends without "
+         "shared accelerator state (e.g. the Reference backend).")
         ("use-systolic-array",
          po::value(&useSystolicArrayWhenAvailable)->implicit_value(true),
-         "If the backend contains a systolic array, use it whenever possible.");
+         "If the backend contains a systolic array, use it whenever possible.")
+        ("memory-planner",
+         po::value(&useMemoryPlanner)->implicit_value(true),
+         "Place all operator outputs into one shared arena, reusing the "
+         "memory of tensors that are no longer needed.")
+        ("fold-batch-norm",
+         po::value(&useBatchNormFolding)->implicit_value(true),
+         "Fold batch norms into the weights and biases of the preceding "
+         "convolution or inner product operators.")
+        ("propagate-layouts",
+         po::value(&useLayoutPropagation)->implicit_value(true),
+         "Propagate data layouts through layout-agnostic operators, such as "
+         "activations, elementwise operators and concatenations, removing "
+         "the reorders that convert the data back and forth around them.")
+        ("minimize-tiling-data-movement",
+         po::value(&minimizeTilingDataMovement)->implicit_value(true),
+         "Tile SMV convolutions to minimize the bytes moved between the host "
+         "and the scratchpads, as estimated by an analytic model of the "
+         "tile reuse, instead of maximizing the scratchpad utilization.")
+        ("double-buffer-spads",
+         po::value(&useDoubleBufferedSpads)->implicit_value(true),
+         "Split the input and weight scratchpads of the SMV convolution, "
+         "inner product and elementwise accelerators into two buffers, so "
+         "that the transfer of the next tile overlaps the computation on the "
+         "current one. This halves the maximum tile sizes of these "
+         "operators. The systolic array is not double-buffered.")
+        ("input-dir", po::value(&inputDir),
+         "Run the network once for every serialized TensorProto (.pb file) "
+         "in this directory, replacing the data of the input with it. The "
+         "network is only tiled once, and the latency of every request and "
+         "the aggregate throughput are reported.")
+        ("output-dir", po::value(&outputDir),
+         "With --input-dir, write the output of every request as a "
+         "serialized TensorProto into this directory, under the name of its "
+         "request file.")
+        ("tiling-cache", po::value(&tilingCacheFile),
+         "Load the tiling plans of the SMV operators from this file, if it "
+         "exists, and save all the plans back to it after the run. Operators "
+         "whose plan is found skip the search for the best tiling.")
+        ("profile", po::value(&profileFile),
+         "Record the wall time of tiling and running every operator, and of "
+         "the tensor preparation, kernel dispatch and tensor finalization "
+         "phases within, and write them to this file in the Chrome trace "
+         "event format (viewable in chrome://tracing or Perfetto).");
     // clang-format on
 
     po::options_description hidden;
@@ -142,14 +272,25 @@ int main(int argc, char* argv[]) {
                      "by 1.\n";
     }
 
+    if (!profileFile.empty())
+        Profiler::get().enable();
+
     if (numThreads != -1) {
         std::cout << "Using a thread pool, size: " << numThreads << ".\n";
         threadPool = new ThreadPool(numThreads);
+        // Without fast-forwarding, the workers can start right away and help
+        // with loading the network. In simulation, the pool is started once
+        // fast-forwarding is done (see Scheduler::tileNetwork()).
+        if (!runningInSimulation)
+            threadPool->initThreadPool();
     }
 
     Workspace* workspace = new Workspace();
-    Network* network =
-            buildNetwork(modelTopo, modelParams, sampling, workspace);
+    Network* network = nullptr;
+    {
+        auto profile = ScopedProfile("Network loading", profile::kPhase);
+        network = buildNetwork(modelTopo, modelParams, sampling, workspace);
+    }
     ReferenceBackend::initGlobals();
     SmvBackend::initGlobals();
 
@@ -159,30 +300,57 @@ int main(int argc, char* argv[]) {
     if (!network->validate())
         return -1;
 
-    Scheduler scheduler(network, workspace);
-    Tensor* output = scheduler.runNetwork();
+    smv::TilingPlanCache& tilingCache = smv::TilingPlanCache::get();
+    if (!tilingCacheFile.empty()) {
+        if (tilingCache.load(tilingCacheFile)) {
+            std::cout << "Loaded " << tilingCache.size()
+                      << " tiling plans from " << tilingCacheFile << ".\n";
+        } else if (std::ifstream(tilingCacheFile)) {
+            std::cerr << "Failed to load the tiling plans from "
+                      << tilingCacheFile << ", ignoring them.\n";
+        }
+    }
+
+    int status = 0;
+    if (!inputDir.empty()) {
+        status = runBatchedInference(network, workspace, concurrentScheduling,
+                                     inputDir, outputDir);
+    } else {
+        Scheduler scheduler(network, workspace, concurrentScheduling);
+        Tensor* output = scheduler.runNetwork();
 
-    if (!lastOutputFile.empty()) {
         if (lastOutputFile == "stdout") {
             std::cout << "Final network output:\n" << *output << "\n";
         } else if (lastOutputFile == "proto") {
             // Serialize the output tensor into a proto buffer.
-            std::fstream outfile("output.pb", std::ios::out | std::ios::trunc |
-                                                      std::ios::binary);
-            TensorProto* tensorProto = output->asTensorProto();
-            if (!tensorProto->SerializeToOstream(&outfile)) {
-                std::cerr << "Failed to serialize the output tensor and write "
-                             "it to the given C++ ostream! Did you run out of "
-                             "disk space?\n";
-                return 1;
-            }
-            delete tensorProto;
-        } else {
+            if (!writeTensorProto(output, "output.pb"))
+                status = 1;
+        } else if (!lastOutputFile.empty()) {
             std::ofstream outfile(lastOutputFile);
             outfile << "Final network output:\n" << *output << "\n";
         }
     }
 
+    if (!tilingCacheFile.empty()) {
+        std::cout << "Tiling plans reused: " << tilingCache.getNumHits()
+                  << ", searched: " << tilingCache.getNumMisses() << ".\n";
+        if (!tilingCache.save(tilingCacheFile)) {
+            std::cerr << "Failed to save the tiling plans to "
+                      << tilingCacheFile << "!\n";
+        }
+    }
+
+    if (!profileFile.empty()) {
+        Profiler& profiler = Profiler::get();
+        if (profiler.save(profileFile)) {
+            std::cout << "Wrote " << profiler.size() << " profile events to "
+                      << profileFile << ".\n";
+        } else {
+            std::cerr << "Failed to write the profile to " << profileFile
+                      << "!\n";
+        }
+    }
+
     if (threadPool)
         delete threadPool;
 
@@ -191,5 +359,5 @@ int main(int argc, char* argv[]) {
     ReferenceBackend::freeGlobals();
     SmvBackend::freeGlobals();
 
-    return 0;
+    return status;
 }
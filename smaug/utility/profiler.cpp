@@ -0,0 +1,130 @@
+#include <fstream>
+#include <iomanip>
+
+#include "smaug/utility/profiler.h"
+
+namespace smaug {
+
+// Writes the string as a JSON string literal.
+static void writeJsonString(std::ostream& os, const std::string& str) {
+    os << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            os << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+               << (int)c << std::dec << std::setfill(' ');
+        else
+            os << c;
+    }
+    os << '"';
+}
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::enable() {
+    std::lock_guard<std::mutex> lock(mutex);
+    // The thread that enables the profiler gets the first timeline.
+    if (threadNames.empty())
+        threadNames[getThreadId()] = "Main";
+    enabled = true;
+}
+
+int Profiler::getThreadId() {
+    auto it = threadIds.find(std::this_thread::get_id());
+    if (it != threadIds.end())
+        return it->second;
+    int threadId = threadIds.size();
+    threadIds[std::this_thread::get_id()] = threadId;
+    return threadId;
+}
+
+void Profiler::addEvent(const std::string& name,
+                        const std::string& category,
+                        Clock::time_point start,
+                        Clock::time_point end,
+                        const std::string& opType) {
+    typedef std::chrono::duration<double, std::micro> Micros;
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push_back({ name, category, opType,
+                       Micros(start - origin).count(),
+                       Micros(end - start).count(), getThreadId() });
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    threadNames[getThreadId()] = name;
+}
+
+int Profiler::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return events.size();
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+}
+
+void Profiler::write(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(mutex);
+    os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool first = true;
+    for (auto& thread : threadNames) {
+        os << (first ? "" : ",\n")
+           << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 0, "
+              "\"tid\": "
+           << thread.first << ", \"args\": {\"name\": ";
+        writeJsonString(os, thread.second);
+        os << "}}";
+        first = false;
+    }
+    os << std::fixed << std::setprecision(3);
+    for (auto& event : events) {
+        os << (first ? "" : ",\n") << "{\"ph\": \"X\", \"name\": ";
+        writeJsonString(os, event.name);
+        os << ", \"cat\": ";
+        writeJsonString(os, event.category);
+        os << ", \"ts\": " << event.start << ", \"dur\": " << event.duration
+           << ", \"pid\": 0, \"tid\": " << event.threadId;
+        if (!event.opType.empty()) {
+            os << ", \"args\": {\"type\": ";
+            writeJsonString(os, event.opType);
+            os << "}";
+        }
+        os << "}";
+        first = false;
+    }
+    os << "\n]}\n";
+}
+
+bool Profiler::save(const std::string& path) {
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    write(file);
+    return file.good();
+}
+
+ScopedProfile::ScopedProfile(const std::string& _name,
+                             const std::string& _category,
+                             const std::string& _opType)
+        : enabled(Profiler::get().isEnabled()) {
+    // Nothing is copied unless the event will be recorded.
+    if (!enabled)
+        return;
+    name = _name;
+    category = _category;
+    opType = _opType;
+    start = Profiler::Clock::now();
+}
+
+ScopedProfile::~ScopedProfile() {
+    if (enabled) {
+        Profiler::get().addEvent(
+                name, category, start, Profiler::Clock::now(), opType);
+    }
+}
+
+}  // namespace smaug
@@ -0,0 +1,124 @@
+#ifndef _UTILITY_PROFILER_H_
+#define _UTILITY_PROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace smaug {
+
+/**
+ * Records the wall time that a native run spends in every operator.
+ *
+ * When enabled (via --profile), the scheduler records the tile() and run()
+ * calls of every operator, and the phases of an operator bracketed by
+ * gem5::ScopedStats (e.g. tensor preparation and finalization) or by
+ * ScopedProfile (e.g. kernel dispatch) are recorded as nested events. Every
+ * event carries the ID of the thread that did the work, so the work done by
+ * the thread pool shows up on the timelines of the workers.
+ *
+ * The events are written in the Chrome trace event format, which can be
+ * loaded into chrome://tracing or Perfetto.
+ */
+class Profiler {
+   public:
+    typedef std::chrono::steady_clock Clock;
+
+    /** Returns the global profiler. */
+    static Profiler& get();
+
+    /** Starts recording events. */
+    void enable();
+    /** Stops recording events. The recorded events are kept. */
+    void disable() { enabled = false; }
+    bool isEnabled() const { return enabled; }
+
+    /**
+     * Records an event that ran on the calling thread from start to end.
+     *
+     * @param name The name of the event, e.g. the operator name.
+     * @param category The category of the event, e.g. "run".
+     * @param opType The type of the operator the event belongs to, if any.
+     */
+    void addEvent(const std::string& name,
+                  const std::string& category,
+                  Clock::time_point start,
+                  Clock::time_point end,
+                  const std::string& opType = "");
+
+    /** Names the timeline of the calling thread in the trace. */
+    void setThreadName(const std::string& name);
+
+    /** Returns the number of recorded events. */
+    int size();
+
+    /** Drops all the recorded events. */
+    void clear();
+
+    /** Writes the recorded events as a Chrome trace. */
+    void write(std::ostream& os);
+
+    /** Writes the recorded events as a Chrome trace into the file. */
+    bool save(const std::string& path);
+
+   protected:
+    struct Event {
+        std::string name;
+        std::string category;
+        std::string opType;
+        /** Start time and duration in microseconds. */
+        double start;
+        double duration;
+        int threadId;
+    };
+
+    Profiler() : enabled(false), origin(Clock::now()) {}
+
+    /** Returns the trace ID of the calling thread. Requires the mutex. */
+    int getThreadId();
+
+    std::atomic<bool> enabled;
+    /** The time every event is relative to. */
+    Clock::time_point origin;
+    /** Protects the following fields. */
+    std::mutex mutex;
+    std::vector<Event> events;
+    /** Small IDs for the threads seen so far, in order of appearance. */
+    std::map<std::thread::id, int> threadIds;
+    std::map<int, std::string> threadNames;
+};
+
+/**
+ * A RAII helper class which records an event covering its lifetime if the
+ * profiler is enabled.
+ */
+class ScopedProfile {
+   public:
+    ScopedProfile(const std::string& _name,
+                  const std::string& _category,
+                  const std::string& _opType = "");
+    ~ScopedProfile();
+
+   protected:
+    std::string name;
+    std::string category;
+    std::string opType;
+    bool enabled;
+    Profiler::Clock::time_point start;
+};
+
+namespace profile {
+constexpr const char* kTile = "tile";
+constexpr const char* kRun = "run";
+constexpr const char* kPhase = "phase";
+constexpr const char* kKernelDispatch = "Kernel dispatch";
+}  // namespace profile
+
+}  // namespace smaug
+
+#endif
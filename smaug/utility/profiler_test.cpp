@@ -0,0 +1,86 @@
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "smaug/utility/profiler.h"
+#include "smaug/utility/thread_pool.h"
+#include "smaug/utility/utils.h"
+
+using namespace smaug;
+
+// Returns the lines of the trace that contain the pattern.
+static std::vector<std::string> findEvents(const std::string& pattern) {
+    std::stringstream trace;
+    Profiler::get().write(trace);
+    std::vector<std::string> events;
+    std::string line;
+    while (std::getline(trace, line)) {
+        if (line.find(pattern) != std::string::npos)
+            events.push_back(line);
+    }
+    return events;
+}
+
+// Returns the value of the integer field in the event.
+static int getField(const std::string& event, const std::string& field) {
+    size_t pos = event.find("\"" + field + "\": ");
+    REQUIRE(pos != std::string::npos);
+    return std::stoi(event.substr(pos + field.size() + 4));
+}
+
+TEST_CASE("Profiler", "[profiler]") {
+    Profiler& profiler = Profiler::get();
+    profiler.clear();
+
+    SECTION("Nothing is recorded unless enabled") {
+        { ScopedProfile profile("op", profile::kRun); }
+        REQUIRE(profiler.size() == 0);
+    }
+
+    SECTION("Scoped events are recorded") {
+        profiler.enable();
+        {
+            ScopedProfile run("conv \"0\"", profile::kRun, "Convolution3d");
+            auto stats = gem5::ScopedStats(
+                    stats::kTensorPrepStart, stats::kTensorPrepEnd);
+        }
+        profiler.disable();
+        REQUIRE(profiler.size() == 2);
+        auto runEvents = findEvents("\"cat\": \"run\"");
+        REQUIRE(runEvents.size() == 1);
+        REQUIRE(runEvents[0].find("\"name\": \"conv \\\"0\\\"\"") !=
+                std::string::npos);
+        REQUIRE(runEvents[0].find("\"args\": {\"type\": \"Convolution3d\"}") !=
+                std::string::npos);
+        // The region of the ScopedStats is a phase nested in the run.
+        auto phaseEvents = findEvents("\"name\": \"Tensor preparation\"");
+        REQUIRE(phaseEvents.size() == 1);
+        REQUIRE(getField(phaseEvents[0], "tid") ==
+                getField(runEvents[0], "tid"));
+    }
+
+    SECTION("Work on the thread pool is recorded on the workers") {
+        ThreadPool pool(2);
+        pool.initThreadPool();
+        profiler.enable();
+        pool.parallelFor(0, 8, [](int i) {
+            ScopedProfile profile("task", profile::kRun);
+        }, 1);
+        { ScopedProfile profile("main", profile::kRun); }
+        profiler.disable();
+        pool.joinThreadPool();
+        REQUIRE(profiler.size() == 9);
+        std::set<int> threadIds;
+        for (auto& event : findEvents("\"name\": \"task\""))
+            threadIds.insert(getField(event, "tid"));
+        int mainThreadId = getField(findEvents("\"name\": \"main\"")[0], "tid");
+        REQUIRE(threadIds.count(mainThreadId) == 1);
+        REQUIRE(findEvents("\"args\": {\"name\": \"Worker 0\"}").size() == 1);
+        REQUIRE(findEvents("\"args\": {\"name\": \"Worker 1\"}").size() == 1);
+    }
+
+    profiler.disable();
+    profiler.clear();
+}
@@ -1,3 +1,4 @@
+#include "smaug/utility/profiler.h"
 #include "smaug/utility/thread_pool.h"
 #include "smaug/utility/utils.h"
 #include "smaug/core/globals.h"
@@ -5,58 +6,70 @@
 
 namespace smaug {
 
-ThreadPool::ThreadPool(int nthreads) : workers(nthreads) {}
+namespace {
+
+/** The pool that the calling thread is a worker of, if any. */
+thread_local const ThreadPool* currentPool = nullptr;
+/** The index of the calling thread within currentPool. */
+thread_local int currentWorkerIndex = -1;
+
+}  // namespace
+
+ThreadPool::ThreadPool(int nthreads)
+        : workers(nthreads), numQueuedTasks(0), numPendingTasks(0),
+          nextWorker(0), exit(false), initialized(false) {}
 
 ThreadPool::~ThreadPool() {
     // Shutdown the thread pool and free all resources.
-    for (int i = 0; i < workers.size(); i++) {
-        WorkerThread* worker = &workers[i];
-        gem5::wakeCpu(worker->cpuid);
-        pthread_mutex_lock(&worker->statusMutex);
-        worker->exit = true;
-        pthread_cond_signal(&worker->wakeupCond);
-        pthread_mutex_unlock(&worker->statusMutex);
-    }
-    for (int i = 0; i < workers.size(); i++) {
-        WorkerThread* worker = &workers[i];
-        pthread_join(worker->thread, NULL);
-        pthread_mutex_destroy(&worker->statusMutex);
-        pthread_cond_destroy(&worker->wakeupCond);
-        pthread_cond_destroy(&worker->statusCond);
+    if (!initialized)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(statusMutex);
+        exit = true;
+        for (auto& worker : workers)
+            gem5::wakeCpu(worker.cpuid);
+        wakeupCond.notify_all();
     }
+    for (auto& worker : workers)
+        pthread_join(worker.thread, NULL);
+}
+
+int ThreadPool::currentWorker() const {
+    return currentPool == this ? currentWorkerIndex : -1;
 }
 
 void* ThreadPool::workerLoop(void* args) {
     ThreadInitArgs* initArgs = reinterpret_cast<ThreadInitArgs*>(args);
-    WorkerThread* worker = initArgs->worker;
+    ThreadPool* pool = initArgs->pool;
+    WorkerThread* worker = &pool->workers[initArgs->index];
+    currentPool = pool;
+    currentWorkerIndex = initArgs->index;
+    Profiler::get().setThreadName("Worker " +
+                                  std::to_string(initArgs->index));
     // Notify the main thread about this thread's cpuid. This can only be done
     // after the thread context is created.
     pthread_mutex_lock(&initArgs->cpuidMutex);
     initArgs->cpuid = gem5::getCpuId();
-    worker->status = Idle;
     pthread_cond_signal(&initArgs->cpuidCond);
     pthread_mutex_unlock(&initArgs->cpuidMutex);
 
     do {
-        gem5::quiesce();
-        pthread_mutex_lock(&worker->statusMutex);
-        while (!worker->valid && !worker->exit)
-            pthread_cond_wait(&worker->wakeupCond, &worker->statusMutex);
-        if (worker->valid) {
-            worker->status = Running;
-            pthread_mutex_unlock(&worker->statusMutex);
-
-            // Run the function.
-            worker->func(worker->args);
-
-            pthread_mutex_lock(&worker->statusMutex);
-            worker->status = Idle;
-            worker->valid = false;
-            pthread_cond_signal(&worker->statusCond);
+        if (pool->runPendingTask())
+            continue;
+        // Nothing to run or steal. Quiesce the CPU until someone submits new
+        // work.
+        {
+            std::lock_guard<std::mutex> lock(pool->statusMutex);
+            worker->idle = true;
         }
-        bool exitThread = worker->exit;
-        pthread_mutex_unlock(&worker->statusMutex);
-        if (exitThread)
+        if (pool->numQueuedTasks == 0)
+            gem5::quiesce();
+        std::unique_lock<std::mutex> lock(pool->statusMutex);
+        pool->wakeupCond.wait(lock, [pool]() {
+            return pool->exit || pool->numQueuedTasks > 0;
+        });
+        worker->idle = false;
+        if (pool->exit)
             break;
     } while (true);
 
@@ -64,53 +77,89 @@ void* ThreadPool::workerLoop(void* args) {
 }
 
 void ThreadPool::initThreadPool() {
+    assert(!initialized && "The thread pool can only be initialized once!");
     // Initialize the CPU ID for each worker thread.
     for (int i = 0; i < workers.size(); i++) {
         WorkerThread* worker = &workers[i];
-        ThreadInitArgs initArgs(worker);
+        ThreadInitArgs initArgs(this, i);
         pthread_create(
                 &worker->thread, NULL, &ThreadPool::workerLoop, &initArgs);
 
         // Fill in the CPU ID of the worker thread.
         pthread_mutex_lock(&initArgs.cpuidMutex);
-        while (initArgs.cpuid == -1 || worker->status == Uninitialized)
+        while (initArgs.cpuid == -1)
             pthread_cond_wait(&initArgs.cpuidCond, &initArgs.cpuidMutex);
         worker->cpuid = initArgs.cpuid;
         pthread_mutex_unlock(&initArgs.cpuidMutex);
-        assert(worker->status != Uninitialized &&
-               "Worker thread did not successfully initialize!");
     }
+    initialized = true;
 }
 
-int ThreadPool::dispatchThread(WorkerThreadFunc func, void* args) {
-    for (int i = 0; i < workers.size(); i++) {
-        WorkerThread* worker = &workers[i];
-        pthread_mutex_lock(&worker->statusMutex);
-        if (worker->status == Idle && !worker->valid) {
-            worker->func = func;
-            worker->args = args;
-            worker->valid = true;
-            gem5::wakeCpu(worker->cpuid);
-            pthread_cond_signal(&worker->wakeupCond);
-            pthread_mutex_unlock(&worker->statusMutex);
-            return i;
+void ThreadPool::enqueue(Task task) {
+    assert(!workers.empty() && "The thread pool has no worker threads!");
+    int self = currentWorker();
+    int target = self != -1 ? self : nextWorker++ % workers.size();
+    numPendingTasks++;
+    {
+        WorkerThread* worker = &workers[target];
+        std::lock_guard<std::mutex> lock(worker->tasksMutex);
+        worker->tasks.push_back(std::move(task));
+        numQueuedTasks++;
+    }
+    // Wake up the idle workers so that they can pick up (or steal) the task.
+    std::lock_guard<std::mutex> lock(statusMutex);
+    for (auto& worker : workers) {
+        if (worker.idle)
+            gem5::wakeCpu(worker.cpuid);
+    }
+    wakeupCond.notify_all();
+    progressCond.notify_all();
+}
+
+bool ThreadPool::runPendingTask() {
+    if (numQueuedTasks == 0)
+        return false;
+    Task task;
+    int self = currentWorker();
+    if (self != -1) {
+        // Our own tasks are the most recently submitted ones, whose data is
+        // most likely to still be in the cache.
+        WorkerThread* worker = &workers[self];
+        std::lock_guard<std::mutex> lock(worker->tasksMutex);
+        if (!worker->tasks.empty()) {
+            task = std::move(worker->tasks.back());
+            worker->tasks.pop_back();
         }
-        pthread_mutex_unlock(&worker->statusMutex);
     }
-    return -1;
+    for (int i = 1; i <= workers.size() && !task; i++) {
+        // Steal the oldest task of another worker.
+        WorkerThread* victim = &workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim->tasksMutex);
+        if (!victim->tasks.empty()) {
+            task = std::move(victim->tasks.front());
+            victim->tasks.pop_front();
+        }
+    }
+    if (!task)
+        return false;
+    numQueuedTasks--;
+    task();
+    std::lock_guard<std::mutex> lock(statusMutex);
+    if (--numPendingTasks == 0)
+        doneCond.notify_all();
+    progressCond.notify_all();
+    return true;
 }
 
 void ThreadPool::joinThreadPool() {
-    // There is no need to call wakeCpu here. If the CPU is quiesced, then
-    // it cannot possibly be running anything, so its status will be Idle, and
-    // this will move on to the next CPU.
-    for (int i = 0; i < workers.size(); i++) {
-        WorkerThread* worker = &workers[i];
-        pthread_mutex_lock(&worker->statusMutex);
-        while (worker->status == Running || worker->valid == true)
-            pthread_cond_wait(&worker->statusCond, &worker->statusMutex);
-        pthread_mutex_unlock(&worker->statusMutex);
-    }
+    assert(currentWorker() == -1 &&
+           "joinThreadPool() cannot be called from a worker thread!");
+    // Help out with the remaining tasks, then wait for the ones still running
+    // on the workers.
+    while (runPendingTask())
+        ;
+    std::unique_lock<std::mutex> lock(statusMutex);
+    doneCond.wait(lock, [this]() { return numPendingTasks == 0; });
 }
 
 }  // namespace smaug
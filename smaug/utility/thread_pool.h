@@ -2,19 +2,34 @@
 #define _UTILITY_THREAD_POOL_H_
 
 #include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace smaug {
 
 /**
- * A user-space cooperatve thread pool implementation designed for gem5 in SE
- * mode.
+ * A user-space work-stealing thread pool implementation designed for gem5 in
+ * SE mode.
  *
  * Multithreading in gem5 SE mode is tricky - while we can spawn pthreads, we
  * cannot let threads terminate when the pthread function returns, because the
  * ThreadContext would be destroyed, which prevents us from ever using the CPU
  * that was assigned to that ThreadContext. The solution is to run an infinite
- * loop on all the threads in the pool and assign work to them from a queue.
+ * loop on all the threads in the pool and assign work to them from queues.
+ *
+ * Every worker owns a deque of tasks. Tasks submitted from a worker thread are
+ * pushed to the back of its own deque and popped LIFO; tasks submitted from
+ * any other thread are distributed round-robin. An idle worker steals from
+ * the front of the other workers' deques. Any number of tasks can be
+ * submitted, regardless of how many workers are busy.
  *
  * To prevent wasting simulation time with spinloops, this thread pool
  * implementation quiesces all inactive CPUs and wakes them up only when there
@@ -31,9 +46,6 @@ class ThreadPool {
     ThreadPool(int nthreads);
     ~ThreadPool();
 
-    /** Function signature for any work to be executed on a worker thread. */
-    typedef void* (*WorkerThreadFunc)(void*);
-
     /** Returns the number of worker threads. */
     int size() const { return workers.size(); }
 
@@ -41,72 +53,114 @@ class ThreadPool {
      * Initialize the thread pool.
      *
      * Initialization must be postponed until after fast-forwarding is
-     * finished, or we will get incorrect CPU IDs.
+     * finished, or we will get incorrect CPU IDs. Tasks submitted before this
+     * are queued until the workers start.
      *
      * This can only be called once; any subsequent call will assert fail.
      */
     void initThreadPool();
 
-    /** Dispatch the function to a worker in the thread pool. */
-    int dispatchThread(WorkerThreadFunc func, void* args);
+    /** Returns true if initThreadPool() has been called. */
+    bool isInitialized() const { return initialized; }
+
+    /**
+     * Submit a task to the thread pool. The returned future holds the result
+     * of func().
+     */
+    template <typename Func>
+    auto submit(Func&& func) -> std::future<decltype(func())> {
+        typedef decltype(func()) ResultType;
+        auto task = std::make_shared<std::packaged_task<ResultType()>>(
+                std::forward<Func>(func));
+        std::future<ResultType> result = task->get_future();
+        enqueue([task]() { (*task)(); });
+        return result;
+    }
 
-    /** Wait for all threads in the pool to finish work. */
+    /**
+     * Runs func(i) for every i in [begin, end) on the thread pool, in chunks
+     * of grainSize iterations, and returns once all of them are done.
+     *
+     * The calling thread runs the first chunk and then helps with pending
+     * tasks until the loop completes, so this may be safely nested inside a
+     * task running on the pool. If grainSize is not positive, the iterations
+     * are split evenly across the workers and the calling thread.
+     */
+    template <typename Func>
+    void parallelFor(int begin, int end, Func&& func, int grainSize = 0) {
+        int count = end - begin;
+        if (count <= 0)
+            return;
+        if (grainSize <= 0)
+            grainSize = (count + size()) / (size() + 1);
+        grainSize = std::max(grainSize, 1);
+        int numChunks = (count + grainSize - 1) / grainSize;
+        if (numChunks == 1 || size() == 0) {
+            for (int i = begin; i < end; i++)
+                func(i);
+            return;
+        }
+        std::atomic<int> remainingChunks(numChunks);
+        auto runChunk = [&](int chunk) {
+            int chunkBegin = begin + chunk * grainSize;
+            int chunkEnd = std::min(chunkBegin + grainSize, end);
+            for (int i = chunkBegin; i < chunkEnd; i++)
+                func(i);
+            remainingChunks--;
+        };
+        for (int chunk = 1; chunk < numChunks; chunk++)
+            enqueue([&runChunk, chunk]() { runChunk(chunk); });
+        runChunk(0);
+        runTasksUntil([&remainingChunks]() { return remainingChunks == 0; });
+    }
+
+    /**
+     * Blocks until the future is ready. While waiting, the calling thread
+     * runs pending tasks, so this is safe to call from a worker thread.
+     */
+    template <typename T>
+    void wait(const std::future<T>& future) {
+        runTasksUntil([&future]() {
+            return future.wait_for(std::chrono::seconds(0)) ==
+                   std::future_status::ready;
+        });
+    }
+
+    /**
+     * Wait for all tasks submitted to the pool to finish work.
+     *
+     * This must not be called from a worker thread.
+     */
     void joinThreadPool();
 
    protected:
-    /** Possible worker thread states. */
-    enum ThreadStatus { Uninitialized, Idle, Running };
+    typedef std::function<void()> Task;
 
     /** All state and metadata for a worker thread. */
     struct WorkerThread {
-        WorkerThreadFunc func;
-        /** User-provided arguments. */
-        void* args;
-
         /** pthread handle. */
         pthread_t thread;
-        /**
-         * This mutex protects all of the subsequent fields of this struct. Any
-         * modification of these fields must first acquire this lock.
-         */
-        pthread_mutex_t statusMutex;
-        /** Set to true to inform the worker thread to terminate. */
-        bool exit;
-        /**  Set to true if the func and args are valid and need to be executed. */
-        bool valid;
-        ThreadStatus status;
-        /**
-         * The main thread signals this condition variable to wake up the
-         * thread and have it check for work (indicated by valid = true).
-         */
-        pthread_cond_t wakeupCond;
-        /** 
-         * The worker thread signals this condition variable to inform the main
-         * thread of a change in status (usually from Running -> Idle).
-         */
-        pthread_cond_t statusCond;
+        /** The tasks owned by this worker. */
+        std::deque<Task> tasks;
+        /** Protects tasks. */
+        std::mutex tasksMutex;
+        /** True if the worker has no work and is about to sleep. */
+        bool idle;
         /** The gem5 simulation CPU ID assigned to this worker thread. */
         int cpuid;
 
-        WorkerThread() {
-            func = NULL;
-            args = NULL;
-            exit = false;
-            valid = false;
-            status = Uninitialized;
-            pthread_mutex_init(&statusMutex, NULL);
-            pthread_cond_init(&wakeupCond, NULL);
-            pthread_cond_init(&statusCond, NULL);
-        }
+        WorkerThread() : idle(false), cpuid(-1) {}
     };
 
     struct ThreadInitArgs {
-        WorkerThread* worker;
+        ThreadPool* pool;
+        int index;
         pthread_mutex_t cpuidMutex;
         pthread_cond_t cpuidCond;
         int cpuid;
 
-        ThreadInitArgs(WorkerThread* _worker) : worker(_worker) {
+        ThreadInitArgs(ThreadPool* _pool, int _index)
+                : pool(_pool), index(_index) {
             pthread_mutex_init(&cpuidMutex, NULL);
             pthread_cond_init(&cpuidCond, NULL);
             cpuid = -1;
@@ -116,8 +170,61 @@ class ThreadPool {
     /** The main event loop executed by all worker threads. */
     static void* workerLoop(void* args);
 
+    /** Adds a task to one of the worker deques and wakes up a worker. */
+    void enqueue(Task task);
+
+    /**
+     * Pops a task from the calling worker's own deque, or steals one from
+     * another worker, and runs it. Returns false if there was no task.
+     */
+    bool runPendingTask();
+
+    /**
+     * Runs pending tasks until done() returns true. When there is nothing to
+     * run, the calling thread blocks until a task is queued or finishes,
+     * instead of spinning.
+     */
+    template <typename Pred>
+    void runTasksUntil(Pred done) {
+        while (!done()) {
+            if (runPendingTask())
+                continue;
+            std::unique_lock<std::mutex> lock(statusMutex);
+            progressCond.wait(lock, [this, &done]() {
+                return done() || numQueuedTasks > 0;
+            });
+        }
+    }
+
+    /**
+     * Returns the index of the calling thread in this pool, or -1 if it is
+     * not one of our workers.
+     */
+    int currentWorker() const;
+
     /** Worker threads. */
     std::vector<WorkerThread> workers;
+
+    /** Number of tasks sitting in the worker deques. */
+    std::atomic<int> numQueuedTasks;
+    /** Number of tasks submitted but not yet finished. */
+    std::atomic<int> numPendingTasks;
+    /** The worker deque that the next external submission goes to. */
+    std::atomic<unsigned> nextWorker;
+
+    /**
+     * This mutex protects the following fields. Idle workers wait on
+     * wakeupCond for new tasks or for the pool to exit.
+     */
+    std::mutex statusMutex;
+    std::condition_variable wakeupCond;
+    /** Signalled when numPendingTasks drops to zero. */
+    std::condition_variable doneCond;
+    /** Signalled whenever a task is queued or finishes. */
+    std::condition_variable progressCond;
+    /** Set to true to inform the worker threads to terminate. */
+    bool exit;
+    bool initialized;
 };
 
 }  // namespace smaug
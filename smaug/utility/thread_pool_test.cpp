@@ -0,0 +1,48 @@
+#include <atomic>
+#include <vector>
+
+#include "catch.hpp"
+#include "smaug/utility/thread_pool.h"
+
+using namespace smaug;
+
+TEST_CASE("Thread pool", "[threadpool]") {
+    ThreadPool pool(2);
+    pool.initThreadPool();
+
+    SECTION("Submit more tasks than workers") {
+        std::vector<std::future<int>> results;
+        for (int i = 0; i < 32; i++)
+            results.push_back(pool.submit([i]() { return i * i; }));
+        for (int i = 0; i < 32; i++)
+            REQUIRE(results[i].get() == i * i);
+    }
+
+    SECTION("Parallel for") {
+        std::vector<int> values(1000, 0);
+        pool.parallelFor(0, values.size(), [&](int i) { values[i] = i + 1; });
+        for (int i = 0; i < values.size(); i++)
+            REQUIRE(values[i] == i + 1);
+    }
+
+    SECTION("Nested parallel for") {
+        std::atomic<int> sum(0);
+        std::vector<std::future<void>> results;
+        for (int i = 0; i < 8; i++) {
+            results.push_back(pool.submit([&]() {
+                pool.parallelFor(0, 100, [&](int j) { sum += j; }, 10);
+            }));
+        }
+        for (auto& result : results)
+            pool.wait(result);
+        REQUIRE(sum == 8 * 4950);
+    }
+
+    SECTION("Join the thread pool") {
+        std::atomic<int> count(0);
+        for (int i = 0; i < 16; i++)
+            pool.submit([&]() { count++; });
+        pool.joinThreadPool();
+        REQUIRE(count == 16);
+    }
+}
@@ -83,11 +83,24 @@ void wakeCpu(int id) {}
 int getCpuId() { return 0; }
 #endif
 
+// Returns the name of the phase that starts with this stats label.
+static std::string getPhaseName(const char* startLabel) {
+    std::string name(startLabel);
+    const std::string suffix = " start";
+    if (name.size() > suffix.size() &&
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+        name.resize(name.size() - suffix.size());
+    return name;
+}
+
 ScopedStats::ScopedStats(const char* _startLabel,
                          const char* _endLabel,
                          bool _resetStats)
         : startLabel(_startLabel), endLabel(_endLabel),
-          resetStats(_resetStats) {
+          resetStats(_resetStats),
+          profile(Profiler::get().isEnabled() ? getPhaseName(_startLabel)
+                                              : "",
+                  profile::kPhase) {
     if (resetStats)
         dumpResetStats(startLabel, 0);
     else
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "smaug/core/datatypes.h"
+#include "smaug/utility/profiler.h"
 #include "gem5/m5ops.h"
 
 namespace smaug {
@@ -113,7 +114,8 @@ int getCpuId();
 
 /**
  * A RAII helper class which dumps and/or resets gem5 stats at construction and
- * destruction.
+ * destruction. If the Profiler is enabled, the region is also recorded as a
+ * phase, named after the start label without the trailing " start".
  */
 class ScopedStats {
    public:
@@ -126,6 +128,7 @@ class ScopedStats {
     const char* startLabel;
     const char* endLabel;
     bool resetStats;
+    ScopedProfile profile;
 };
 
 }  // namespace gem5